@@ -2,7 +2,6 @@
 #include "core/graph/GSSWGraph.h"
 #include "core/variant/VariantList.h"
 #include "core/allele/EquivalentAllele.h"
-#include "core/mapping/MappingManager.h"
 #include "core/mapping/GSSWMapping.h"
 
 #include <memory>
@@ -38,9 +37,6 @@ namespace graphite
 		{
 			std::cout << "no sequence: " << alignmentPtr->getPosition() << std::endl;
 		}
-		auto alignmentMappingMutexPtr = alignmentPtr->getMappingMutex(); // lock the alignmentMappingMutex so no one else can set the mapping ptr
-		std::lock_guard< std::recursive_mutex > lock(*alignmentMappingMutexPtr); // make sure the alignmentMapping isn't set during this
-
 		auto swScore = mappingPtr->getMappingScore();
 		uint32_t swPercent = ((swScore / (double)(alignmentPtr->getLength() * this->m_match_value)) * 100);
 
@@ -108,8 +104,7 @@ namespace graphite
 			// if ((referenceSWScoreIdentical && isAlt) || (checkAlleleSuffix && variantPtr->getAlleleSuffixOverlapMaxCount(allelePtr) >= mappingAlignmentInfoPtr->getPrefixMatch()) ||(checkAllelePrefix && variantPtr->getAllelePrefixOverlapMaxCount(allelePtr) >= mappingAlignmentInfoPtr->getSuffixMatch()))  // check that the alignment maps to unique areas of the allele
 			if (referenceSWScoreIdentical && isAlt)
 			{
-				mappingPtr->addAlleleCountCallback(std::bind(&IAllele::incrementCount, allelePtr, alignmentPtr->isReverseStrand(), alignmentPtr->getSample(), AlleleCountType::Ambiguous));
-				alignmentPtr->addMapping(mappingPtr);
+				allelePtr->incrementCount(alignmentPtr->isReverseStrand(), alignmentPtr->getSample(), AlleleCountType::Ambiguous);
 				mappingPtr->setMapped(true);
 				/*
 				{
@@ -123,8 +118,7 @@ namespace graphite
 			}
 			else
 			{
-				mappingPtr->addAlleleCountCallback(std::bind(&IAllele::incrementCount, allelePtr, alignmentPtr->isReverseStrand(), alignmentPtr->getSample(), scoreToAlleleCountType(alleleMappingScorePercent)));
-				alignmentPtr->addMapping(mappingPtr);
+				allelePtr->incrementCount(alignmentPtr->isReverseStrand(), alignmentPtr->getSample(), scoreToAlleleCountType(alleleMappingScorePercent));
 				mappingPtr->setMapped(true);
 				return true;
 			}
@@ -11,10 +11,9 @@ namespace graphite
 	{
 	}
 
-	AlignmentList::AlignmentList(std::vector< IAlignment::SharedPtr > alignmentPtrs, std::shared_ptr< std::unordered_map< std::string, IAlignment::SharedPtr > > nameAlignmentPtrMapPtr, Region::SharedPtr regionPtr) :
+	AlignmentList::AlignmentList(std::vector< IAlignment::SharedPtr > alignmentPtrs, Region::SharedPtr regionPtr) :
 		m_alignment_ptrs(alignmentPtrs),
-		m_alignment_idx(0),
-		m_name_alignment_ptr_map_ptr(nameAlignmentPtrMapPtr)
+		m_alignment_idx(0)
 	{
 		if (alignmentPtrs.size() > 0)
 		{
@@ -12,7 +12,7 @@ namespace graphite
 		typedef std::shared_ptr< AlignmentList > SharedPtr;
 		typedef std::vector< IAlignment::SharedPtr >::iterator AlignmentIter;
 		AlignmentList(std::vector< IAlignment::SharedPtr > alignmentPtrs);
-		AlignmentList(std::vector< IAlignment::SharedPtr > alignmentPtrs, std::shared_ptr< std::unordered_map< std::string, IAlignment::SharedPtr > > nameAlignmentPtrMapPtr, Region::SharedPtr regionPtr);
+		AlignmentList(std::vector< IAlignment::SharedPtr > alignmentPtrs, Region::SharedPtr regionPtr);
 		~AlignmentList();
 
 		size_t getCount() override;
@@ -26,7 +26,6 @@ namespace graphite
 		std::vector< IAlignment::SharedPtr > m_alignment_ptrs;
 		size_t m_alignment_idx;
 		Region::SharedPtr m_region_ptr;
-		std::shared_ptr< std::unordered_map< std::string, IAlignment::SharedPtr > > m_name_alignment_ptr_map_ptr;
 	};
 }
 
@@ -10,6 +10,7 @@
 #include <chrono>
 #include <thread>
 #include <deque>
+#include <functional>
 
 namespace graphite
 {
@@ -24,14 +25,21 @@ namespace graphite
 		};
 	public:
 		typedef std::shared_ptr< AlignmentReaderManager > SharedPtr;
-		AlignmentReaderManager(std::vector< std::string > fileNames, uint32_t numReadersPerFile)
+		typedef std::function< typename AlignmentReaderType::SharedPtr (const std::string&, AlignmentReaderManager*) > ReaderCreator;
+		AlignmentReaderManager(std::vector< std::string > fileNames, uint32_t numReadersPerFile) :
+			AlignmentReaderManager(fileNames, numReadersPerFile, [](const std::string& fileName, AlignmentReaderManager* alignmentReaderManagerPtr) { return std::make_shared< AlignmentReaderType >(fileName, alignmentReaderManagerPtr); })
+		{
+		}
+
+		// lets AlignmentReaderType be an interface with the concrete reader picked at runtime
+		AlignmentReaderManager(std::vector< std::string > fileNames, uint32_t numReadersPerFile, ReaderCreator readerCreator)
 		{
 			for (auto& fileName : fileNames)
 			{
 				std::deque< std::shared_ptr< AlignmentReaderType > > alignmentReaderQueue;
 				for (auto i = 0; i < numReadersPerFile; ++i)
 				{
-					auto alignmentReaderPtr = std::make_shared< AlignmentReaderType >(fileName, this);
+					auto alignmentReaderPtr = readerCreator(fileName, this);
 					alignmentReaderPtr->open();
 					alignmentReaderQueue.push_front(alignmentReaderPtr);
 				}
@@ -0,0 +1,258 @@
+#include "AlignmentStore.h"
+#include "StoredAlignment.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace graphite
+{
+	namespace
+	{
+		const uint32_t s_min_sequence_slab_size = 1 << 12;
+		const uint32_t s_max_sequence_slab_size = 1 << 20;
+		const char* s_base_codes = "=ACMGRSVTWYHKDBN";
+
+		struct BaseEncoder
+		{
+			BaseEncoder()
+			{
+				memset(codes, 15, sizeof(codes)); // anything unknown is an N
+				for (uint8_t code = 0; code < 16; ++code)
+				{
+					codes[(uint8_t)s_base_codes[code]] = code;
+					codes[(uint8_t)tolower(s_base_codes[code])] = code;
+				}
+			}
+			uint8_t codes[256];
+		};
+		const BaseEncoder s_base_encoder;
+
+		// the views of one lookup and the buffer their bases are decoded into, handed out through aliasing shared_ptrs
+		struct StoredAlignmentBlock
+		{
+			AlignmentStore::SharedPtr alignmentStorePtr;
+			std::unique_ptr< StoredAlignment[] > alignments;
+			std::unique_ptr< char[] > sequences;
+		};
+	}
+
+	AlignmentStore::AlignmentStore() :
+		m_sequence_slab_used(0),
+		m_max_length(0)
+	{
+	}
+
+	AlignmentStore::~AlignmentStore()
+	{
+	}
+
+	uint64_t AlignmentStore::HashName(const char* name, size_t nameLength, bool firstMate)
+	{
+		// FNV-1a so both alignment readers hash a name the same way without building a std::string
+		uint64_t nameHash = 0xcbf29ce484222325ULL;
+		for (size_t i = 0; i < nameLength; ++i)
+		{
+			nameHash = (nameHash ^ (uint8_t)name[i]) * 0x100000001b3ULL;
+		}
+		return (firstMate) ? nameHash ^ 0x9e3779b97f4a7c15ULL : nameHash;
+	}
+
+	void AlignmentStore::addAlignment(position startPosition, const std::string& name, const std::string& sequence, Sample::SharedPtr samplePtr, bool firstMate, bool mapped, bool reverseStrand, bool duplicate, uint16_t mapQuality)
+	{
+		auto& record = addRecord(startPosition, HashName(name.c_str(), name.size(), firstMate), sequence.size(), samplePtr, firstMate, mapped, reverseStrand, duplicate, mapQuality);
+		uint8_t* packedSequence = this->m_sequence_slabs[record.sequenceSlab].get() + record.sequenceOffset;
+		for (uint32_t i = 0; i < record.length; ++i)
+		{
+			uint8_t code = s_base_encoder.codes[(uint8_t)sequence[i]];
+			packedSequence[i / 2] |= (i % 2 == 0) ? (code << 4) : code;
+		}
+	}
+
+	void AlignmentStore::addPackedAlignment(position startPosition, uint64_t nameHash, const uint8_t* packedSequence, uint32_t length, Sample::SharedPtr samplePtr, bool firstMate, bool mapped, bool reverseStrand, bool duplicate, uint16_t mapQuality)
+	{
+		auto& record = addRecord(startPosition, nameHash, length, samplePtr, firstMate, mapped, reverseStrand, duplicate, mapQuality);
+		memcpy(this->m_sequence_slabs[record.sequenceSlab].get() + record.sequenceOffset, packedSequence, (length + 1) / 2);
+	}
+
+	AlignmentStore::AlignmentRecord& AlignmentStore::addRecord(position startPosition, uint64_t nameHash, uint32_t length, Sample::SharedPtr samplePtr, bool firstMate, bool mapped, bool reverseStrand, bool duplicate, uint16_t mapQuality)
+	{
+		AlignmentRecord record;
+		record.nameHash = nameHash;
+		record.startPosition = startPosition;
+		record.length = length;
+		record.sampleSlot = getSampleSlot(samplePtr);
+		record.mapQuality = std::min< uint16_t >(mapQuality, 255);
+		record.flags = (firstMate ? FIRST_MATE : 0) | (mapped ? MAPPED : 0) | (reverseStrand ? REVERSE_STRAND : 0) | (duplicate ? DUPLICATE : 0);
+		allocateSequence(record.length, record.sequenceSlab, record.sequenceOffset);
+		this->m_max_length = std::max(this->m_max_length, length);
+		this->m_records.emplace_back(record);
+		return this->m_records.back();
+	}
+
+	void AlignmentStore::addAlignments(AlignmentStore::SharedPtr storePtr, position startPosition)
+	{
+		for (auto& otherRecord : storePtr->m_records)
+		{
+			if (otherRecord.startPosition < startPosition)
+			{
+				continue;
+			}
+			AlignmentRecord record = otherRecord;
+			record.sampleSlot = getSampleSlot(storePtr->m_sample_ptrs[otherRecord.sampleSlot]);
+			uint8_t* packedSequence = allocateSequence(record.length, record.sequenceSlab, record.sequenceOffset);
+			memcpy(packedSequence, storePtr->m_sequence_slabs[otherRecord.sequenceSlab].get() + otherRecord.sequenceOffset, (record.length + 1) / 2);
+			this->m_max_length = std::max(this->m_max_length, record.length);
+			this->m_records.emplace_back(record);
+		}
+	}
+
+	void AlignmentStore::sortByPosition()
+	{
+		std::stable_sort(this->m_records.begin(), this->m_records.end(), [](const AlignmentRecord& a, const AlignmentRecord& b) {
+				return a.startPosition < b.startPosition;
+			});
+		this->m_records.shrink_to_fit();
+	}
+
+	void AlignmentStore::getSequence(uint32_t index, char* sequence)
+	{
+		auto& record = this->m_records[index];
+		const uint8_t* packedSequence = this->m_sequence_slabs[record.sequenceSlab].get() + record.sequenceOffset;
+		for (uint32_t i = 0; i < record.length; ++i)
+		{
+			sequence[i] = s_base_codes[(i % 2 == 0) ? (packedSequence[i / 2] >> 4) : (packedSequence[i / 2] & 0xF)];
+		}
+		sequence[record.length] = '\0';
+	}
+
+	void AlignmentStore::getIndexRangeInRegion(position startPosition, position endPosition, uint32_t& beginIndex, uint32_t& endIndex)
+	{
+		position earliestStartPosition = (startPosition > this->m_max_length) ? startPosition - this->m_max_length : 0;
+		auto lowerBound = std::lower_bound(this->m_records.begin(), this->m_records.end(), earliestStartPosition, [](const AlignmentRecord& record, position startPosition) {
+				return record.startPosition < startPosition;
+			});
+		auto upperBound = std::upper_bound(lowerBound, this->m_records.end(), endPosition, [](position endPosition, const AlignmentRecord& record) {
+				return endPosition < record.startPosition;
+			});
+		beginIndex = lowerBound - this->m_records.begin();
+		endIndex = upperBound - this->m_records.begin();
+	}
+
+	std::vector< IAlignment::SharedPtr > AlignmentStore::getAlignmentPtrsInRegion(position startPosition, position endPosition)
+	{
+		uint32_t beginIndex;
+		uint32_t endIndex;
+		getIndexRangeInRegion(startPosition, endPosition, beginIndex, endIndex);
+
+		std::vector< uint32_t > indices;
+		for (uint32_t i = beginIndex; i < endIndex; ++i)
+		{
+			if (overlapsRegion(i, startPosition, endPosition))
+			{
+				indices.emplace_back(i);
+			}
+		}
+		return getAlignmentPtrs(indices);
+	}
+
+	std::vector< IAlignment::SharedPtr > AlignmentStore::getAlignmentPtrsInRegions(std::vector< std::pair< position, position > > regions)
+	{
+		std::sort(regions.begin(), regions.end());
+		std::vector< uint32_t > indices;
+		uint32_t visitedEndIndex = 0;
+		size_t i = 0;
+		while (i < regions.size())
+		{
+			position startPosition = regions[i].first;
+			position endPosition = regions[i].second;
+			for (++i; i < regions.size() && regions[i].first <= endPosition; ++i)
+			{
+				endPosition = std::max(endPosition, regions[i].second);
+			}
+
+			uint32_t beginIndex;
+			uint32_t endIndex;
+			getIndexRangeInRegion(startPosition, endPosition, beginIndex, endIndex);
+			// a read visited for an earlier region that reaches this one also overlapped that region so it was already added
+			for (uint32_t index = std::max(beginIndex, visitedEndIndex); index < endIndex; ++index)
+			{
+				if (overlapsRegion(index, startPosition, endPosition))
+				{
+					indices.emplace_back(index);
+				}
+			}
+			visitedEndIndex = std::max(visitedEndIndex, endIndex);
+		}
+		return getAlignmentPtrs(indices);
+	}
+
+	std::vector< IAlignment::SharedPtr > AlignmentStore::getAlignmentPtrs(const std::vector< uint32_t >& indices)
+	{
+		std::vector< IAlignment::SharedPtr > alignmentPtrs;
+		if (indices.empty())
+		{
+			return alignmentPtrs;
+		}
+		size_t sequencesSize = 0;
+		for (auto index : indices)
+		{
+			sequencesSize += this->m_records[index].length + 1;
+		}
+		auto blockPtr = std::make_shared< StoredAlignmentBlock >();
+		blockPtr->alignmentStorePtr = shared_from_this();
+		blockPtr->alignments.reset(new StoredAlignment[indices.size()]);
+		blockPtr->sequences.reset(new char[sequencesSize]);
+
+		alignmentPtrs.reserve(indices.size());
+		size_t sequenceOffset = 0;
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			blockPtr->alignments[i].setRecord(this, indices[i], blockPtr->sequences.get() + sequenceOffset);
+			sequenceOffset += this->m_records[indices[i]].length + 1;
+			alignmentPtrs.emplace_back(IAlignment::SharedPtr(blockPtr, &blockPtr->alignments[i]));
+		}
+		return alignmentPtrs;
+	}
+
+	uint64_t AlignmentStore::getMemoryUsage()
+	{
+		uint64_t memoryUsage = this->m_records.capacity() * sizeof(AlignmentRecord);
+		for (auto sequenceSlabSize : this->m_sequence_slab_sizes)
+		{
+			memoryUsage += sequenceSlabSize;
+		}
+		return memoryUsage;
+	}
+
+	uint16_t AlignmentStore::getSampleSlot(Sample::SharedPtr samplePtr)
+	{
+		for (uint16_t i = 0; i < this->m_sample_ptrs.size(); ++i)
+		{
+			if (this->m_sample_ptrs[i] == samplePtr)
+			{
+				return i;
+			}
+		}
+		this->m_sample_ptrs.emplace_back(samplePtr);
+		return this->m_sample_ptrs.size() - 1;
+	}
+
+	uint8_t* AlignmentStore::allocateSequence(uint32_t length, uint32_t& sequenceSlab, uint32_t& sequenceOffset)
+	{
+		uint32_t packedLength = (length + 1) / 2;
+		if (this->m_sequence_slabs.empty() || this->m_sequence_slab_used + packedLength > this->m_sequence_slab_sizes.back())
+		{
+			// slabs double up to the maximum so the many small stores of a region's reads stay small
+			uint32_t slabSize = (this->m_sequence_slab_sizes.empty()) ? s_min_sequence_slab_size : std::min(this->m_sequence_slab_sizes.back() * 2, s_max_sequence_slab_size);
+			slabSize = std::max(slabSize, packedLength); // a read longer than a slab gets a slab of its own
+			this->m_sequence_slabs.emplace_back(new uint8_t[slabSize]());
+			this->m_sequence_slab_sizes.emplace_back(slabSize);
+			this->m_sequence_slab_used = 0;
+		}
+		sequenceSlab = this->m_sequence_slabs.size() - 1;
+		sequenceOffset = this->m_sequence_slab_used;
+		this->m_sequence_slab_used += packedLength;
+		return this->m_sequence_slabs.back().get() + sequenceOffset;
+	}
+}
@@ -0,0 +1,104 @@
+#ifndef GRAPHITE_ALIGNMENTSTORE_H
+#define GRAPHITE_ALIGNMENTSTORE_H
+
+#include "IAlignment.h"
+#include "core/util/Types.h"
+#include "core/util/Noncopyable.hpp"
+#include "core/sample/Sample.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace graphite
+{
+	/*
+	 * Holds the reads of a region as fixed size records with their bases packed
+	 * two to a byte (the same 4 bit codes BAM uses, so N and the other ambiguity
+	 * codes survive) in large shared slabs. A read is identified by the hash of
+	 * its name and mate instead of a copy of the name. getAlignmentPtrsInRegion
+	 * hands out StoredAlignment views, made together in one block per lookup,
+	 * that decode their bases when they are first read and only live as long
+	 * as the graph that uses them.
+	 *
+	 * A store is filled by one thread, sorted and is read-only from then on.
+	 * Indices, and the records they point to, are stable once sortByPosition is
+	 * called.
+	 */
+	class AlignmentStore : private Noncopyable, public std::enable_shared_from_this< AlignmentStore >
+	{
+	public:
+		typedef std::shared_ptr< AlignmentStore > SharedPtr;
+
+		enum RecordFlags : uint8_t
+		{
+			FIRST_MATE = 0x1,
+			MAPPED = 0x2,
+			REVERSE_STRAND = 0x4,
+			DUPLICATE = 0x8
+		};
+
+		struct AlignmentRecord
+		{
+			uint64_t nameHash; // the read name hashed together with the mate
+			position startPosition;
+			uint32_t length;
+			uint32_t sequenceSlab;
+			uint32_t sequenceOffset;
+			uint16_t sampleSlot;
+			uint8_t mapQuality;
+			uint8_t flags;
+		};
+
+		AlignmentStore();
+		~AlignmentStore();
+
+		void addAlignment(position startPosition, const std::string& name, const std::string& sequence, Sample::SharedPtr samplePtr, bool firstMate, bool mapped, bool reverseStrand, bool duplicate, uint16_t mapQuality);
+		// packedSequence is already in the 4 bit BAM encoding and is copied as is
+		void addPackedAlignment(position startPosition, uint64_t nameHash, const uint8_t* packedSequence, uint32_t length, Sample::SharedPtr samplePtr, bool firstMate, bool mapped, bool reverseStrand, bool duplicate, uint16_t mapQuality);
+		/*
+		 * Copies the reads of storePtr that start at or after startPosition.
+		 * When storePtr holds the reads of a fetch window, passing the end of
+		 * the previous window drops the reads that window already returned.
+		 */
+		void addAlignments(AlignmentStore::SharedPtr storePtr, position startPosition);
+		void sortByPosition();
+
+		size_t getCount() { return m_records.size(); }
+		const AlignmentRecord& getRecord(uint32_t index) { return m_records[index]; }
+		Sample::SharedPtr getSamplePtr(uint16_t sampleSlot) { return m_sample_ptrs[sampleSlot]; }
+		void getSequence(uint32_t index, char* sequence); // length bases and a terminating null
+		/*
+		 * Finds the sorted records that can overlap [startPosition, endPosition]
+		 * without copying them. Reads start at most getMaxLength() bases before
+		 * the ones that overlap so two binary searches on the start position
+		 * bound them, the range can still hold reads that end before
+		 * startPosition, overlapsRegion tells them apart.
+		 */
+		void getIndexRangeInRegion(position startPosition, position endPosition, uint32_t& beginIndex, uint32_t& endIndex);
+		bool overlapsRegion(uint32_t index, position startPosition, position endPosition) { return m_records[index].startPosition <= endPosition && m_records[index].startPosition + m_records[index].length >= startPosition; }
+		std::vector< IAlignment::SharedPtr > getAlignmentPtrsInRegion(position startPosition, position endPosition);
+		// the reads overlapping any of the regions, a read in more than one of them is only returned once
+		std::vector< IAlignment::SharedPtr > getAlignmentPtrsInRegions(std::vector< std::pair< position, position > > regions);
+		uint32_t getMaxLength() { return m_max_length; }
+		uint64_t getMemoryUsage();
+
+		static uint64_t HashName(const char* name, size_t nameLength, bool firstMate);
+
+	private:
+		std::vector< IAlignment::SharedPtr > getAlignmentPtrs(const std::vector< uint32_t >& indices);
+		AlignmentRecord& addRecord(position startPosition, uint64_t nameHash, uint32_t length, Sample::SharedPtr samplePtr, bool firstMate, bool mapped, bool reverseStrand, bool duplicate, uint16_t mapQuality);
+		uint16_t getSampleSlot(Sample::SharedPtr samplePtr);
+		uint8_t* allocateSequence(uint32_t length, uint32_t& sequenceSlab, uint32_t& sequenceOffset);
+
+		std::vector< AlignmentRecord > m_records;
+		std::vector< std::unique_ptr< uint8_t[] > > m_sequence_slabs;
+		std::vector< uint32_t > m_sequence_slab_sizes;
+		uint32_t m_sequence_slab_used;
+		uint32_t m_max_length;
+		std::vector< Sample::SharedPtr > m_sample_ptrs;
+	};
+}
+
+#endif //GRAPHITE_ALIGNMENTSTORE_H
@@ -19,7 +19,7 @@ namespace graphite
 		m_region_ptr = regionPtr;
     }
 
-	BamAlignmentManager::BamAlignmentManager(SampleManager::SharedPtr sampleManagerPtr, Region::SharedPtr regionPtr, AlignmentReaderManager< BamAlignmentReader >::SharedPtr alignmentReaderManagerPtr, bool excludeDuplicateReads) :
+	BamAlignmentManager::BamAlignmentManager(SampleManager::SharedPtr sampleManagerPtr, Region::SharedPtr regionPtr, AlignmentReaderManager< IAlignmentReader >::SharedPtr alignmentReaderManagerPtr, bool excludeDuplicateReads) :
 		m_sample_manager_ptr(sampleManagerPtr),
 		m_loaded(false),
         m_exclude_duplicate_reads(excludeDuplicateReads),
@@ -36,163 +36,70 @@ namespace graphite
 	{
 		ThreadPool::Instance()->start();
 		if (this->m_loaded) { return; }
+		auto fetchRegionPtrs = getRegionsContainingVariantsWithPadding(variantManagerPtr, 0); // the variant regions are already padded by the read length
 		std::unordered_set< std::string > usedPaths;
 		for (auto samplePtr : this->m_sample_manager_ptr->getSamplePtrs())
 		{
 			if (usedPaths.find(samplePtr->getPath()) != usedPaths.end()) { continue; }
 			usedPaths.emplace(samplePtr->getPath());
-
-			std::string bamPath = samplePtr->getPath();
-
-			std::vector< Region::SharedPtr > regionPtrs;
-			auto variantListPtr = variantManagerPtr->getVariantsInRegion(this->m_region_ptr);
-			IVariant::SharedPtr variantPtr;
-			while (variantListPtr->getNextVariant(variantPtr))
-			{
-				auto variantRegionPtrs = variantPtr->getRegions();
-				regionPtrs.insert(regionPtrs.end(), variantRegionPtrs.begin(), variantRegionPtrs.end());
-			}
-
-			std::deque< std::shared_ptr< std::future< std::vector< IAlignment::SharedPtr > > > > futureFunctions;
-
-			std::vector< BamAlignmentReader::SharedPtr > bamAlignmentReaders;
-			std::unordered_set< std::string > regionStrings;
-			position bamLastPosition = 0;
-			bool lastPositionSet = false;
-			for (auto regionPtr : regionPtrs)
-			{
-				auto bamAlignmentReaderPtr = m_alignment_reader_manager->getReader(bamPath);
-				if (lastPositionSet)
-				{
-					bamLastPosition = BamAlignmentReader::GetLastPositionInBam(bamPath, regionPtr);
-					lastPositionSet = true;
-				}
-				auto funct = std::bind(&BamAlignmentReader::loadAlignmentsInRegion, bamAlignmentReaderPtr, regionPtr, m_sample_manager_ptr, this->m_exclude_duplicate_reads);
-				auto future = ThreadPool::Instance()->enqueue(funct);
-				futureFunctions.push_back(future);
-				bamAlignmentReaders.push_back(bamAlignmentReaderPtr);
-			}
-
-			{
-				std::lock_guard< std::mutex > lockGuard(m_alignment_ptrs_lock);
-				this->m_name_alignment_ptr_map_ptr->clear();
-			}
-			while (!futureFunctions.empty())
-			{
-				auto futureFunct = futureFunctions.front();
-				futureFunctions.pop_front();
-				if (futureFunct->wait_for(std::chrono::milliseconds(100)) == std::future_status::ready)
-				{
-					std::lock_guard< std::mutex > lockGuard(m_alignment_ptrs_lock);
-					auto loadedAlignmentPtrs = futureFunct->get();
-					for (auto& alignmentPtr : loadedAlignmentPtrs)
-					{
-						if (m_name_alignment_ptr_map_ptr->find(alignmentPtr->getID()) == m_name_alignment_ptr_map_ptr->end())
-						{
-							m_name_alignment_ptr_map_ptr->emplace(alignmentPtr->getID(), alignmentPtr);
-							this->m_alignment_ptrs.push_back(alignmentPtr);
-						}
-					}
-					continue;
-				}
-				else
-				{
-					futureFunctions.emplace_back(futureFunct);
-				}
-			}
-			this->m_loaded = true;
+			loadBam(samplePtr->getPath(), fetchRegionPtrs);
 		}
-
-		std::sort(this->m_alignment_ptrs.begin(), this->m_alignment_ptrs.end(),
-				  [] (const IAlignment::SharedPtr& a, const IAlignment::SharedPtr& b)
-				  {
-					  return a->getPosition() < b->getPosition();
-				  });
+		this->m_alignment_store_ptr->sortByPosition();
 	}
 
 	void BamAlignmentManager::asyncLoadAlignments(IVariantManager::SharedPtr variantManagerPtr, uint32_t variantPadding)
 	{
 		if (this->m_loaded) { return; }
+		auto fetchRegionPtrs = getRegionsContainingVariantsWithPadding(variantManagerPtr, variantPadding);
 		std::unordered_set< std::string > usedPaths;
 		for (auto samplePtr : this->m_sample_manager_ptr->getSamplePtrs())
 		{
 			if (usedPaths.find(samplePtr->getPath()) != usedPaths.end()) { continue; }
 			usedPaths.emplace(samplePtr->getPath());
-			this->m_loading_thread_ptrs.emplace_back(std::make_shared< std::thread >(&BamAlignmentManager::loadBam, this, samplePtr->getPath(), variantManagerPtr, variantPadding));
+			this->m_loading_thread_ptrs.emplace_back(std::make_shared< std::thread >(&BamAlignmentManager::loadBam, this, samplePtr->getPath(), fetchRegionPtrs));
 		}
 
 	}
 
-	void BamAlignmentManager::loadBam(const std::string bamPath, IVariantManager::SharedPtr variantManagerPtr, uint32_t variantPadding)
+	void BamAlignmentManager::loadBam(const std::string bamPath, std::vector< Region::SharedPtr > fetchRegionPtrs)
 	{
 		ThreadPool::Instance()->start();
-		// auto regionPtrs = getRegionsContainingVariantsWithPadding(variantManagerPtr, variantPadding);
-		std::vector< Region::SharedPtr > regionPtrs;
-		auto variantListPtr = variantManagerPtr->getVariantsInRegion(this->m_region_ptr);
-		IVariant::SharedPtr variantPtr;
-		while (variantListPtr->getNextVariant(variantPtr))
+		std::vector< AlignmentStore::SharedPtr > regionAlignmentStorePtrs(fetchRegionPtrs.size());
+		TaskGroup taskGroup;
+		for (size_t i = 0; i < fetchRegionPtrs.size(); ++i)
 		{
-			auto variantRegionPtrs = variantPtr->getRegions();
-			regionPtrs.insert(regionPtrs.end(), variantRegionPtrs.begin(), variantRegionPtrs.end());
+			auto alignmentReaderPtr = m_alignment_reader_manager->getReader(bamPath);
+			auto funct = std::bind(&IAlignmentReader::loadAlignmentsInRegion, alignmentReaderPtr, fetchRegionPtrs[i], m_sample_manager_ptr, this->m_exclude_duplicate_reads);
+			auto regionAlignmentStorePtrPtr = &regionAlignmentStorePtrs[i];
+			taskGroup.run([funct, regionAlignmentStorePtrPtr]() mutable { *regionAlignmentStorePtrPtr = funct(); });
 		}
+		taskGroup.join();
 
-		std::deque< std::shared_ptr< std::future< std::vector< IAlignment::SharedPtr > > > > futureFunctions;
-
-		std::vector< BamAlignmentReader::SharedPtr > bamAlignmentReaders;
-		std::unordered_set< std::string > regionStrings;
-		for (auto regionPtr : regionPtrs)
-		{
-			auto bamAlignmentReaderPtr = m_alignment_reader_manager->getReader(bamPath);
-			position bamLastPosition = BamAlignmentReader::GetLastPositionInBam(bamPath, regionPtr);
-			auto funct = std::bind(&BamAlignmentReader::loadAlignmentsInRegion, bamAlignmentReaderPtr, regionPtr, m_sample_manager_ptr, this->m_exclude_duplicate_reads);
-			auto future = ThreadPool::Instance()->enqueue(funct);
-			futureFunctions.push_back(future);
-			bamAlignmentReaders.push_back(bamAlignmentReaderPtr);
-		}
-
-		{
-			std::lock_guard< std::mutex > lockGuard(m_alignment_ptrs_lock);
-			this->m_name_alignment_ptr_map_ptr->clear();
-		}
-		while (!futureFunctions.empty())
+		// the windows are sorted and don't overlap so a read starting before a window was already added by the one before it
+		std::lock_guard< std::mutex > lockGuard(m_alignment_ptrs_lock);
+		for (size_t i = 0; i < regionAlignmentStorePtrs.size(); ++i)
 		{
-			auto futureFunct = futureFunctions.front();
-			futureFunctions.pop_front();
-			if (futureFunct->wait_for(std::chrono::milliseconds(100)) == std::future_status::ready)
-			{
-				std::lock_guard< std::mutex > lockGuard(m_alignment_ptrs_lock);
-				auto loadedAlignmentPtrs = futureFunct->get();
-				for (auto& alignmentPtr : loadedAlignmentPtrs)
-				{
-					if (m_name_alignment_ptr_map_ptr->find(alignmentPtr->getID()) == m_name_alignment_ptr_map_ptr->end())
-					{
-						m_name_alignment_ptr_map_ptr->emplace(alignmentPtr->getID(), alignmentPtr);
-						this->m_alignment_ptrs.push_back(alignmentPtr);
-					}
-				}
-				continue;
-			}
-			else
-			{
-				futureFunctions.emplace_back(futureFunct);
-			}
+			position previousEndPosition = (i > 0) ? fetchRegionPtrs[i - 1]->getEndPosition() : 0;
+			this->m_alignment_store_ptr->addAlignments(regionAlignmentStorePtrs[i], previousEndPosition);
 		}
 		this->m_loaded = true;
 	}
 
 	SampleManager::SharedPtr BamAlignmentManager::getSamplePtrs() { return m_sample_manager_ptr; }
 
+	uint64_t BamAlignmentManager::getMemoryUsage()
+	{
+		std::lock_guard< std::mutex > lockGuard(m_alignment_ptrs_lock);
+		return this->m_alignment_store_ptr->getMemoryUsage();
+	}
+
 	void BamAlignmentManager::waitForAlignmentsToLoad()
 	{
 		for (auto threadPtr : this->m_loading_thread_ptrs)
 		{
 			threadPtr->join();
 		}
-		std::sort(this->m_alignment_ptrs.begin(), this->m_alignment_ptrs.end(),
-				  [] (const IAlignment::SharedPtr& a, const IAlignment::SharedPtr& b)
-				  {
-					  return a->getPosition() < b->getPosition();
-				  });
+		this->m_alignment_store_ptr->sortByPosition();
 	}
 
 	std::vector< Sample::SharedPtr > BamAlignmentManager::GetSamplePtrs(std::vector< std::string >& bamPaths)
@@ -200,7 +107,7 @@ namespace graphite
 		std::vector< Sample::SharedPtr > samplePtrs;
 		for (auto bamPath : bamPaths)
 		{
-			auto tmpSamplePtrs = graphite::BamAlignmentReader::GetBamReaderSamples(bamPath);
+			auto tmpSamplePtrs = graphite::HTSLibAlignmentReader::GetBamReaderSamples(bamPath);
 			samplePtrs.insert(samplePtrs.end(), tmpSamplePtrs.begin(), tmpSamplePtrs.end());
 		}
 		return samplePtrs;
@@ -211,12 +118,23 @@ namespace graphite
 		uint32_t readLength = 0;
 		for (auto bamPath : bamPaths)
 		{
-			auto tmpReadLength = graphite::BamAlignmentReader::GetReadLength(bamPath);
+			auto tmpReadLength = graphite::HTSLibAlignmentReader::GetReadLength(bamPath);
 			readLength = (readLength < tmpReadLength) ? tmpReadLength : readLength;
 		}
 		return readLength;
 	}
 
+	AlignmentReaderManager< IAlignmentReader >::SharedPtr BamAlignmentManager::CreateAlignmentReaderManager(const std::vector< std::string >& bamPaths, uint32_t numReadersPerFile, bool useBamTools)
+	{
+		return std::make_shared< AlignmentReaderManager< IAlignmentReader > >(bamPaths, numReadersPerFile, [useBamTools](const std::string& bamPath, AlignmentReaderManager< IAlignmentReader >* alignmentReaderManagerPtr) -> IAlignmentReader::SharedPtr {
+				if (useBamTools)
+				{
+					return std::make_shared< BamAlignmentReader >(bamPath, alignmentReaderManagerPtr);
+				}
+				return std::make_shared< HTSLibAlignmentReader >(bamPath, alignmentReaderManagerPtr);
+			});
+	}
+
 	void BamAlignmentManager::releaseResources()
 	{
 	}
@@ -4,6 +4,7 @@
 #include "IAlignmentManager.h"
 #include "AlignmentReaderManager.hpp"
 #include "BamAlignmentReader.h"
+#include "HTSLibAlignmentReader.h"
 #include "core/region/Region.h"
 #include "core/variant/IVariantList.h"
 #include "core/variant/IVariantManager.h"
@@ -22,19 +23,22 @@ namespace graphite
 	public:
 		typedef std::shared_ptr< BamAlignmentManager > SharedPtr;
 		BamAlignmentManager(SampleManager::SharedPtr sampleManager, Region::SharedPtr regionPtr, bool excludeDuplicateReads = false);
-		BamAlignmentManager(SampleManager::SharedPtr sampleManager, Region::SharedPtr regionPtr, AlignmentReaderManager< BamAlignmentReader >::SharedPtr alignmentReaderManagerPtr, bool excludeDuplicateReads = false);
+		BamAlignmentManager(SampleManager::SharedPtr sampleManager, Region::SharedPtr regionPtr, AlignmentReaderManager< IAlignmentReader >::SharedPtr alignmentReaderManagerPtr, bool excludeDuplicateReads = false);
 		~BamAlignmentManager();
 
 		void loadAlignments(IVariantManager::SharedPtr variantManagerPtr);
 		void asyncLoadAlignments(IVariantManager::SharedPtr variantManagerPtr, uint32_t variantPadding);
 		void waitForAlignmentsToLoad();
 		void releaseResources() override;
+		uint64_t getMemoryUsage(); // an estimate of the bytes held by the loaded alignments
 		/* void processMappingStatistics() override; */
 		SampleManager::SharedPtr getSamplePtrs() override;
 		static std::vector< Sample::SharedPtr > GetSamplePtrs(std::vector< std::string >& bamPaths);
 		static uint32_t GetReadLength(std::vector< std::string >& bamPaths);
+		// the readers go through htslib unless useBamTools is set
+		static AlignmentReaderManager< IAlignmentReader >::SharedPtr CreateAlignmentReaderManager(const std::vector< std::string >& bamPaths, uint32_t numReadersPerFile, bool useBamTools);
 	private:
-		void loadBam(const std::string bamPath, IVariantManager::SharedPtr variantManagerPtr, uint32_t variantPadding);
+		void loadBam(const std::string bamPath, std::vector< Region::SharedPtr > fetchRegionPtrs);
 
 		std::mutex m_loaded_mutex;
 		bool m_loaded;
@@ -43,7 +47,7 @@ namespace graphite
 		std::vector< std::shared_ptr< std::thread > > m_loading_thread_ptrs;
 		std::mutex m_alignment_ptrs_lock;
 		SampleManager::SharedPtr m_sample_manager_ptr;
-		AlignmentReaderManager< BamAlignmentReader >::SharedPtr m_alignment_reader_manager;
+		AlignmentReaderManager< IAlignmentReader >::SharedPtr m_alignment_reader_manager;
 	};
 }
 
@@ -1,5 +1,4 @@
 #include "BamAlignmentReader.h"
-#include "BamAlignment.h"
 #include "AlignmentList.h"
 #include "core/sample/Sample.h"
 
@@ -15,7 +14,7 @@ namespace graphite
 
 	}
 
-	BamAlignmentReader::BamAlignmentReader(const std::string& bamPath, AlignmentReaderManager< BamAlignmentReader >* alignmentReaderManagerPtr) :
+	BamAlignmentReader::BamAlignmentReader(const std::string& bamPath, AlignmentReaderManager< IAlignmentReader >* alignmentReaderManagerPtr) :
 	    m_bam_path(bamPath),
 		m_is_open(false),
 		m_alignment_reader_manager_ptr(alignmentReaderManagerPtr)
@@ -47,14 +46,14 @@ namespace graphite
 		this->m_bam_reader->Close();
 	}
 
-	std::vector< IAlignment::SharedPtr > BamAlignmentReader::loadAlignmentsInRegion(Region::SharedPtr regionPtr, SampleManager::SharedPtr sampleManagerPtr, bool excludeDuplicateReads)
+	AlignmentStore::SharedPtr BamAlignmentReader::loadAlignmentsInRegion(Region::SharedPtr regionPtr, SampleManager::SharedPtr sampleManagerPtr, bool excludeDuplicateReads)
 	{
 		if (!m_is_open)
 		{
 			std::cout << "Bam file not opened" << std::endl;
 			exit(0);
 		}
-		std::vector< IAlignment::SharedPtr > alignmentPtrs;
+		auto alignmentStorePtr = std::make_shared< AlignmentStore >();
 
 		int refID = this->m_bam_reader->GetReferenceID(regionPtr->getReferenceID());
 		// add 1 to the start and end positions because this is 0 based
@@ -64,7 +63,9 @@ namespace graphite
 		BamTools::BamAlignment bamAlignment;
 		while(this->m_bam_reader->GetNextAlignment(bamAlignment))
 		{
+			if (bamAlignment.Position >= regionPtr->getEndPosition()) { break; } // same half open region as the htslib reader so fetch windows can meet
             if (bamAlignment.IsDuplicate() && excludeDuplicateReads) { continue; }
+			if (!bamAlignment.IsPrimaryAlignment() || (bamAlignment.AlignmentFlag & 0x800)) { continue; } // only the primary line of a read is kept
 			std::string sampleName;
 			bamAlignment.GetTag("RG", sampleName);
 
@@ -73,7 +74,7 @@ namespace graphite
 			{
 				throw "There was an error in the sample name for: " + sampleName;
 			}
-			alignmentPtrs.push_back(std::make_shared< BamAlignment >(bamAlignment, samplePtr));
+			alignmentStorePtr->addAlignment(bamAlignment.Position, bamAlignment.Name, bamAlignment.QueryBases, samplePtr, bamAlignment.IsFirstMate(), bamAlignment.IsMapped(), bamAlignment.IsReverseStrand(), bamAlignment.IsDuplicate(), bamAlignment.MapQuality);
 		}
 		// std::this_thread::sleep_for(std::chrono::milliseconds(10000));
 		if (m_alignment_reader_manager_ptr != nullptr)
@@ -81,8 +82,8 @@ namespace graphite
 			m_alignment_reader_manager_ptr->checkinReader(this->shared_from_this());
 		}
 
-		// std::cout << "got reads: " << regionPtr->getRegionString() << " " << alignmentPtrs.size() << std::endl;
-		return alignmentPtrs;
+		// std::cout << "got reads: " << regionPtr->getRegionString() << " " << alignmentStorePtr->getCount() << std::endl;
+		return alignmentStorePtr;
 	}
 
 	std::vector< Sample::SharedPtr > BamAlignmentReader::GetBamReaderSamples(const std::string& bamPath)
@@ -7,6 +7,7 @@
 #include "core/region/Region.h"
 
 #include "AlignmentReaderManager.hpp"
+#include "AlignmentStore.h"
 #include "IAlignment.h"
 #include "IAlignmentList.h"
 #include "IAlignmentReader.h"
@@ -19,23 +20,23 @@ namespace graphite
 	public:
         typedef std::shared_ptr< BamAlignmentReader > SharedPtr;
         BamAlignmentReader(const std::string& bamPath);
-		BamAlignmentReader(const std::string& bamPath, AlignmentReaderManager< BamAlignmentReader >* alignmentReaderManager);
+		BamAlignmentReader(const std::string& bamPath, AlignmentReaderManager< IAlignmentReader >* alignmentReaderManager);
 		~BamAlignmentReader();
 
 		void open() override;
 		void close() override;
 
-        std::vector< IAlignment::SharedPtr > loadAlignmentsInRegion(Region::SharedPtr regionPtr, SampleManager::SharedPtr sampleManagerPtr, bool excludeDuplicateReads = false) override;
+        AlignmentStore::SharedPtr loadAlignmentsInRegion(Region::SharedPtr regionPtr, SampleManager::SharedPtr sampleManagerPtr, bool excludeDuplicateReads = false) override;
 
         static std::vector< Sample::SharedPtr > GetBamReaderSamples(const std::string& bamPath);
 		static position GetLastPositionInBam(const std::string& bamPath, Region::SharedPtr regionPtr);
 		static uint32_t GetReadLength(const std::string& bamPath);
 
-		std::string getPath() { return m_bam_path; }
+		std::string getPath() override { return m_bam_path; }
         uint32_t getReaderID() { return m_id; }
 
 	private:
-        AlignmentReaderManager< BamAlignmentReader >* m_alignment_reader_manager_ptr;
+        AlignmentReaderManager< IAlignmentReader >* m_alignment_reader_manager_ptr;
 
 		std::shared_ptr< BamTools::BamReader > m_bam_reader;
 		std::string m_bam_path;
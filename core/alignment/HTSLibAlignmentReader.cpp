@@ -0,0 +1,171 @@
+#include "HTSLibAlignmentReader.h"
+#include "core/sample/Sample.h"
+#include "core/util/BGZFThreadPool.hpp"
+
+#include <cstring>
+#include <sstream>
+
+namespace graphite
+{
+	HTSLibAlignmentReader::HTSLibAlignmentReader(const std::string& bamPath) :
+		m_bam_path(bamPath),
+		m_file_ptr(nullptr),
+		m_header_ptr(nullptr),
+		m_index_ptr(nullptr),
+		m_record_ptr(nullptr),
+		m_is_open(false),
+		m_alignment_reader_manager_ptr(nullptr)
+	{
+	}
+
+	HTSLibAlignmentReader::HTSLibAlignmentReader(const std::string& bamPath, AlignmentReaderManager< IAlignmentReader >* alignmentReaderManagerPtr) :
+		m_bam_path(bamPath),
+		m_file_ptr(nullptr),
+		m_header_ptr(nullptr),
+		m_index_ptr(nullptr),
+		m_record_ptr(nullptr),
+		m_is_open(false),
+		m_alignment_reader_manager_ptr(alignmentReaderManagerPtr)
+	{
+	}
+
+	HTSLibAlignmentReader::~HTSLibAlignmentReader()
+	{
+		close();
+	}
+
+	void HTSLibAlignmentReader::open()
+	{
+		std::lock_guard< std::mutex > l(m_lock);
+		if (m_is_open) { return; }
+		this->m_file_ptr = sam_open(this->m_bam_path.c_str(), "r");
+		if (this->m_file_ptr == nullptr)
+		{
+			throw "Unable to open bam file";
+		}
+		hts_set_thread_pool(this->m_file_ptr, BGZFThreadPool::Instance()->getThreadPool());
+		this->m_header_ptr = sam_hdr_read(this->m_file_ptr);
+		this->m_index_ptr = sam_index_load(this->m_file_ptr, this->m_bam_path.c_str());
+		if (this->m_header_ptr == nullptr || this->m_index_ptr == nullptr)
+		{
+			throw "Unable to open bam file";
+		}
+		this->m_record_ptr = bam_init1();
+		m_is_open = true;
+	}
+
+	void HTSLibAlignmentReader::close()
+	{
+		std::lock_guard< std::mutex > l(m_lock);
+		if (!m_is_open) { return; }
+		m_is_open = false;
+		bam_destroy1(this->m_record_ptr);
+		hts_idx_destroy(this->m_index_ptr);
+		bam_hdr_destroy(this->m_header_ptr);
+		sam_close(this->m_file_ptr);
+	}
+
+	AlignmentStore::SharedPtr HTSLibAlignmentReader::loadAlignmentsInRegion(Region::SharedPtr regionPtr, SampleManager::SharedPtr sampleManagerPtr, bool excludeDuplicateReads)
+	{
+		if (!m_is_open)
+		{
+			std::cout << "Bam file not opened" << std::endl;
+			exit(0);
+		}
+		auto alignmentStorePtr = std::make_shared< AlignmentStore >();
+
+		int refID = bam_name2id(this->m_header_ptr, regionPtr->getReferenceID().c_str());
+		hts_itr_t* iterPtr = (refID >= 0) ? sam_itr_queryi(this->m_index_ptr, refID, regionPtr->getStartPosition(), regionPtr->getEndPosition()) : nullptr;
+		if (iterPtr != nullptr)
+		{
+			// reads come in runs from the same read group so the last lookup is kept instead of building a name per read
+			std::string sampleName;
+			Sample::SharedPtr samplePtr = nullptr;
+			bam1_t* recordPtr = this->m_record_ptr;
+			while (sam_itr_next(this->m_file_ptr, iterPtr, recordPtr) >= 0)
+			{
+				uint16_t flag = recordPtr->core.flag;
+				if ((flag & BAM_FDUP) && excludeDuplicateReads) { continue; }
+				if (flag & (BAM_FSECONDARY | BAM_FSUPPLEMENTARY)) { continue; } // only the primary line of a read is kept
+				uint8_t* readGroupPtr = bam_aux_get(recordPtr, "RG");
+				const char* readGroup = (readGroupPtr != nullptr) ? bam_aux2Z(readGroupPtr) : "";
+				if (samplePtr == nullptr || strcmp(sampleName.c_str(), readGroup) != 0)
+				{
+					sampleName = readGroup;
+					samplePtr = sampleManagerPtr->getSamplePtr(sampleName);
+					if (samplePtr == nullptr)
+					{
+						throw "There was an error in the sample name for: " + sampleName;
+					}
+				}
+
+				const char* name = bam_get_qname(recordPtr);
+				bool firstMate = flag & BAM_FREAD1;
+				uint64_t nameHash = AlignmentStore::HashName(name, strlen(name), firstMate);
+				alignmentStorePtr->addPackedAlignment(recordPtr->core.pos, nameHash, bam_get_seq(recordPtr), recordPtr->core.l_qseq, samplePtr, firstMate, !(flag & BAM_FUNMAP), flag & BAM_FREVERSE, flag & BAM_FDUP, recordPtr->core.qual);
+			}
+			hts_itr_destroy(iterPtr);
+		}
+		if (m_alignment_reader_manager_ptr != nullptr)
+		{
+			m_alignment_reader_manager_ptr->checkinReader(this->shared_from_this());
+		}
+		return alignmentStorePtr;
+	}
+
+	std::vector< Sample::SharedPtr > HTSLibAlignmentReader::GetBamReaderSamples(const std::string& bamPath)
+	{
+		std::vector< Sample::SharedPtr > samplePtrs;
+		samFile* filePtr = sam_open(bamPath.c_str(), "r");
+		bam_hdr_t* headerPtr = (filePtr != nullptr) ? sam_hdr_read(filePtr) : nullptr;
+		if (headerPtr == nullptr)
+		{
+			if (filePtr != nullptr) { sam_close(filePtr); }
+			throw "Unable to open bam file";
+		}
+		std::istringstream headerStream(std::string(headerPtr->text, headerPtr->l_text));
+		std::string line;
+		while (std::getline(headerStream, line))
+		{
+			if (line.compare(0, 3, "@RG") != 0) { continue; }
+			std::string readGroup;
+			std::string sampleName;
+			std::istringstream lineStream(line);
+			std::string field;
+			while (std::getline(lineStream, field, '\t'))
+			{
+				if (field.compare(0, 3, "ID:") == 0) { readGroup = field.substr(3); }
+				else if (field.compare(0, 3, "SM:") == 0) { sampleName = field.substr(3); }
+			}
+			samplePtrs.emplace_back(std::make_shared< Sample >(sampleName, readGroup, bamPath));
+		}
+		bam_hdr_destroy(headerPtr);
+		sam_close(filePtr);
+		return samplePtrs;
+	}
+
+	uint32_t HTSLibAlignmentReader::GetReadLength(const std::string& bamPath)
+	{
+		uint32_t bamReadLength = 300;
+		samFile* filePtr = sam_open(bamPath.c_str(), "r");
+		bam_hdr_t* headerPtr = (filePtr != nullptr) ? sam_hdr_read(filePtr) : nullptr;
+		if (headerPtr == nullptr)
+		{
+			if (filePtr != nullptr) { sam_close(filePtr); }
+			throw "Unable to open bam file";
+		}
+		bam1_t* recordPtr = bam_init1();
+		while (sam_read1(filePtr, headerPtr, recordPtr) >= 0)
+		{
+			if (!(recordPtr->core.flag & BAM_FSECONDARY))
+			{
+				bamReadLength = recordPtr->core.l_qseq;
+				break;
+			}
+		}
+		bam_destroy1(recordPtr);
+		bam_hdr_destroy(headerPtr);
+		sam_close(filePtr);
+		return bamReadLength;
+	}
+}
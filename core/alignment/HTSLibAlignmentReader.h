@@ -0,0 +1,54 @@
+#ifndef GRAPHITE_HTSLIBALIGNMENTREADER_H
+#define GRAPHITE_HTSLIBALIGNMENTREADER_H
+
+#include "core/region/Region.h"
+
+#include "AlignmentReaderManager.hpp"
+#include "AlignmentStore.h"
+#include "IAlignment.h"
+#include "IAlignmentList.h"
+#include "IAlignmentReader.h"
+
+#include "htslib/sam.h"
+
+namespace graphite
+{
+	/*
+	 * Reads BAMs through htslib. Records are read into one reused bam1_t and
+	 * only the fields graphite uses are pulled out of its buffer, the bases
+	 * are copied into the AlignmentStore still packed and the read group is
+	 * compared in place. The BGZF blocks are inflated on the shared BGZFThreadPool.
+	 */
+	class HTSLibAlignmentReader : public IAlignmentReader, public std::enable_shared_from_this< HTSLibAlignmentReader >
+	{
+	public:
+		typedef std::shared_ptr< HTSLibAlignmentReader > SharedPtr;
+		HTSLibAlignmentReader(const std::string& bamPath);
+		HTSLibAlignmentReader(const std::string& bamPath, AlignmentReaderManager< IAlignmentReader >* alignmentReaderManager);
+		~HTSLibAlignmentReader();
+
+		void open() override;
+		void close() override;
+
+		AlignmentStore::SharedPtr loadAlignmentsInRegion(Region::SharedPtr regionPtr, SampleManager::SharedPtr sampleManagerPtr, bool excludeDuplicateReads = false) override;
+
+		static std::vector< Sample::SharedPtr > GetBamReaderSamples(const std::string& bamPath);
+		static uint32_t GetReadLength(const std::string& bamPath);
+
+		std::string getPath() override { return m_bam_path; }
+		uint32_t getReaderID() { return m_id; }
+
+	private:
+		AlignmentReaderManager< IAlignmentReader >* m_alignment_reader_manager_ptr;
+
+		std::string m_bam_path;
+		samFile* m_file_ptr;
+		bam_hdr_t* m_header_ptr;
+		hts_idx_t* m_index_ptr;
+		bam1_t* m_record_ptr;
+		bool m_is_open;
+		std::mutex m_lock;
+	};
+}
+
+#endif //GRAPHITE_HTSLIBALIGNMENTREADER_H
@@ -7,39 +7,30 @@
 #include "core/sample/Sample.h"
 
 #include <memory>
-#include <unordered_map>
-#include <mutex>
-#include <vector>
 #include <string>
 
 namespace graphite
 {
 
-	class IMapping;
 	class IAlignment : private Noncopyable
 	{
 	public:
 		typedef std::shared_ptr< IAlignment > SharedPtr;
 
-	    IAlignment() : m_mapping_mutex(new std::recursive_mutex()) {}
-		virtual ~IAlignment() { delete this->m_mapping_mutex; }
+	    IAlignment() {}
+		virtual ~IAlignment() {}
 
 		virtual const char* getSequence() = 0;
 		virtual const position getPosition() = 0;
 		virtual const size_t getLength() = 0;
 		virtual const std::string getID() { return ""; }
+		virtual const uint64_t getNameHash() { return 0; } // the name hashed with the mate, see AlignmentStore::HashName
 		virtual const bool isFirstMate() { return false;}
 		virtual const bool isMapped() { return false; }
 		virtual const bool isReverseStrand() { return false; }
 		virtual const bool isDuplicate() { return false; }
 		virtual const uint16_t getOriginalMapQuality() { return 0; }
-		virtual std::vector< std::shared_ptr< IMapping > > getMappingPtrs() { return this->m_mapping_ptrs; }
-		virtual void addMapping(std::shared_ptr< IMapping > mappingPtr)
-		{
-			std::lock_guard< std::recursive_mutex > r_lock(*this->m_mapping_mutex);
-			m_mapping_ptrs.emplace_back(mappingPtr);
-		}
-		std::recursive_mutex* getMappingMutex() { return this->m_mapping_mutex; }
+		virtual const void* getRecordPtr() { return this; } // views of the same stored read return the same record
 		const Sample::SharedPtr getSample() { return m_sample_ptr; }
 
 		virtual const void setSequence(char* seq, uint32_t len) = 0;
@@ -47,10 +38,6 @@ namespace graphite
 		virtual const void incrementReferenceCount() = 0;
 
 	protected:
-		std::mutex m_mutex;
-		std::unordered_map< uint32_t, std::string > m_mapped_variants_information;
-		std::vector< std::shared_ptr< IMapping > > m_mapping_ptrs;
-		std::recursive_mutex* m_mapping_mutex;
 		Sample::SharedPtr m_sample_ptr;
 	};
 }
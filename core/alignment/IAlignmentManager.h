@@ -2,6 +2,7 @@
 #define GRAPHITE_IALIGNMENTMANAGER_H
 
 #include "AlignmentList.h"
+#include "AlignmentStore.h"
 #include "core/region/Region.h"
 #include "core/util/Noncopyable.hpp"
 #include "core/variant/IVariantList.h"
@@ -20,7 +21,7 @@ namespace graphite
 	{
 	public:
 		typedef std::shared_ptr< IAlignmentManager > SharedPtr;
-	    IAlignmentManager() : m_name_alignment_ptr_map_ptr(std::make_shared< std::unordered_map< std::string, IAlignment::SharedPtr > >()) {}
+	    IAlignmentManager() : m_alignment_store_ptr(std::make_shared< AlignmentStore >()) {}
 		virtual ~IAlignmentManager() {}
 
 		virtual void releaseResources() = 0;
@@ -28,55 +29,66 @@ namespace graphite
 		virtual SampleManager::SharedPtr getSamplePtrs() = 0;
 		virtual IAlignmentList::SharedPtr getAlignmentsInRegion(Region::SharedPtr regionPtr)
 		{
-			position startPosition = regionPtr->getStartPosition();
-			position endPosition = regionPtr->getEndPosition();
-
-			auto lowerBound = std::lower_bound(this->m_alignment_ptrs.begin(), this->m_alignment_ptrs.end(), nullptr, [startPosition](const IAlignment::SharedPtr& alignmentPtr, const IAlignment::SharedPtr& ignore) {
-					return startPosition > alignmentPtr->getPosition() + alignmentPtr->getLength();
-				});
-			auto upperBound = std::upper_bound(this->m_alignment_ptrs.begin(), this->m_alignment_ptrs.end(), nullptr, [endPosition](const IAlignment::SharedPtr& ignore, const IAlignment::SharedPtr& alignmentPtr) {
-					return alignmentPtr->getPosition() > endPosition;
-				});
-
-			std::vector< IAlignment::SharedPtr > alignmentPtrs;
-			alignmentPtrs.insert(alignmentPtrs.begin(), lowerBound, upperBound);
-			return std::make_shared< AlignmentList >(alignmentPtrs,m_name_alignment_ptr_map_ptr, regionPtr);
+			auto alignmentPtrs = this->m_alignment_store_ptr->getAlignmentPtrsInRegion(regionPtr->getStartPosition(), regionPtr->getEndPosition());
+			return std::make_shared< AlignmentList >(alignmentPtrs, regionPtr);
+		}
+		// every read overlapping any of regionPtrs once, in position order
+		virtual IAlignmentList::SharedPtr getAlignmentsInRegions(const std::vector< Region::SharedPtr >& regionPtrs)
+		{
+			std::vector< std::pair< position, position > > regions;
+			for (auto& regionPtr : regionPtrs)
+			{
+				regions.emplace_back(regionPtr->getStartPosition(), regionPtr->getEndPosition());
+			}
+			return std::make_shared< AlignmentList >(this->m_alignment_store_ptr->getAlignmentPtrsInRegions(regions));
 		}
 
 	protected:
+		/*
+		 * Merges the regions of the variants in m_region_ptr, each padded by
+		 * variantPadding, into sorted windows that don't overlap so every read
+		 * is decoded once. Long windows are cut at s_max_fetch_window_size so
+		 * the fetches still spread over the thread pool. A read that crosses
+		 * into the next window is returned by both fetches and is only kept by
+		 * the first, see AlignmentStore::addAlignments.
+		 */
 		std::vector< Region::SharedPtr > getRegionsContainingVariantsWithPadding(IVariantManager::SharedPtr variantManagerPtr, uint32_t variantPadding)
 		{
-			std::vector< Region::SharedPtr > regionPtrs;
-
+			std::vector< std::pair< position, position > > variantSpans;
 			auto variantListPtr = variantManagerPtr->getVariantsInRegion(this->m_region_ptr);
-			std::vector< IVariant::SharedPtr > variantPtrs;
 			IVariant::SharedPtr variantPtr;
 			while (variantListPtr->getNextVariant(variantPtr))
 			{
-				variantPtrs.emplace_back(variantPtr);
+				for (auto& variantRegionPtr : variantPtr->getRegions())
+				{
+					position startPosition = (variantRegionPtr->getStartPosition() > variantPadding) ? variantRegionPtr->getStartPosition() - variantPadding : 0;
+					variantSpans.emplace_back(startPosition, variantRegionPtr->getEndPosition() + variantPadding);
+				}
 			}
+			std::sort(variantSpans.begin(), variantSpans.end());
 
-			Region::SharedPtr regionPtr = nullptr;
-			for (auto i = 0; i < variantPtrs.size(); ++i)
+			std::vector< Region::SharedPtr > regionPtrs;
+			size_t i = 0;
+			while (i < variantSpans.size())
 			{
-				uint32_t maxAlleleSize = 3000;
-				position startPosition = ((variantPtrs[i]->getPosition() - (variantPadding * 2)) > 0) ? (variantPtrs[i]->getPosition() - (variantPadding * 2)) : 0;
-				position endPosition = (variantPtrs[i]->getPosition() + maxAlleleSize + (variantPadding * 2));
-				auto j = i + 1;
-				while (j < (variantPtrs.size() - 1) && variantPtrs[j]->getPosition() < endPosition)
+				position startPosition = variantSpans[i].first;
+				position endPosition = variantSpans[i].second;
+				for (++i; i < variantSpans.size() && variantSpans[i].first <= endPosition; ++i)
 				{
-					endPosition = (variantPtrs[j]->getPosition() + maxAlleleSize + (variantPadding * 2));
-					++j;
+					endPosition = std::max(endPosition, variantSpans[i].second);
+				}
+				for (; startPosition < endPosition; startPosition += s_max_fetch_window_size)
+				{
+					position windowEndPosition = (endPosition - startPosition > s_max_fetch_window_size) ? startPosition + s_max_fetch_window_size : endPosition;
+					regionPtrs.emplace_back(std::make_shared< Region >(this->m_region_ptr->getReferenceID(), startPosition, windowEndPosition, Region::BASED::ONE));
 				}
-				i = j - 1;
-				regionPtr = std::make_shared< Region >(this->m_region_ptr->getReferenceID(), startPosition, endPosition, Region::BASED::ONE);
-				regionPtrs.push_back(regionPtr);
 			}
 			return regionPtrs;
 		}
 
-		std::vector< IAlignment::SharedPtr > m_alignment_ptrs;
-		std::shared_ptr< std::unordered_map< std::string, IAlignment::SharedPtr > > m_name_alignment_ptr_map_ptr;
+		static const position s_max_fetch_window_size = 100000;
+
+		AlignmentStore::SharedPtr m_alignment_store_ptr;
 		Region::SharedPtr m_region_ptr;
 	};
 }
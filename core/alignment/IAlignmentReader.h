@@ -2,6 +2,7 @@
 #define GRAPHITE_IALIGNMENTREADER_HPP
 
 #include "IAlignmentList.h"
+#include "AlignmentStore.h"
 #include "core/region/Region.h"
 #include "core/util/Noncopyable.hpp"
 #include "core/sample/SampleManager.h"
@@ -13,6 +14,7 @@ namespace graphite
 	class IAlignmentReader : private Noncopyable
 	{
 	public:
+		typedef std::shared_ptr< IAlignmentReader > SharedPtr;
 		IAlignmentReader()
 		{
 			static uint32_t s_id = 0;
@@ -24,8 +26,9 @@ namespace graphite
 		virtual void open() = 0;
 		virtual void close() = 0;
 
-		virtual std::vector< IAlignment::SharedPtr > loadAlignmentsInRegion(Region::SharedPtr regionPtr, SampleManager::SharedPtr sampleManagerPtr, bool excludeDuplicateReads) = 0;
+		virtual AlignmentStore::SharedPtr loadAlignmentsInRegion(Region::SharedPtr regionPtr, SampleManager::SharedPtr sampleManagerPtr, bool excludeDuplicateReads) = 0;
 
+		virtual std::string getPath() = 0;
 		uint32_t getID() { return m_id; }
 
 	protected:
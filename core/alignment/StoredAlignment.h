@@ -0,0 +1,88 @@
+#ifndef GRAPHITE_STOREDALIGNMENT_H
+#define GRAPHITE_STOREDALIGNMENT_H
+
+#include "IAlignment.h"
+#include "AlignmentStore.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace graphite
+{
+	/*
+	 * A view of one read in an AlignmentStore. Views are made in blocks by the
+	 * store's lookups, one allocation for the views and one for a buffer with
+	 * room for all of their bases. The bases are decoded into the view's part
+	 * of that buffer the first time getSequence is called, by the thread
+	 * aligning the read, and a read that is never aligned is never decoded.
+	 */
+	class StoredAlignment : public IAlignment
+	{
+	public:
+		typedef std::shared_ptr< StoredAlignment > SharedPtr;
+		StoredAlignment() :
+			m_alignment_store_ptr(nullptr),
+			m_record_ptr(nullptr),
+			m_index(0),
+			m_sequence(nullptr),
+			m_decoded(false)
+		{
+		}
+
+		~StoredAlignment() {}
+
+		// sequenceBuffer has room for the read's bases and a terminating null, the store outlives the view
+		void setRecord(AlignmentStore* alignmentStorePtr, uint32_t index, char* sequenceBuffer)
+		{
+			m_alignment_store_ptr = alignmentStorePtr;
+			m_record_ptr = &alignmentStorePtr->getRecord(index);
+			m_index = index;
+			m_sequence = sequenceBuffer;
+			m_sample_ptr = alignmentStorePtr->getSamplePtr(m_record_ptr->sampleSlot);
+		}
+
+		const char* getSequence() override
+		{
+			if (!m_decoded)
+			{
+				m_alignment_store_ptr->getSequence(m_index, m_sequence);
+				m_decoded = true;
+			}
+			return m_sequence;
+		}
+		const size_t getLength() override { return m_record_ptr->length; }
+		const position getPosition() override { return m_record_ptr->startPosition; }
+		const uint64_t getNameHash() override { return m_record_ptr->nameHash; }
+		const std::string getID() override { return std::to_string(m_record_ptr->nameHash); } // for reports, compare getNameHash
+		const bool isFirstMate() override { return m_record_ptr->flags & AlignmentStore::FIRST_MATE; }
+		const bool isMapped() override { return m_record_ptr->flags & AlignmentStore::MAPPED; }
+		const bool isReverseStrand() override { return m_record_ptr->flags & AlignmentStore::REVERSE_STRAND; }
+		const bool isDuplicate() override { return m_record_ptr->flags & AlignmentStore::DUPLICATE; }
+		const uint16_t getOriginalMapQuality() override { return m_record_ptr->mapQuality; }
+		const void* getRecordPtr() override { return m_record_ptr; }
+
+		const void incrementReferenceCount() override {}
+		// the view's buffer only has room for the stored read, so the bases have to be the same length
+		const void setSequence(char* seq, uint32_t len) override
+		{
+			if (len != m_record_ptr->length)
+			{
+				throw std::runtime_error("A stored alignment's sequence can't change length, " + std::to_string(m_record_ptr->length) + " bases were replaced with " + std::to_string(len));
+			}
+			memcpy(m_sequence, seq, len);
+			m_sequence[len] = '\0'; // the buffer may not have been decoded into yet
+			m_decoded = true;
+		}
+		const void removeSequence() override { m_decoded = false; } // the buffer belongs to the lookup, the bases are decoded again if they are asked for
+
+	private:
+		AlignmentStore* m_alignment_store_ptr; // kept alive by the block the view is in
+		const AlignmentStore::AlignmentRecord* m_record_ptr;
+		uint32_t m_index;
+		char* m_sequence;
+		bool m_decoded;
+	};
+}
+
+#endif //GRAPHITE_STOREDALIGNMENT_H
@@ -6,6 +6,14 @@
 #include "AlleleMetaData.h"
 #include "core/alignment/IAlignment.h"
 #include "core/sample/Sample.h"
+#include "core/sample/SampleManager.h"
+#include "core/util/SequenceCompare.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+#include <stdlib.h>
 
 namespace graphite
 {
@@ -18,18 +26,27 @@ namespace graphite
 
 	    Allele(const std::string& sequence) :
 		    m_sequence(sequence),
-			m_allele_meta_data_ptr(std::make_shared< AlleleMetaData >(0, 0))
+			m_allele_meta_data_ptr(std::make_shared< AlleleMetaData >(0, 0)),
+			m_count_blocks(nullptr)
 		{
 		}
 
 	    Allele(const std::string& sequence, AlleleMetaData::SharedPtr alleleMetaDataPtr) :
 			m_sequence(sequence),
-			m_allele_meta_data_ptr(alleleMetaDataPtr)
+			m_allele_meta_data_ptr(alleleMetaDataPtr),
+			m_count_blocks(nullptr)
 		{
 		}
 
 		~Allele()
 		{
+			CountBlock* blockPtr = this->m_count_blocks.load();
+			while (blockPtr != nullptr)
+			{
+				CountBlock* nextPtr = blockPtr->next;
+				DestroyCountBlock(blockPtr);
+				blockPtr = nextPtr;
+			}
 		}
 
 
@@ -42,64 +59,44 @@ namespace graphite
 
 		virtual uint32_t getForwardCount(const std::string& sampleName, AlleleCountType alleleCountType) override
 		{
-			std::lock_guard< std::mutex > lock(m_alignment_count_mutex);
-			auto iter = m_alignment_sample_forward_count_map.find(sampleName);
-			return (iter == m_alignment_sample_forward_count_map.end()) ? 0 : iter->second->getScoreCount(alleleCountType);
+			return getSampleCount(sampleName, false, alleleCountType);
 		}
 		virtual uint32_t getReverseCount(const std::string& sampleName, AlleleCountType alleleCountType) override
 		{
-			std::lock_guard< std::mutex > lock(m_alignment_count_mutex);
-			auto iter = m_alignment_sample_reverse_count_map.find(sampleName);
-			return (iter == m_alignment_sample_reverse_count_map.end()) ? 0 : iter->second->getScoreCount(alleleCountType);
+			return getSampleCount(sampleName, true, alleleCountType);
 		}
-		virtual uint32_t getTotalCount(AlleleCountType alleleCountType) override
+		virtual uint32_t getCount(uint32_t sampleIndex, bool isReverseStrand, AlleleCountType alleleCountType) override
 		{
-			uint32_t totalCount = 0;
-			for (auto iter : m_alignment_sample_forward_count_map)
+			for (CountBlock* blockPtr = this->m_count_blocks.load(std::memory_order_acquire); blockPtr != nullptr; blockPtr = blockPtr->next)
 			{
-				totalCount += iter.second->getTotalCount();
+				if (sampleIndex >= blockPtr->firstSampleIndex && sampleIndex < blockPtr->firstSampleIndex + blockPtr->sampleCount)
+				{
+					return blockPtr->counts[CountOffset(sampleIndex - blockPtr->firstSampleIndex, isReverseStrand, alleleCountType)].load(std::memory_order_relaxed);
+				}
 			}
-			for (auto iter : m_alignment_sample_reverse_count_map)
+			return 0;
+		}
+		virtual uint32_t getTotalCount(AlleleCountType alleleCountType) override
+		{
+			uint32_t totalCount = 0;
+			for (CountBlock* blockPtr = this->m_count_blocks.load(std::memory_order_acquire); blockPtr != nullptr; blockPtr = blockPtr->next)
 			{
-				totalCount += iter.second->getTotalCount();
+				for (uint32_t i = 0; i < blockPtr->sampleCount * COUNTS_PER_SAMPLE; ++i)
+				{
+					totalCount += blockPtr->counts[i].load(std::memory_order_relaxed);
+				}
 			}
 			return totalCount;
 		}
 
 		virtual void incrementForwardCount(std::shared_ptr< Sample > samplePtr, AlleleCountType alleleCountType) override
 		{
-			std::lock_guard< std::mutex > lock(m_alignment_count_mutex);
-			auto iter = m_alignment_sample_forward_count_map.find(samplePtr->getName());
-			if (iter == m_alignment_sample_forward_count_map.end())
-			{
-				/* m_alignment_sample_forward_count_map.emplace(samplePtr->getName(), 1); */
-				/* iter = m_alignment_sample_forward_count_map.find(samplePtr->getName()); */
-				auto scoreCounterPtr = std::make_shared< ScoreCounter >();
-				scoreCounterPtr->incrementScoreCount(alleleCountType);
-				m_alignment_sample_forward_count_map.emplace(samplePtr->getName(), scoreCounterPtr);
-			}
-			else
-			{
-				iter->second->incrementScoreCount(alleleCountType);
-				/* ++iter->second; */
-			}
+			getCounter(samplePtr->getIndex(), false, alleleCountType).fetch_add(1, std::memory_order_relaxed);
 		}
 
 		virtual void incrementReverseCount(std::shared_ptr< Sample > samplePtr, AlleleCountType alleleCountType) override
 		{
-			std::lock_guard< std::mutex > lock(m_alignment_count_mutex);
-			auto iter = m_alignment_sample_reverse_count_map.find(samplePtr->getName());
-			if (iter == m_alignment_sample_reverse_count_map.end())
-			{
-				auto scoreCounterPtr = std::make_shared< ScoreCounter >();
-				scoreCounterPtr->incrementScoreCount(alleleCountType);
-				m_alignment_sample_reverse_count_map.emplace(samplePtr->getName(), std::make_shared< ScoreCounter >());
-				/* iter = m_alignment_sample_reverse_count_map.find(samplePtr->getName()); */
-			}
-			else
-			{
-				iter->second->incrementScoreCount(alleleCountType);
-			}
+			getCounter(samplePtr->getIndex(), true, alleleCountType).fetch_add(1, std::memory_order_relaxed);
 		}
 
 		virtual void incrementCount(bool isReverseStrand, std::shared_ptr< Sample > alignmentPtr, AlleleCountType alleleCountType) override
@@ -116,67 +113,110 @@ namespace graphite
 
 		uint32_t getCommonPrefixSize(IAllele::SharedPtr allelePtr) override
 		{
-			uint32_t commonIndex = 0;
 			uint32_t minSize = (this->getLength() < allelePtr->getLength()) ? this->getLength() : allelePtr->getLength();
-			for (uint32_t i = 0; i < minSize; ++i) { if (this->getSequence()[i] != allelePtr->getSequence()[i]) { return i; } }
-			return minSize;
+			return CommonPrefixLength(this->getSequence(), allelePtr->getSequence(), minSize);
 		}
 
 		uint32_t getCommonSuffixSize(IAllele::SharedPtr allelePtr) override
 		{
-			uint32_t commonIndex = 0;
-			uint32_t minSize = (this->getLength() < allelePtr->getLength()) ? this->getLength() : allelePtr->getLength();
-			for (uint32_t i = 0; i < minSize; ++i) { if (this->getSequence()[(this->getLength() - 1) - i] != allelePtr->getSequence()[(allelePtr->getLength() - 1) - i]) { return i; } }
-			return minSize;
+			return CommonSuffixLength(this->getSequence(), this->getLength(), allelePtr->getSequence(), allelePtr->getLength());
 		}
 
 	protected:
-		Allele() {}
+		Allele() : m_count_blocks(nullptr) {}
+
+		/*
+		 * Counts are kept per sample index in blocks of atomics, with each
+		 * sample's forward and reverse counts for every AlleleCountType on a
+		 * cache line of its own. The first count allocates a block for every
+		 * sample registered so far; samples registered later get a new block
+		 * pushed onto the front of the list, so counting never takes a lock.
+		 */
+		static const uint32_t CACHE_LINE_SIZE = 64;
+		static const uint32_t COUNTS_PER_STRAND = 6; // one per AlleleCountType
+		static const uint32_t COUNTS_PER_SAMPLE = CACHE_LINE_SIZE / sizeof(std::atomic< uint32_t >);
+
+		struct CountBlock
+		{
+			uint32_t firstSampleIndex;
+			uint32_t sampleCount;
+			CountBlock* next;
+			std::atomic< uint32_t >* counts;
+		};
+
+		static uint32_t CountOffset(uint32_t sampleIndex, bool isReverseStrand, AlleleCountType alleleCountType)
+		{
+			static_assert(2 * COUNTS_PER_STRAND <= COUNTS_PER_SAMPLE, "a sample's counts must fit on one cache line");
+			return (sampleIndex * COUNTS_PER_SAMPLE) + (isReverseStrand ? COUNTS_PER_STRAND : 0) + static_cast< uint32_t >(alleleCountType);
+		}
 
-		class ScoreCounter
+		std::atomic< uint32_t >& getCounter(uint32_t sampleIndex, bool isReverseStrand, AlleleCountType alleleCountType)
 		{
-		public:
-			typedef std::shared_ptr< ScoreCounter > SharedPtr;
-			ScoreCounter()
+			CountBlock* headPtr = this->m_count_blocks.load(std::memory_order_acquire);
+			while (true)
 			{
-				m_score_map[AlleleCountType::Ambiguous] = 0;
-				m_score_map[AlleleCountType::LowPercent] = 0;
-				m_score_map[AlleleCountType::SeventyPercent] = 0;
-				m_score_map[AlleleCountType::EightyPercent] = 0;
-				m_score_map[AlleleCountType::NinteyPercent] = 0;
-				m_score_map[AlleleCountType::NinteyFivePercent] = 0;
+				for (CountBlock* blockPtr = headPtr; blockPtr != nullptr; blockPtr = blockPtr->next)
+				{
+					if (sampleIndex >= blockPtr->firstSampleIndex && sampleIndex < blockPtr->firstSampleIndex + blockPtr->sampleCount)
+					{
+						return blockPtr->counts[CountOffset(sampleIndex - blockPtr->firstSampleIndex, isReverseStrand, alleleCountType)];
+					}
+				}
+
+				uint32_t firstSampleIndex = (headPtr == nullptr) ? 0 : headPtr->firstSampleIndex + headPtr->sampleCount;
+				uint32_t sampleCount = std::max(SampleManager::GetSampleIndexCount(), sampleIndex + 1) - firstSampleIndex;
+				CountBlock* blockPtr = CreateCountBlock(firstSampleIndex, sampleCount, headPtr);
+				if (!this->m_count_blocks.compare_exchange_strong(headPtr, blockPtr, std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					DestroyCountBlock(blockPtr); // another thread added a block first, headPtr now points at it
+				}
+				else
+				{
+					headPtr = blockPtr;
+				}
 			}
+		}
 
-			void incrementScoreCount(AlleleCountType alleleCountType)
+		uint32_t getSampleCount(const std::string& sampleName, bool isReverseStrand, AlleleCountType alleleCountType)
+		{
+			uint32_t sampleIndex;
+			if (!SampleManager::GetSampleIndex(sampleName, sampleIndex))
 			{
-				++m_score_map[alleleCountType];
+				return 0;
 			}
+			return getCount(sampleIndex, isReverseStrand, alleleCountType);
+		}
 
-			uint32_t getScoreCount(AlleleCountType alleleCountType)
+		static CountBlock* CreateCountBlock(uint32_t firstSampleIndex, uint32_t sampleCount, CountBlock* next)
+		{
+			void* counts = nullptr;
+			size_t countsSize = sampleCount * COUNTS_PER_SAMPLE * sizeof(std::atomic< uint32_t >);
+			if (posix_memalign(&counts, CACHE_LINE_SIZE, countsSize) != 0)
 			{
-				return m_score_map[alleleCountType];
+				throw std::bad_alloc();
 			}
-
-			uint32_t getTotalCount()
+			CountBlock* blockPtr = new CountBlock();
+			blockPtr->firstSampleIndex = firstSampleIndex;
+			blockPtr->sampleCount = sampleCount;
+			blockPtr->next = next;
+			blockPtr->counts = static_cast< std::atomic< uint32_t >* >(counts);
+			for (uint32_t i = 0; i < sampleCount * COUNTS_PER_SAMPLE; ++i)
 			{
-				uint32_t count = 0;
-				for (auto iter: m_score_map)
-				{
-					count += iter.second;
-				}
-				return count;
+				new (&blockPtr->counts[i]) std::atomic< uint32_t >(0);
 			}
+			return blockPtr;
+		}
 
-		private:
-			std::unordered_map< AlleleCountType, uint32_t, AlleleCountTypeHash > m_score_map;
-		};
+		static void DestroyCountBlock(CountBlock* blockPtr)
+		{
+			free(blockPtr->counts);
+			delete blockPtr;
+		}
 
 		/* Sequence::SharedPtr m_sequence_ptr; */
 		std::string m_sequence;
 		AlleleMetaData::SharedPtr m_allele_meta_data_ptr;
-		std::mutex m_alignment_count_mutex;
-		std::unordered_map< std::string, ScoreCounter::SharedPtr > m_alignment_sample_forward_count_map;
-		std::unordered_map< std::string, ScoreCounter::SharedPtr > m_alignment_sample_reverse_count_map;
+		std::atomic< CountBlock* > m_count_blocks;
 
 	};
 }
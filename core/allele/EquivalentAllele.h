@@ -52,6 +52,15 @@ namespace graphite
 			}
 			return count;
 		}
+		inline uint32_t getCount(uint32_t sampleIndex, bool isReverseStrand, AlleleCountType alleleCountType) override
+		{
+			uint32_t count = 0;
+			for (auto& allelePtr : this->m_allele_ptrs)
+			{
+				count += allelePtr->getCount(sampleIndex, isReverseStrand, alleleCountType);
+			}
+			return count;
+		}
 		inline uint32_t getTotalCount(AlleleCountType alleleCountType) override
 		{
 			uint32_t count = 0;
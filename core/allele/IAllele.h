@@ -37,6 +37,7 @@ namespace graphite
 		virtual uint32_t getForwardCount(const std::string& sampleName, AlleleCountType alleleCountType) = 0;
 		virtual uint32_t getReverseCount(const std::string& sampleName, AlleleCountType alleleCountType) = 0;
 		virtual uint32_t getTotalCount(AlleleCountType alleleCountType) = 0;
+		virtual uint32_t getCount(uint32_t sampleIndex, bool isReverseStrand, AlleleCountType alleleCountType) = 0; // by SampleManager index, for callers that resolve the sample once
 
 		/* virtual void incrementForwardCount(std::shared_ptr< IAlignment > alignmentPtr) = 0; */
 		/* virtual void incrementReverseCount(std::shared_ptr< IAlignment > alignmentPtr) = 0; */
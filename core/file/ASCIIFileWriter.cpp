@@ -21,7 +21,7 @@ namespace graphite
 	{
 		if (!m_opened) { return false; }
 		this->m_out_stream.write(data, dataLength);
-		m_opened = true;
+		return true;
 	}
 
 	bool ASCIIFileWriter::open()
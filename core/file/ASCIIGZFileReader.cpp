@@ -1,19 +1,24 @@
 #include "ASCIIGZFileReader.h"
+#include "core/util/BGZFThreadPool.hpp"
 
-#include <zconf.h>
+#include <stdlib.h>
 
 
 namespace graphite
 {
 	ASCIIGZFileReader::ASCIIGZFileReader(const std::string& path) :
-		IFile(path)
+		IFile(path),
+		m_bgzf_ptr(nullptr)
 	{
+		m_line_buffer.l = m_line_buffer.m = 0;
+		m_line_buffer.s = nullptr;
 		Open();
 	}
 
 	ASCIIGZFileReader::~ASCIIGZFileReader()
 	{
 		Close();
+		free(m_line_buffer.s);
 	}
 
 	void ASCIIGZFileReader::Open()
@@ -23,21 +28,24 @@ namespace graphite
 		{
             throw std::ios_base::failure("File not found: " + this->m_file_path);
 		}
+		m_bgzf_ptr = bgzf_open(this->m_file_path.c_str(), "r");
+		if (m_bgzf_ptr == nullptr)
+		{
+			throw std::ios_base::failure("Unable to open file: " + this->m_file_path);
+		}
+		if (m_bgzf_ptr->is_compressed && !m_bgzf_ptr->is_gzip) // only BGZF blocks can be inflated out of order
+		{
+			auto threadPoolPtr = BGZFThreadPool::Instance()->getThreadPool();
+			bgzf_thread_pool(m_bgzf_ptr, threadPoolPtr->pool, threadPoolPtr->qsize);
+		}
 		m_opened = true;
-		m_in_stream_ptr = std::make_shared< igzstream >();
-		m_in_stream_ptr->open(this->m_file_path.c_str());
-		/*
-		m_ifstream_ptr = std::make_shared< std::ifstream >(this->m_file_path, std::ios_base::in | std::ios_base::binary);
-		m_in_stream_ptr = std::make_shared< boost::iostreams::filtering_istream >();
-		m_in_stream_ptr->push(boost::iostreams::gzip_decompressor());
-		m_in_stream_ptr->push(*m_ifstream_ptr);
-		*/
 	}
 
 	void ASCIIGZFileReader::Close()
 	{
 		if (!m_opened) { return; }
-		m_in_stream_ptr->close();
+		bgzf_close(m_bgzf_ptr);
+		m_bgzf_ptr = nullptr;
 		m_opened = false;
 	}
 }
@@ -7,9 +7,16 @@
 #include <iostream>
 #include <fstream>
 
-#include <gzstream.h>
+#include "htslib/bgzf.h"
+#include "htslib/kstring.h"
+
 namespace graphite
 {
+	/*
+	 * Reads gzipped text through htslib's BGZF reader. bgzipped files are
+	 * inflated ahead on the shared BGZFThreadPool, plain gzip files are read
+	 * on the calling thread.
+	 */
 	class ASCIIGZFileReader : public IFile
 	{
 	public:
@@ -23,18 +30,16 @@ namespace graphite
 
 		inline bool getNextLine(std::string& line) override
 		{
-			if (!this->m_opened) { return false; }
-			auto value = (bool)std::getline(*this->m_in_stream_ptr, line);
-			return value;
+			if (!this->m_opened || bgzf_getline(this->m_bgzf_ptr, '\n', &this->m_line_buffer) < 0) { return false; }
+			line.assign(this->m_line_buffer.s, this->m_line_buffer.l);
+			return true;
 		}
 
 		void setFilePosition(uint64_t pos) override {};
 
 	private:
-		std::shared_ptr< std::iostream > m_iostream_ptr;
-		std::shared_ptr< std::ifstream > m_ifstream_ptr;
-		std::shared_ptr< igzstream > m_in_stream_ptr;
-		/* std::shared_ptr< boost::iostreams::filtering_istream > m_in_stream_ptr; */
+		BGZF* m_bgzf_ptr;
+		kstring_t m_line_buffer;
 	};
 }
 
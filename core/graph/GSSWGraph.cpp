@@ -13,7 +13,7 @@ namespace graphite
 
 	uint32_t GSSWGraph::s_next_id = 0;
 	std::mutex GSSWGraph::s_lock;
-	GSSWGraph::GSSWGraph(IReference::SharedPtr referencePtr, IVariantList::SharedPtr variantListPtr, Region::SharedPtr regionPtr, int matchValue, int misMatchValue, int gapOpenValue, int gapExtensionValue, uint32_t numGraphCopies) :
+	GSSWGraph::GSSWGraph(IReference::SharedPtr referencePtr, IVariantList::SharedPtr variantListPtr, Region::SharedPtr regionPtr, int matchValue, int misMatchValue, int gapOpenValue, int gapExtensionValue, uint32_t numGraphCopies, bool useSWKernels) :
 		IGraph(referencePtr, variantListPtr),
 		m_match(matchValue),
 		m_mismatch(misMatchValue),
@@ -23,7 +23,9 @@ namespace graphite
 		m_region_ptr(regionPtr),
 		m_total_graph_length(0),
 		m_skipped(false),
-		m_num_graph_copies(numGraphCopies)
+		m_num_graph_copies((numGraphCopies > 0) ? numGraphCopies : 1),
+		m_graph_container_count(0),
+		m_use_sw_kernels(useSWKernels && gapOpenValue > gapExtensionValue) // see GraphSmithWaterman
 	{
 		this->m_nt_table = gssw_create_nt_table();
 		this->m_mat = gssw_create_score_matrix(this->m_match, this->m_mismatch);
@@ -72,6 +74,7 @@ namespace graphite
 			auto referenceAllelePtr = std::make_shared< Allele >(referenceSequenceString);
 			addReferenceVertex(currentReferencePosition, referenceAllelePtr, altAndRefVertices);
 		}
+		this->m_kmer_index_ptr = std::make_shared< GraphKmerIndex >(this->m_graph_ptr, this->m_nt_table);
 		generateGraphCopies();
 	}
 
@@ -116,18 +119,19 @@ namespace graphite
 
 	GSSWGraph::GSSWGraphMappingPtr GSSWGraph::traceBackAlignment(IAlignment::SharedPtr alignmentPtr, std::shared_ptr< GSSWGraphContainer > graphContainer)
 	{
-		gssw_graph* g = graphContainer->graph_ptr;
-		int8_t* nt_table = graphContainer->nt_table;
-		int8_t* mat = graphContainer->mat;
-
-		gssw_graph_fill(g, alignmentPtr->getSequence(), alignmentPtr->getLength(), nt_table, mat, this->m_gap_open, this->m_gap_extension, 15, 2);
-		gssw_graph_mapping* graphMapping = gssw_graph_trace_back(g, alignmentPtr->getSequence(), alignmentPtr->getLength(),m_match,m_mismatch,m_gap_open,m_gap_extension);
-
+		gssw_graph_mapping* graphMapping;
+		void (*graphMappingDeletor)(gssw_graph_mapping*);
+		if (this->m_use_sw_kernels)
 		{
-			std::unique_lock< std::mutex > lock(m_traceback_lock);
-			m_graph_container_ptrs_queue.emplace(graphContainer);
+			graphMapping = getAligner(graphContainer)->align(alignmentPtr->getSequence(), alignmentPtr->getLength());
+			graphMappingDeletor = GraphSmithWaterman::DestroyMapping;
+		}
+		else
+		{
+			gssw_graph_fill(graphContainer->graph_ptr, alignmentPtr->getSequence(), alignmentPtr->getLength(), graphContainer->nt_table, graphContainer->mat, this->m_gap_open, this->m_gap_extension, 15, 2);
+			graphMapping = gssw_graph_trace_back(graphContainer->graph_ptr, alignmentPtr->getSequence(), alignmentPtr->getLength(), this->m_match, this->m_mismatch, this->m_gap_open, this->m_gap_extension);
+			graphMappingDeletor = gssw_graph_mapping_destroy;
 		}
-		this->m_condition.notify_one();
 
 		gssw_node_cigar* nc = graphMapping->cigar.elements;
 		for (int i = 0; i < graphMapping->cigar.length; ++i, ++nc)
@@ -135,13 +139,116 @@ namespace graphite
 			nc->node->cigar = nc->cigar;
 		}
 
-		auto graphMappingDeletor = [](gssw_graph_mapping* gm)
-		{
-			gssw_graph_mapping_destroy(gm);
-		};
 		return std::shared_ptr< gssw_graph_mapping >(graphMapping, graphMappingDeletor);
 	}
 
+	/*
+	 * Only the scores are computed so there are no cigars to hand to the nodes.
+	 * With --sw_kernels the reads of a batch are scored side by side in the
+	 * kernels' lanes. gssw has no batched fill so by default each read fills
+	 * the graph on its own, the batch only shares the graph container.
+	 */
+	void GSSWGraph::scoreAlignments(const std::vector< IAlignment::SharedPtr >& alignmentPtrs, std::shared_ptr< GSSWGraphContainer > graphContainer, std::vector< GraphSmithWaterman::ReadScore >& scores)
+	{
+		if (this->m_use_sw_kernels)
+		{
+			std::vector< std::pair< const char*, uint32_t > > reads;
+			reads.reserve(alignmentPtrs.size());
+			for (auto& alignmentPtr : alignmentPtrs)
+			{
+				reads.emplace_back(alignmentPtr->getSequence(), alignmentPtr->getLength());
+			}
+			getAligner(graphContainer)->scoreReads(reads, scores);
+			return;
+		}
+
+		gssw_graph* graphPtr = graphContainer->graph_ptr;
+		scores.resize(alignmentPtrs.size());
+		for (size_t i = 0; i < alignmentPtrs.size(); ++i)
+		{
+			gssw_graph_fill(graphPtr, alignmentPtrs[i]->getSequence(), alignmentPtrs[i]->getLength(), graphContainer->nt_table, graphContainer->mat, this->m_gap_open, this->m_gap_extension, 15, 2);
+			scores[i] = { 0, 0, 0 };
+			if (graphPtr->max_node != nullptr)
+			{
+				uint32_t maxNodeIndex = std::find(graphPtr->nodes, graphPtr->nodes + graphPtr->size, graphPtr->max_node) - graphPtr->nodes;
+				scores[i] = { graphPtr->max_node->alignment->score1, maxNodeIndex, (uint32_t)graphPtr->max_node->alignment->ref_end1 };
+			}
+		}
+	}
+
+	/*
+	 * An alignment spans at most readLength columns plus however many bases its
+	 * score leaves room to delete. If that many columns fit in the node the
+	 * alignment ends in, it starts in that node too, and a node that is not part
+	 * of a variant gives the adjudicator nothing to count.
+	 */
+	bool GSSWGraph::alignmentMayTouchVariants(const GraphSmithWaterman::ReadScore& readScore, uint32_t readLength)
+	{
+		if (readScore.score <= 0)
+		{
+			return false;
+		}
+		gssw_node* node = this->m_graph_ptr->nodes[readScore.endNode];
+		if (((IAllele*)node->data)->getVariantWPtr().lock() != nullptr)
+		{
+			return true;
+		}
+		int64_t scoreLeft = ((int64_t)readLength * this->m_match) - readScore.score;
+		int64_t maxDeletionLength = (scoreLeft >= this->m_gap_open) ? ((scoreLeft - this->m_gap_open) / this->m_gap_extension) + 1 : 0;
+		return (int64_t)readScore.endColumn + 1 < (int64_t)readLength + maxDeletionLength;
+	}
+
+	/*
+	 * The mapping points at the nodes of the original graph, they are only read
+	 * so it doesn't matter which container is aligning at the same time.
+	 */
+	GSSWGraph::GSSWGraphMappingPtr GSSWGraph::findExactMapping(IAlignment::SharedPtr alignmentPtr)
+	{
+		if (this->m_kmer_index_ptr == nullptr)
+		{
+			return nullptr;
+		}
+		gssw_graph_mapping* graphMapping = this->m_kmer_index_ptr->findExactMapping(alignmentPtr->getSequence(), alignmentPtr->getLength(), this->m_match);
+		if (graphMapping == nullptr)
+		{
+			return nullptr;
+		}
+		return std::shared_ptr< gssw_graph_mapping >(graphMapping, GraphSmithWaterman::DestroyMapping);
+	}
+
+	bool GSSWGraph::mappingTouchesVariants(GSSWGraphMappingPtr graphMappingPtr)
+	{
+		for (int i = 0; i < graphMappingPtr->cigar.length; ++i)
+		{
+			if (((IAllele*)graphMappingPtr->cigar.elements[i].node->data)->getVariantWPtr().lock() != nullptr)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool GSSWGraph::mappingTouchesAlternates(GSSWGraphMappingPtr graphMappingPtr)
+	{
+		for (int i = 0; i < graphMappingPtr->cigar.length; ++i)
+		{
+			if (graphMappingPtr->cigar.elements[i].node->id % 2 != 0) // alt node ids are odd
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	GraphSmithWaterman::SharedPtr GSSWGraph::getAligner(std::shared_ptr< GSSWGraphContainer > graphContainer)
+	{
+		if (graphContainer->aligner_ptr == nullptr)
+		{
+			graphContainer->aligner_ptr = std::make_shared< GraphSmithWaterman >(graphContainer->graph_ptr, graphContainer->nt_table, graphContainer->mat, this->m_gap_open, this->m_gap_extension);
+		}
+		return graphContainer->aligner_ptr;
+	}
+
 	void GSSWGraph::recordAlignmentVariants(std::shared_ptr< gssw_graph_mapping > graphMapping, IAlignment::SharedPtr alignmentPtr)
 	{
 		 // this->m_variant_list_ptr->rewind();
@@ -178,48 +285,75 @@ namespace graphite
 
 	std::shared_ptr< GSSWGraphContainer > GSSWGraph::getGraphContainer()
 	{
-		std::unique_lock< std::mutex > lock(m_traceback_lock);
-		this->m_condition.wait(lock, [this]{ return !this->m_graph_container_ptrs_queue.empty(); });
-		auto graphContainerPtr = this->m_graph_container_ptrs_queue.front();
-		this->m_graph_container_ptrs_queue.pop();
+		{
+			std::unique_lock< std::mutex > lock(m_traceback_lock);
+			if (this->m_graph_container_ptrs_queue.empty() && this->m_graph_container_count < this->m_num_graph_copies)
+			{
+				++this->m_graph_container_count; // reserve the slot now and build the copy outside of the lock
+			}
+			else
+			{
+				this->m_condition.wait(lock, [this]{ return !this->m_graph_container_ptrs_queue.empty(); });
+				auto graphContainerPtr = this->m_graph_container_ptrs_queue.front();
+				this->m_graph_container_ptrs_queue.pop_front();
+				return graphContainerPtr;
+			}
+		}
+		auto graphContainerPtr = copyGraphContainer();
+		{
+			std::unique_lock< std::mutex > lock(m_traceback_lock);
+			m_graph_container_ptrs.emplace_back(graphContainerPtr);
+		}
 		return graphContainerPtr;
 	}
 
-	void GSSWGraph::generateGraphCopies()
+	// the caller holds the container for as many alignments as it likes and hands it back once it is done with the nodes
+	void GSSWGraph::checkinGraphContainer(std::shared_ptr< GSSWGraphContainer > graphContainerPtr)
 	{
-		for (uint32_t tc = 0; tc < m_num_graph_copies; ++tc)
 		{
-			int8_t* nt_table = gssw_create_nt_table();
-			int8_t* mat = mat = gssw_create_score_matrix(this->m_match, this->m_mismatch);
-			gssw_graph* g = gssw_graph_create(100);
+			std::unique_lock< std::mutex > lock(m_traceback_lock);
+			m_graph_container_ptrs_queue.emplace_back(graphContainerPtr);
+		}
+		this->m_condition.notify_one();
+	}
 
-			std::unordered_map< int, gssw_node* > oldToNewNodeMap;
-			for (auto i = 0; i < m_graph_ptr->size; ++i)
-			{
-				auto node = gssw_node_copy(this->m_graph_ptr->nodes[i], nt_table);
-				gssw_graph_add_node(g, node);
+	/*
+	 * Copies are only made on demand when every existing container is checked out,
+	 * so a graph never has more copies than the number of threads aligning to it.
+	 * The node topology, sequences and numeric sequences are read only so only the
+	 * node structs (which hold the per alignment gssw matrices) are copied.
+	 */
+	std::shared_ptr< GSSWGraphContainer > GSSWGraph::copyGraphContainer()
+	{
+		gssw_graph* g = gssw_graph_create(100);
 
-				oldToNewNodeMap.emplace(this->m_graph_ptr->nodes[i]->id, node);
-			}
-			for (auto i = 0; i < m_graph_ptr->size; ++i)
+		std::unordered_map< uint32_t, gssw_node* > oldToNewNodeMap;
+		for (uint32_t i = 0; i < this->m_graph_ptr->size; ++i)
+		{
+			auto node = gssw_node_copy(this->m_graph_ptr->nodes[i]);
+			gssw_graph_add_node(g, node);
+			oldToNewNodeMap.emplace(this->m_graph_ptr->nodes[i]->id, node);
+		}
+		for (uint32_t i = 0; i < this->m_graph_ptr->size; ++i)
+		{
+			gssw_node* oldStartNode = this->m_graph_ptr->nodes[i];
+			for (auto nextIdx = 0; nextIdx < oldStartNode->count_next; ++nextIdx)
 			{
-				gssw_node* oldStartNode = this->m_graph_ptr->nodes[i];
-				for (auto nextIdx = 0; nextIdx < this->m_graph_ptr->nodes[i]->count_next; ++nextIdx)
-				{
-					gssw_node* oldEndNode = this->m_graph_ptr->nodes[i]->next[nextIdx];
-					if (oldToNewNodeMap.find(oldStartNode->id) == oldToNewNodeMap.end() || oldToNewNodeMap.find(oldEndNode->id) == oldToNewNodeMap.end()) { std::cout << "skipping!!!" << std::endl; }
-					gssw_node* newStartNode = oldToNewNodeMap[oldStartNode->id];
-					gssw_node* newEndNode = oldToNewNodeMap[oldEndNode->id];
-					gssw_nodes_add_edge(newStartNode, newEndNode);
-				}
+				gssw_node* oldEndNode = oldStartNode->next[nextIdx];
+				gssw_nodes_add_edge(oldToNewNodeMap[oldStartNode->id], oldToNewNodeMap[oldEndNode->id]);
 			}
-			auto graphContainerPtr = std::make_shared< GSSWGraphContainer >(nt_table, mat, g);
-			m_graph_container_ptrs.emplace_back(graphContainerPtr);
-			m_graph_container_ptrs_queue.emplace(graphContainerPtr);
 		}
+		return std::make_shared< GSSWGraphContainer >(this->m_nt_table, this->m_mat, g, false);
+	}
+
+	void GSSWGraph::generateGraphCopies()
+	{
+		// the original graph is the first container, further copies are made lazily by getGraphContainer
 		auto graphContainerPtr = std::make_shared< GSSWGraphContainer >(this->m_nt_table, this->m_mat, this->m_graph_ptr);
+		std::unique_lock< std::mutex > lock(m_traceback_lock);
 		m_graph_container_ptrs.emplace_back(graphContainerPtr);
-		m_graph_container_ptrs_queue.emplace(graphContainerPtr);
+		m_graph_container_ptrs_queue.emplace_back(graphContainerPtr);
+		++this->m_graph_container_count;
 	}
 
 	void getAllPaths(gssw_node* node, std::string currentPath, std::string nodeIDs, int numberOfSibs, std::vector< std::tuple< std::string, std::string > >& paths)
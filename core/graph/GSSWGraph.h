@@ -9,6 +9,8 @@
 #include "gssw.h"
 
 #include "core/graph/IGraph.h"
+#include "core/graph/GraphKmerIndex.h"
+#include "core/graph/GraphSmithWaterman.h"
 #include "core/reference/IReference.h"
 #include "core/variant/IVariantList.h"
 #include "core/allele/Allele.h"
@@ -16,25 +18,44 @@
 
 namespace graphite
 {
+	/*
+	 * A container holds one set of gssw nodes that a single thread can fill and trace back.
+	 * Only the original container owns the score tables and the numeric node sequences,
+	 * the copies borrow them since they are never written to during alignment.
+	 * The aligner is built the first time the container aligns a read with the
+	 * SIMD kernels and is reused for every read after that.
+	 */
 	class GSSWGraphContainer
 	{
 	public:
-	GSSWGraphContainer(int8_t* NTtable, int8_t* mat, gssw_graph* graphPtr) :
-		nt_table(NTtable), mat(mat), graph_ptr(graphPtr)
+	GSSWGraphContainer(int8_t* NTtable, int8_t* mat, gssw_graph* graphPtr, bool ownsSequences = true) :
+		nt_table(NTtable), mat(mat), graph_ptr(graphPtr), owns_sequences(ownsSequences)
 		{
 			lock.unlock();
 		}
 
 		~GSSWGraphContainer()
 		{
+			if (!this->owns_sequences)
+			{
+				for (uint32_t i = 0; i < this->graph_ptr->size; ++i)
+				{
+					this->graph_ptr->nodes[i]->num = NULL; // the num arrays belong to the original graph
+				}
+			}
 			gssw_graph_destroy(this->graph_ptr);
-			free(this->nt_table);
-			free(this->mat);
+			if (this->owns_sequences)
+			{
+				free(this->nt_table);
+				free(this->mat);
+			}
 		}
 
 		int8_t* nt_table;
 		int8_t* mat;
 		gssw_graph* graph_ptr;
+		bool owns_sequences;
+		GraphSmithWaterman::SharedPtr aligner_ptr;
 		std::mutex lock;
 	};
 
@@ -45,11 +66,16 @@ namespace graphite
 		typedef std::shared_ptr< gssw_graph > GSSWGraphPtr;
 		typedef std::shared_ptr< gssw_graph_mapping > GSSWGraphMappingPtr;
 
-		GSSWGraph(IReference::SharedPtr referencePtr, IVariantList::SharedPtr variantListPtr, Region::SharedPtr regionPtr, int matchValue, int misMatchValue, int gapOpenValue, int gapExtensionValue, uint32_t numGraphCopies);
+		GSSWGraph(IReference::SharedPtr referencePtr, IVariantList::SharedPtr variantListPtr, Region::SharedPtr regionPtr, int matchValue, int misMatchValue, int gapOpenValue, int gapExtensionValue, uint32_t numGraphCopies, bool useSWKernels = false);
 		virtual ~GSSWGraph();
 
 		virtual void constructGraph() override;
 		GSSWGraphMappingPtr traceBackAlignment(IAlignment::SharedPtr alignmentPtr, std::shared_ptr< GSSWGraphContainer > graphContainer);
+		void scoreAlignments(const std::vector< IAlignment::SharedPtr >& alignmentPtrs, std::shared_ptr< GSSWGraphContainer > graphContainer, std::vector< GraphSmithWaterman::ReadScore >& scores);
+		bool alignmentMayTouchVariants(const GraphSmithWaterman::ReadScore& readScore, uint32_t readLength);
+		GSSWGraphMappingPtr findExactMapping(IAlignment::SharedPtr alignmentPtr);
+		bool mappingTouchesVariants(GSSWGraphMappingPtr graphMappingPtr);
+		bool mappingTouchesAlternates(GSSWGraphMappingPtr graphMappingPtr);
 		/* GSSWGraphMappingPtr traceBackAlignment(IAlignment::SharedPtr alignmentPtr); */
 		IVariant::SharedPtr getVariantFromNodeID(const uint32_t nodeID);
 		void recordAlignmentVariants(std::shared_ptr< gssw_graph_mapping > graphMapping, IAlignment::SharedPtr alignmentPtr);
@@ -62,12 +88,15 @@ namespace graphite
 		position getStartPosition() override { this->m_region_ptr->getStartPosition(); }
 		position getEndPosition() override {  this->m_region_ptr->getEndPosition(); }
 		std::shared_ptr< GSSWGraphContainer > getGraphContainer();
+		void checkinGraphContainer(std::shared_ptr< GSSWGraphContainer > graphContainerPtr);
 
 		std::vector< std::tuple< std::string, std::string > > generateAllPaths();
 
 	protected:
 
 		void generateGraphCopies();
+		GraphSmithWaterman::SharedPtr getAligner(std::shared_ptr< GSSWGraphContainer > graphContainer);
+		std::shared_ptr< GSSWGraphContainer > copyGraphContainer();
 		std::vector< gssw_node* > addAlternateVertices(const std::vector< gssw_node* >& altAndRefVertices, IVariant::SharedPtr variantPtr);
 		gssw_node* addReferenceVertex(position position, IAllele::SharedPtr refAllelePtr, std::vector< gssw_node* > altAndRefVertices);
 
@@ -82,10 +111,13 @@ namespace graphite
 		Region::SharedPtr m_region_ptr;
 		static uint32_t s_next_id;
 		static std::mutex s_lock;
-		uint32_t m_num_graph_copies;
+		uint32_t m_num_graph_copies; // the max number of containers (including the original) handed out at once
+		uint32_t m_graph_container_count;
+		bool m_use_sw_kernels; // gssw aligns unless this is set, see GraphSmithWaterman
 		std::map< uint32_t, std::tuple< INode::SharedPtr, uint32_t, std::vector< IAlignment::SharedPtr > > > m_variant_counter;
 		std::map< uint32_t, IVariant::SharedPtr > m_variants_map;
 		std::vector< std::shared_ptr< GSSWGraphContainer > > m_graph_container_ptrs;
+		GraphKmerIndex::SharedPtr m_kmer_index_ptr; // only built for the variant graph
 
 		size_t m_total_graph_length;
 		bool m_skipped;
@@ -132,7 +164,7 @@ namespace graphite
 			return n;
 		}
 
-		gssw_node* gssw_node_copy(gssw_node* node, int8_t* nt_table)
+		gssw_node* gssw_node_copy(gssw_node* node)
 		{
 			gssw_node* n = (gssw_node*)calloc(1, sizeof(gssw_node));
 			n->ref_len = node->ref_len;
@@ -142,7 +174,7 @@ namespace graphite
 			n->len = node->len;
 			n->seq = node->seq;
 			n->data = node->data;
-			n->num = gssw_create_num(n->seq, n->len, nt_table);
+			n->num = node->num; // shared with the original, see GSSWGraphContainer
 			n->count_prev = 0;
 			n->count_next = 0;
 			n->alignment = NULL;
@@ -158,7 +190,7 @@ namespace graphite
 
 		std::mutex m_traceback_lock;
 		std::condition_variable m_condition;
-		std::queue< std::shared_ptr< GSSWGraphContainer > > m_graph_container_ptrs_queue;
+		std::deque< std::shared_ptr< GSSWGraphContainer > > m_graph_container_ptrs_queue;
 
 	};
 
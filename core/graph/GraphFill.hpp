@@ -0,0 +1,305 @@
+#ifndef GRAPHITE_GRAPHFILL_HPP
+#define GRAPHITE_GRAPHFILL_HPP
+
+#include "core/graph/GraphSmithWatermanKernel.h"
+
+namespace graphite
+{
+	/*
+	 * Carries F across the lane boundaries in log2(Lanes) steps. F entering a lane is
+	 * the max over the lanes below it of their outgoing F, less gapExtension for
+	 * every row in between, which is a max-plus prefix scan.
+	 */
+	template < typename V, uint32_t Shift, bool Done = (Shift >= V::Lanes) >
+	struct FScan
+	{
+		static inline typename V::Vector Apply(typename V::Vector vF, const typename V::Vector* vDecays)
+		{
+			vF = V::Max(vF, V::Subtract(V::template ShiftLanes< Shift >(vF), *vDecays));
+			return FScan< V, Shift * 2 >::Apply(vF, vDecays + 1);
+		}
+	};
+
+	template < typename V, uint32_t Shift >
+	struct FScan< V, Shift, true >
+	{
+		static inline typename V::Vector Apply(typename V::Vector vF, const typename V::Vector* vDecays) { return vF; }
+	};
+
+	/*
+	 * Farrar's striped Smith-Waterman run over the nodes of a graph in topological order.
+	 * The first column of a node is seeded with the element-wise max of H and E
+	 * of the last columns of its predecessors. Gaps cost gapOpen for the first
+	 * base and gapExtension for every base after that.
+	 *
+	 * The scores match gssw's. gssw's F starts over at the first read position of
+	 * each of its lanes and the F carried across the lanes afterwards raises H
+	 * but never E, so a deletion can't follow an insertion that crosses one of
+	 * gssw's lanes. H'' is H without that carried F. E and both F's are taken
+	 * from H'' and H is the max of H'' and the F that runs down the whole column.
+	 * Without laneStartMasks the lanes are gssw's, otherwise V must have a
+	 * single lane and the masks clear F at the start of each of gssw's lanes.
+	 *
+	 * V provides the vector type and the operations for one instruction set and
+	 * lane width. Every instruction set is compiled in its own translation unit
+	 * with its own target flags so V must have internal linkage there.
+	 */
+	template < typename V >
+	bool GraphFill(GraphFillArgs& args)
+	{
+		typedef typename V::Vector Vector;
+
+		const uint32_t segmentLength = args.segmentLength;
+		const Vector* profile = static_cast< const Vector* >(args.profile);
+		const Vector* laneStartMasks = static_cast< const Vector* >(args.laneStartMasks);
+		Vector* scores = static_cast< Vector* >(args.scores);
+		Vector* lastH = static_cast< Vector* >(args.lastH);
+		Vector* lastE = static_cast< Vector* >(args.lastE);
+		Vector* seedH = static_cast< Vector* >(args.seedH);
+		Vector* columnE = static_cast< Vector* >(args.columnE);
+
+		const Vector vZero = V::Zero();
+		const Vector vGapOpen = V::Set(args.gapOpen);
+		const Vector vGapExtension = V::Set(args.gapExtension);
+		const Vector vBias = V::Set(args.bias);
+
+		int32_t maxScore = 0;
+		uint32_t maxNode = 0;
+		uint32_t maxColumn = 0;
+		Vector vMaxScore = vZero;
+
+		Vector vDecays[8];
+		int64_t decay = (int64_t)segmentLength * args.gapExtension;
+		for (uint32_t d = 0; d < 8; ++d, decay *= 2)
+		{
+			vDecays[d] = V::Set((int32_t)((decay < V::MaxScore) ? decay : V::MaxScore));
+		}
+
+		for (uint32_t n = 0; n < args.nodeCount; ++n)
+		{
+			uint32_t predecessorStart = args.predecessorOffsets[n];
+			uint32_t predecessorEnd = args.predecessorOffsets[n + 1];
+			for (uint32_t s = 0; s < segmentLength; ++s)
+			{
+				Vector vH = vZero;
+				Vector vE = vZero;
+				for (uint32_t p = predecessorStart; p < predecessorEnd; ++p)
+				{
+					size_t predecessorOffset = (size_t)args.predecessorIndices[p] * segmentLength;
+					vH = V::Max(vH, lastH[predecessorOffset + s]);
+					vE = V::Max(vE, lastE[predecessorOffset + s]);
+				}
+				seedH[s] = vH;
+				columnE[s] = vE;
+			}
+
+			const int8_t* sequence = args.nodeSequences[n];
+			const Vector* vHLoad = seedH;
+			Vector* vHStore = scores + (size_t)args.nodeColumnOffsets[n] * segmentLength;
+			for (uint32_t i = 0; i < args.nodeLengths[n]; ++i, vHStore += segmentLength)
+			{
+				const Vector* vProfile = profile + sequence[i] * segmentLength;
+				Vector vH = V::template ShiftLanes< 1 >(vHLoad[segmentLength - 1]);
+				Vector vF = vZero;
+				Vector vMaxColumn = vZero;
+				if (laneStartMasks == nullptr)
+				{
+					for (uint32_t s = 0; s < segmentLength; ++s)
+					{
+						Vector vE = columnE[s];
+						vH = V::AddProfile(vH, vProfile[s], vBias);
+						vH = V::Max(vH, vE);
+						vH = V::Max(vH, vF);
+						vH = V::Max(vH, vZero);
+						vMaxColumn = V::Max(vMaxColumn, vH);
+						vHStore[s] = vH;
+
+						vH = V::Subtract(vH, vGapOpen);
+						vE = V::Subtract(vE, vGapExtension);
+						columnE[s] = V::Max(vE, vH);
+						vF = V::Subtract(vF, vGapExtension);
+						vF = V::Max(vF, vH);
+
+						vH = vHLoad[s];
+					}
+				}
+				else
+				{
+					Vector vFLane = vZero;
+					for (uint32_t s = 0; s < segmentLength; ++s)
+					{
+						Vector vE = columnE[s];
+						vFLane = V::And(vFLane, laneStartMasks[s]);
+						vH = V::AddProfile(vH, vProfile[s], vBias);
+						vH = V::Max(vH, vE);
+						vH = V::Max(vH, vFLane);
+						vH = V::Max(vH, vZero);
+						Vector vHMax = V::Max(vH, vF);
+						vMaxColumn = V::Max(vMaxColumn, vHMax);
+						vHStore[s] = vHMax;
+
+						vH = V::Subtract(vH, vGapOpen);
+						vE = V::Subtract(vE, vGapExtension);
+						columnE[s] = V::Max(vE, vH);
+						vFLane = V::Subtract(vFLane, vGapExtension);
+						vFLane = V::Max(vFLane, vH);
+						vF = V::Subtract(vF, vGapExtension);
+						vF = V::Max(vF, vH);
+
+						vH = vHLoad[s];
+					}
+				}
+
+				// carry F across the lane boundaries, it raises H but leaves E alone the same as gssw's lazy F loop.
+				// The carried F only decays so the prefix scan settles it in one pass, and once it is no more
+				// than the F a segment got from within its own lane it stays that way for the rest of the lane.
+				vF = FScan< V, 1 >::Apply(V::template ShiftLanes< 1 >(vF), vDecays);
+				for (uint32_t s = 0; s < segmentLength; ++s)
+				{
+					Vector vHOld = vHStore[s];
+					vH = V::Max(vHOld, vF);
+					vHStore[s] = vH;
+					vMaxColumn = V::Max(vMaxColumn, vH);
+
+					vF = V::Subtract(vF, vGapExtension);
+					if (!V::AnyGreater(vF, V::Subtract(vHOld, vGapOpen)))
+					{
+						break;
+					}
+				}
+
+				// ties keep the first node and column that reached the score
+				if (V::AnyGreater(vMaxColumn, vMaxScore))
+				{
+					maxScore = V::HorizontalMax(vMaxColumn);
+					maxNode = n;
+					maxColumn = i;
+					if (maxScore >= args.saturationScore)
+					{
+						return false;
+					}
+					vMaxScore = V::Set(maxScore);
+				}
+				vHLoad = vHStore;
+			}
+
+			// vHLoad is still the seed for a node without sequence so it passes straight through
+			Vector* vLastH = lastH + (size_t)n * segmentLength;
+			Vector* vLastE = lastE + (size_t)n * segmentLength;
+			for (uint32_t s = 0; s < segmentLength; ++s)
+			{
+				vLastH[s] = vHLoad[s];
+				vLastE[s] = columnE[s];
+			}
+		}
+
+		args.maxScore = maxScore;
+		args.maxNode = maxNode;
+		args.maxColumn = maxColumn;
+		return true;
+	}
+
+	/*
+	 * The inter-read fill, every lane aligns a different read to the same graph
+	 * column. H and E of a node are updated in place in the node's lastH and
+	 * lastE rows, starting from the element-wise max of its predecessors'.
+	 * F runs down the rows of a column so it needs no correction pass, the
+	 * masks clear the F that feeds H'' and E at the start of each of gssw's
+	 * lanes for the read in that lane, see GraphFill.
+	 */
+	template < typename V >
+	void GraphScore(GraphScoreArgs& args)
+	{
+		typedef typename V::Vector Vector;
+		typedef typename V::Element Element;
+
+		const uint32_t rowCount = args.rowCount;
+		const Vector* profile = static_cast< const Vector* >(args.profile);
+		const Vector* laneStartMasks = static_cast< const Vector* >(args.laneStartMasks);
+		Vector* lastH = static_cast< Vector* >(args.lastH);
+		Vector* lastE = static_cast< Vector* >(args.lastE);
+		Vector* vMaxScores = static_cast< Vector* >(args.maxScores);
+
+		const Vector vZero = V::Zero();
+		const Vector vGapOpen = V::Set(args.gapOpen);
+		const Vector vGapExtension = V::Set(args.gapExtension);
+		const Vector vBias = V::Set(args.bias);
+		*vMaxScores = vZero;
+		for (uint32_t lane = 0; lane < V::Lanes; ++lane)
+		{
+			args.maxNodes[lane] = 0;
+			args.maxColumns[lane] = 0;
+		}
+
+		for (uint32_t n = 0; n < args.nodeCount; ++n)
+		{
+			uint32_t predecessorStart = args.predecessorOffsets[n];
+			uint32_t predecessorEnd = args.predecessorOffsets[n + 1];
+			Vector* columnH = lastH + (size_t)n * rowCount;
+			Vector* columnE = lastE + (size_t)n * rowCount;
+			for (uint32_t j = 0; j < rowCount; ++j)
+			{
+				Vector vH = vZero;
+				Vector vE = vZero;
+				for (uint32_t p = predecessorStart; p < predecessorEnd; ++p)
+				{
+					size_t predecessorOffset = (size_t)args.predecessorIndices[p] * rowCount;
+					vH = V::Max(vH, lastH[predecessorOffset + j]);
+					vE = V::Max(vE, lastE[predecessorOffset + j]);
+				}
+				columnH[j] = vH;
+				columnE[j] = vE;
+			}
+
+			const int8_t* sequence = args.nodeSequences[n];
+			for (uint32_t i = 0; i < args.nodeLengths[n]; ++i)
+			{
+				const Vector* vProfile = profile + sequence[i] * rowCount;
+				Vector vHDiagonal = vZero;
+				Vector vF = vZero;
+				Vector vFLane = vZero;
+				Vector vMaxColumn = vZero;
+				for (uint32_t j = 0; j < rowCount; ++j)
+				{
+					Vector vHLeft = columnH[j];
+					Vector vE = columnE[j];
+					vFLane = V::And(vFLane, laneStartMasks[j]);
+					Vector vH = V::AddProfile(vHDiagonal, vProfile[j], vBias);
+					vH = V::Max(vH, vE);
+					vH = V::Max(vH, vFLane);
+					vH = V::Max(vH, vZero);
+					Vector vHMax = V::Max(vH, vF);
+					vMaxColumn = V::Max(vMaxColumn, vHMax);
+					columnH[j] = vHMax;
+					vHDiagonal = vHLeft;
+
+					vH = V::Subtract(vH, vGapOpen);
+					vE = V::Subtract(vE, vGapExtension);
+					columnE[j] = V::Max(vE, vH);
+					vFLane = V::Subtract(vFLane, vGapExtension);
+					vFLane = V::Max(vFLane, vH);
+					vF = V::Subtract(vF, vGapExtension);
+					vF = V::Max(vF, vH);
+				}
+
+				// ties keep the first node and column that reached the score, the same as the striped fill
+				if (V::AnyGreater(vMaxColumn, *vMaxScores))
+				{
+					const Element* columnMaxes = reinterpret_cast< const Element* >(&vMaxColumn);
+					const Element* maxScores = reinterpret_cast< const Element* >(vMaxScores);
+					for (uint32_t lane = 0; lane < V::Lanes; ++lane)
+					{
+						if (columnMaxes[lane] > maxScores[lane])
+						{
+							args.maxNodes[lane] = n;
+							args.maxColumns[lane] = i;
+						}
+					}
+					*vMaxScores = V::Max(*vMaxScores, vMaxColumn);
+				}
+			}
+		}
+	}
+}
+
+#endif //GRAPHITE_GRAPHFILL_HPP
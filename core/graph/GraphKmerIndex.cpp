@@ -0,0 +1,199 @@
+#include "GraphKmerIndex.h"
+#include "GraphSmithWaterman.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <stdlib.h>
+
+namespace graphite
+{
+	namespace
+	{
+		const uint32_t s_max_entries_per_base = 16;
+		const uint32_t s_min_max_entries = 4096;
+	}
+
+	GraphKmerIndex::GraphKmerIndex(gssw_graph* graphPtr, const int8_t* ntTable) :
+		m_graph_ptr(graphPtr),
+		m_nt_table(ntTable),
+		m_entries(0),
+		m_indexed(true)
+	{
+		std::unordered_map< gssw_node*, uint32_t > nodeIndices;
+		size_t columnCount = 0;
+		for (uint32_t i = 0; i < graphPtr->size; ++i)
+		{
+			nodeIndices[graphPtr->nodes[i]] = i;
+			this->m_node_sequences.push_back(graphPtr->nodes[i]->num);
+			this->m_node_lengths.push_back(graphPtr->nodes[i]->len);
+			columnCount += graphPtr->nodes[i]->len;
+		}
+		this->m_successor_offsets.push_back(0);
+		for (uint32_t i = 0; i < graphPtr->size; ++i)
+		{
+			gssw_node* node = graphPtr->nodes[i];
+			for (int32_t j = 0; j < node->count_next; ++j)
+			{
+				this->m_successor_indices.push_back(nodeIndices[node->next[j]]);
+			}
+			this->m_successor_offsets.push_back(this->m_successor_indices.size());
+		}
+
+		// every step of the path enumeration counts against the budget so dense bubbles can't blow it up
+		this->m_max_entries = std::max< size_t >(columnCount * s_max_entries_per_base, s_min_max_entries);
+		for (uint32_t node = 0; node < graphPtr->size && this->m_indexed; ++node)
+		{
+			for (uint32_t offset = 0; offset < this->m_node_lengths[node] && this->m_indexed; ++offset)
+			{
+				addKmers(node, offset, node, offset, 0, 0);
+			}
+		}
+		if (!this->m_indexed)
+		{
+			this->m_kmer_starts.clear();
+		}
+	}
+
+	GraphKmerIndex::~GraphKmerIndex()
+	{
+	}
+
+	void GraphKmerIndex::addKmers(uint32_t startNode, uint32_t startOffset, uint32_t node, uint32_t offset, uint64_t kmer, uint32_t kmerLength)
+	{
+		if (++this->m_entries > this->m_max_entries)
+		{
+			this->m_indexed = false;
+			return;
+		}
+		const int8_t* sequence = this->m_node_sequences[node];
+		for (; offset < this->m_node_lengths[node] && kmerLength < KMER_SIZE; ++offset, ++kmerLength)
+		{
+			if (sequence[offset] > 3) // N and other ambiguity codes never match exactly
+			{
+				return;
+			}
+			kmer = (kmer << 2) | (uint64_t)sequence[offset];
+		}
+		if (kmerLength == KMER_SIZE)
+		{
+			auto& starts = this->m_kmer_starts[kmer];
+			auto start = std::make_pair(startNode, startOffset);
+			if (std::find(starts.begin(), starts.end(), start) == starts.end())
+			{
+				starts.emplace_back(start);
+			}
+			return;
+		}
+		for (uint32_t i = this->m_successor_offsets[node]; i < this->m_successor_offsets[node + 1] && this->m_indexed; ++i)
+		{
+			addKmers(startNode, startOffset, this->m_successor_indices[i], 0, kmer, kmerLength);
+		}
+	}
+
+	gssw_graph_mapping* GraphKmerIndex::findExactMapping(const char* read, uint32_t readLength, int32_t matchValue)
+	{
+		if (!this->m_indexed || readLength < KMER_SIZE)
+		{
+			return nullptr;
+		}
+		std::vector< int8_t > codes(readLength);
+		uint64_t kmer = 0;
+		for (uint32_t i = 0; i < readLength; ++i)
+		{
+			codes[i] = GraphSmithWaterman::GetNucleotideCode(this->m_nt_table, read[i]);
+			if (codes[i] > 3)
+			{
+				return nullptr;
+			}
+			if (i < KMER_SIZE)
+			{
+				kmer = (kmer << 2) | (uint64_t)codes[i];
+			}
+		}
+		auto iter = this->m_kmer_starts.find(kmer);
+		if (iter == this->m_kmer_starts.end())
+		{
+			return nullptr;
+		}
+
+		std::vector< uint32_t > path;
+		std::vector< uint32_t > matchedPath;
+		uint32_t matchCount = 0;
+		uint32_t startOffset = 0;
+		for (auto& start : iter->second)
+		{
+			uint32_t previousMatchCount = matchCount;
+			matchPath(start.first, start.second, codes.data(), readLength, path, matchedPath, matchCount);
+			if (matchCount > 1)
+			{
+				return nullptr; // the read fits more than one path so the aligner has to pick
+			}
+			if (matchCount > previousMatchCount)
+			{
+				startOffset = start.second;
+			}
+		}
+		if (matchCount == 0)
+		{
+			return nullptr;
+		}
+
+		// nodes without sequence are left out, the same as a traceback leaves them out
+		std::vector< std::pair< uint32_t, uint32_t > > nodeBases;
+		uint32_t offset = startOffset;
+		uint32_t remaining = readLength;
+		for (auto node : matchedPath)
+		{
+			uint32_t bases = std::min(remaining, this->m_node_lengths[node] - offset);
+			if (bases > 0)
+			{
+				nodeBases.emplace_back(node, bases);
+			}
+			remaining -= bases;
+			offset = 0;
+		}
+
+		gssw_graph_mapping* mappingPtr = (gssw_graph_mapping*)calloc(1, sizeof(gssw_graph_mapping));
+		mappingPtr->position = startOffset;
+		mappingPtr->score = (int32_t)readLength * matchValue;
+		mappingPtr->cigar.length = nodeBases.size();
+		mappingPtr->cigar.elements = (gssw_node_cigar*)calloc(nodeBases.size(), sizeof(gssw_node_cigar));
+		for (size_t i = 0; i < nodeBases.size(); ++i)
+		{
+			gssw_node_cigar* nodeCigar = mappingPtr->cigar.elements + i;
+			nodeCigar->node = this->m_graph_ptr->nodes[nodeBases[i].first];
+			nodeCigar->cigar = (gssw_cigar*)calloc(1, sizeof(gssw_cigar));
+			nodeCigar->cigar->length = 1;
+			nodeCigar->cigar->elements = (gssw_cigar_element*)malloc(sizeof(gssw_cigar_element));
+			nodeCigar->cigar->elements[0].type = 'M';
+			nodeCigar->cigar->elements[0].length = nodeBases[i].second;
+		}
+		return mappingPtr;
+	}
+
+	void GraphKmerIndex::matchPath(uint32_t node, uint32_t offset, const int8_t* read, uint32_t readLength, std::vector< uint32_t >& path, std::vector< uint32_t >& matchedPath, uint32_t& matchCount)
+	{
+		uint32_t length = std::min(readLength, this->m_node_lengths[node] - offset);
+		if (memcmp(this->m_node_sequences[node] + offset, read, length) != 0)
+		{
+			return;
+		}
+		path.push_back(node);
+		if (length == readLength)
+		{
+			if (++matchCount == 1)
+			{
+				matchedPath = path;
+			}
+		}
+		else
+		{
+			for (uint32_t i = this->m_successor_offsets[node]; i < this->m_successor_offsets[node + 1] && matchCount < 2; ++i)
+			{
+				matchPath(this->m_successor_indices[i], 0, read + length, readLength - length, path, matchedPath, matchCount);
+			}
+		}
+		path.pop_back();
+	}
+}
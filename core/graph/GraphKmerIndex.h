@@ -0,0 +1,59 @@
+#ifndef GRAPHITE_GRAPHKMERINDEX_H
+#define GRAPHITE_GRAPHKMERINDEX_H
+
+#include "gssw.h"
+
+#include "core/util/Noncopyable.hpp"
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graphite
+{
+	/*
+	 * Indexes every k-mer spelled by a path through a gssw_graph by the node and
+	 * offset it starts at. A read whose first k-mer is in the index is extended
+	 * base for base along the graph, and if exactly one path matches the whole
+	 * read the mapping is built directly without a Smith-Waterman fill. Graphs
+	 * with so many paths that the index would grow past a few k-mers per base
+	 * aren't indexed and every read goes through the aligner.
+	 */
+	class GraphKmerIndex : private Noncopyable
+	{
+	public:
+		typedef std::shared_ptr< GraphKmerIndex > SharedPtr;
+
+		GraphKmerIndex(gssw_graph* graphPtr, const int8_t* ntTable);
+		~GraphKmerIndex();
+
+		/*
+		 * The mapping is laid out the same way as GraphSmithWaterman's and has
+		 * to be released with GraphSmithWaterman::DestroyMapping. Returns nullptr
+		 * if the read doesn't match exactly one path or contains anything but A,
+		 * C, G and T.
+		 */
+		gssw_graph_mapping* findExactMapping(const char* read, uint32_t readLength, int32_t matchValue);
+		bool isIndexed() { return m_indexed; }
+
+		static const uint32_t KMER_SIZE = 32;
+
+	private:
+		void addKmers(uint32_t startNode, uint32_t startOffset, uint32_t node, uint32_t offset, uint64_t kmer, uint32_t kmerLength);
+		void matchPath(uint32_t node, uint32_t offset, const int8_t* read, uint32_t readLength, std::vector< uint32_t >& path, std::vector< uint32_t >& matchedPath, uint32_t& matchCount);
+
+		gssw_graph* m_graph_ptr;
+		const int8_t* m_nt_table;
+		std::vector< const int8_t* > m_node_sequences;
+		std::vector< uint32_t > m_node_lengths;
+		std::vector< uint32_t > m_successor_offsets;
+		std::vector< uint32_t > m_successor_indices;
+		std::unordered_map< uint64_t, std::vector< std::pair< uint32_t, uint32_t > > > m_kmer_starts;
+		size_t m_max_entries;
+		size_t m_entries;
+		bool m_indexed;
+	};
+}
+
+#endif //GRAPHITE_GRAPHKMERINDEX_H
@@ -3,7 +3,6 @@
 #include "core/alignment/AlignmentReporter.h"
 #include "core/util/ThreadPool.hpp"
 #include "core/variant/VariantList.h"
-#include "core/mapping/MappingManager.h"
 #include "core/mapping/GSSWMapping.h"
 
 #include "core/alignment/BamAlignmentManager.h"
@@ -15,14 +14,69 @@
 namespace graphite
 {
 
-	GraphManager::GraphManager(IReference::SharedPtr referencePtr, IVariantManager::SharedPtr variantManagerPtr, IAlignmentManager::SharedPtr alignmentManagerPtr, IAdjudicator::SharedPtr adjudicatorPtr) :
+	GraphManager::GraphManager(IReference::SharedPtr referencePtr, IVariantManager::SharedPtr variantManagerPtr, IAlignmentManager::SharedPtr alignmentManagerPtr, IAdjudicator::SharedPtr adjudicatorPtr, uint32_t readBatchSize, uint32_t maxClusterSpan, MemoryBudget::SharedPtr graphMemoryBudgetPtr, bool useSWKernels) :
 		m_reference_ptr(referencePtr),
 		m_variant_manager_ptr(variantManagerPtr),
 		m_alignment_manager_ptr(alignmentManagerPtr),
-		m_adjudicator_ptr(adjudicatorPtr)
+		m_adjudicator_ptr(adjudicatorPtr),
+		m_task_budget(ThreadPool::Instance()->getThreadCount() * 4),
+		m_read_batch_size((readBatchSize > 0) ? readBatchSize : 1),
+		m_max_cluster_span(maxClusterSpan),
+		m_graph_memory_budget_ptr(graphMemoryBudgetPtr),
+		m_use_sw_kernels(useSWKernels)
 	{
 	}
 
+	uint32_t GraphManager::getGraphCopyCount(size_t alignmentCount)
+	{
+		uint32_t numBatches = (alignmentCount + this->m_read_batch_size - 1) / this->m_read_batch_size;
+		return (numBatches < ThreadPool::Instance()->getThreadCount()) ? numBatches : ThreadPool::Instance()->getThreadCount();  // get the min of threadcount and batch count, this is the num of simultanious threads processing this graph
+	}
+
+	uint64_t GraphManager::EstimateGraphMemory(position graphLength, uint32_t readLength, uint32_t numGraphCopies)
+	{
+		// every copy of the variant graph keeps a column of scores per graph base for the traceback, up to two bytes
+		// per read base for H, E and F, the reference graph copies only score so they are left to the overhead
+		static const uint64_t s_bytes_per_cell = 6;
+		static const uint64_t s_graph_overhead_per_base = 512; // nodes, the k-mer index and the reference graph
+		return ((uint64_t)graphLength * readLength * s_bytes_per_cell * numGraphCopies) + ((uint64_t)graphLength * s_graph_overhead_per_base);
+	}
+
+	bool GraphManager::GetNextCluster(IVariantList::SharedPtr variantsListPtr, uint32_t maxClusterSpan, std::vector< IVariant::SharedPtr >& variantPtrs, std::vector< Region::SharedPtr >& clusterRegionPtrs, position& startPosition, position& endPosition)
+	{
+		variantPtrs.clear();
+		clusterRegionPtrs.clear();
+		IVariant::SharedPtr variantPtr = nullptr;
+		do
+		{
+			if (!variantsListPtr->getNextVariant(variantPtr)) { return false; }
+		} while (variantPtr->shouldSkip());
+
+		// one sweep over the sorted variants, a cluster grows while the next variant's region starts inside the cluster's span
+		startPosition = 0;
+		endPosition = 0;
+		clusterRegionPtrs = variantPtr->getRegions();
+		variantPtrs.emplace_back(variantPtr);
+		if (clusterRegionPtrs.size() > 0)
+		{
+			startPosition = clusterRegionPtrs[0]->getStartPosition();
+			endPosition = clusterRegionPtrs[clusterRegionPtrs.size() - 1]->getEndPosition();
+		}
+		IVariant::SharedPtr nextVariantPtr = nullptr;
+		while (clusterRegionPtrs.size() > 0 && !variantPtr->isStructuralVariant() && variantsListPtr->peekNextVariant(nextVariantPtr) && !nextVariantPtr->isStructuralVariant())
+		{
+			auto nextRegionPtrs = nextVariantPtr->getRegions();
+			if (nextRegionPtrs.empty() || nextRegionPtrs[0]->getStartPosition() > endPosition) { break; }
+			position nextEndPosition = std::max(endPosition, nextRegionPtrs[nextRegionPtrs.size() - 1]->getEndPosition());
+			if (maxClusterSpan > 0 && nextEndPosition - startPosition > maxClusterSpan) { break; } // the next variant starts its own graph
+			variantsListPtr->getNextVariant(nextVariantPtr);
+			variantPtrs.emplace_back(nextVariantPtr);
+			clusterRegionPtrs.insert(clusterRegionPtrs.end(), nextRegionPtrs.begin(), nextRegionPtrs.end());
+			endPosition = nextEndPosition;
+		}
+		return true;
+	}
+
 	void GraphManager::buildGraphs(Region::SharedPtr regionPtr, uint32_t readLength)
 	{
 		auto variantsListPtr = this->m_variant_manager_ptr->getVariantsInRegion(regionPtr);
@@ -31,102 +85,48 @@ namespace graphite
 			return;
 		}
 
-		std::deque< std::shared_ptr< std::future< void > > > futureFunctions;
-
-		// loop through variants and build and adjudicate graphs
-		IVariant::SharedPtr variantPtr = nullptr;
-		while (variantsListPtr->getNextVariant(variantPtr))
+		std::vector< IVariant::SharedPtr > variantPtrs;
+		std::vector< Region::SharedPtr > clusterRegionPtrs;
+		position startPosition = 0;
+		position endPosition = 0;
+		while (GetNextCluster(variantsListPtr, this->m_max_cluster_span, variantPtrs, clusterRegionPtrs, startPosition, endPosition))
 		{
-			if (variantPtr->shouldSkip()) { continue; }
-			position startPosition = 0;
-			position endPosition = 0;
-			auto variantRegionPtrs = variantPtr->getRegions();
-			if (variantRegionPtrs.size() > 0)
+			// getting all the alignments in the cluster's regions
+			auto alignmentPtrs = this->m_alignment_manager_ptr->getAlignmentsInRegions(clusterRegionPtrs)->getAlignmentPtrs();
+			for (auto& alignmentPtr : alignmentPtrs)
 			{
-				startPosition = variantPtr->getRegions()[0]->getStartPosition();
-				endPosition = variantPtr->getRegions()[variantPtr->getRegions().size() - 1]->getEndPosition();
+				if (alignmentPtr->getPosition() < startPosition) { startPosition = alignmentPtr->getPosition(); }
+				if ((alignmentPtr->getPosition() + alignmentPtr->getLength()) > endPosition) { endPosition = alignmentPtr->getPosition() + alignmentPtr->getLength(); }
 			}
-			std::vector< IVariant::SharedPtr > variantPtrs;
-			IVariant::SharedPtr nextVariantPtr = nullptr;
-			variantPtrs.emplace_back(variantPtr);
-			while (variantsListPtr->peekNextVariant(nextVariantPtr) && variantPtr->doesOverlap(nextVariantPtr) && (!variantPtr->isStructuralVariant() && !nextVariantPtr->isStructuralVariant()))
-			{
-				variantsListPtr->getNextVariant(nextVariantPtr);
-				variantPtrs.emplace_back(nextVariantPtr);
-
-				for (auto regionPtr : nextVariantPtr->getRegions())
-				{
-					auto tmpStartPosition = regionPtr->getStartPosition();
-					auto tmpEndPosition = regionPtr->getEndPosition();
-					startPosition = (tmpStartPosition < startPosition) ? tmpStartPosition : startPosition;
-					endPosition = (tmpEndPosition > endPosition) ? tmpEndPosition : endPosition;
-				}
-			}
-			// getting all the alignments in the variant's region
-			std::vector< IAlignment::SharedPtr > alignmentPtrs;
-			std::unordered_set< IAlignment* > alignmentPtrSet;
-			for (auto regionVariantPtr : variantPtrs)
-			{
-				auto regionPtrs = regionVariantPtr->getRegions();
-				for (auto regionPtr : regionPtrs)
-				{
-					auto regionAlignmentListPtr = this->m_alignment_manager_ptr->getAlignmentsInRegion(regionPtr);
-					auto regionAlignmentPtrsCount = regionAlignmentListPtr->getCount();
-					if (regionAlignmentPtrsCount > 0)
-					{
-						auto regionAlignmentPtrs = regionAlignmentListPtr->getAlignmentPtrs();
-						// alignmentPtrs.insert(alignmentPtrs.end(), regionAlignmentPtrs.begin(), regionAlignmentPtrs.end()); // combine lists of alignments
-						for (auto alignmentPtr : regionAlignmentPtrs)
-						{
-							if (alignmentPtrSet.find(alignmentPtr.get()) == alignmentPtrSet.end())
-							{
-								alignmentPtrSet.emplace(alignmentPtr.get());
-								alignmentPtrs.emplace_back(alignmentPtr);
-								if (alignmentPtr->getPosition() < startPosition) { startPosition = alignmentPtr->getPosition(); }
-								if ((alignmentPtr->getPosition() + alignmentPtr->getLength()) > endPosition) { endPosition = alignmentPtr->getPosition() + alignmentPtr->getLength(); }
-							}
-						}
-					}
-				}
-			}
-			alignmentPtrSet.clear();
 			// std::cout << regionPtr->getRegionString() << " " << alignmentPtrs.size() << std::endl;
 			if (alignmentPtrs.size() > 0)
 			{
 				// find the start and end position for the graph
 				auto graphAlignmentRegion = std::make_shared< Region >(regionPtr->getReferenceID(), startPosition, endPosition, Region::BASED::ONE);
-				for (auto i = 1; i < alignmentPtrs.size(); ++i)
-				{
-					if (alignmentPtrs[i]->getPosition() < startPosition) { startPosition = alignmentPtrs[i]->getPosition(); }
-					if (alignmentPtrs[i]->getPosition() + alignmentPtrs[0]->getLength() > endPosition) { endPosition = alignmentPtrs[i]->getPosition() + alignmentPtrs[0]->getLength(); }
-				}
 				auto variantListPtr = std::make_shared< VariantList >(variantPtrs, this->m_reference_ptr);
 				auto alignmentListPtr = std::make_shared< AlignmentList >(alignmentPtrs);
-				constructAndAdjudicateGraph(variantListPtr, alignmentListPtr, graphAlignmentRegion, readLength);
-			}
-		}
-
-		while (!futureFunctions.empty())
-		{
-			auto futureFunct = futureFunctions.front();
-			futureFunctions.pop_front();
-			if (futureFunct->wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
-			{
-				futureFunctions.emplace_back(futureFunct);
+				this->m_task_group.waitForCapacity(this->m_task_budget);
+				MemoryBudget::Reservation::SharedPtr graphReservationPtr = nullptr;
+				if (this->m_graph_memory_budget_ptr != nullptr)
+				{
+					// released once the graph's last read batch finishes
+					graphReservationPtr = this->m_graph_memory_budget_ptr->reserve(EstimateGraphMemory(endPosition - startPosition, readLength, getGraphCopyCount(alignmentPtrs.size())));
+				}
+				this->m_task_group.run(std::bind(&GraphManager::constructAndAdjudicateGraph, this, variantListPtr, alignmentListPtr, graphAlignmentRegion, readLength, graphReservationPtr));
 			}
 		}
+		this->m_task_group.join();
 	}
 
-	void GraphManager::constructAndAdjudicateGraph(IVariantList::SharedPtr variantsListPtr, IAlignmentList::SharedPtr alignmentListPtr, Region::SharedPtr regionPtr, uint32_t readLength)
+	void GraphManager::constructAndAdjudicateGraph(IVariantList::SharedPtr variantsListPtr, IAlignmentList::SharedPtr alignmentListPtr, Region::SharedPtr regionPtr, uint32_t readLength, MemoryBudget::Reservation::SharedPtr graphReservationPtr)
 	{
-		// uint32_t numGraphCopies = (alignmentListPtr->getCount() < ThreadPool::Instance()->getThreadCount()) ? alignmentListPtr->getCount() : ThreadPool::Instance()->getThreadCount();  // get the min of threadcount and alignment count, this is the num of simultanious threads processing this graph
-		uint32_t numGraphCopies = ThreadPool::Instance()->getThreadCount();  // get the min of threadcount and alignment count, this is the num of simultanious threads processing this graph
-		std::deque< std::shared_ptr< std::future< void > > > futureFunctions;
-
-		auto gsswGraphPtr = std::make_shared< GSSWGraph >(this->m_reference_ptr, variantsListPtr, regionPtr, this->m_adjudicator_ptr->getMatchValue(), this->m_adjudicator_ptr->getMisMatchValue(), this->m_adjudicator_ptr->getGapOpenValue(), this->m_adjudicator_ptr->getGapExtensionValue(), numGraphCopies);
+		// shared between the batches so each task only carries its bounds
+		auto alignmentPtrs = std::make_shared< std::vector< IAlignment::SharedPtr > >(alignmentListPtr->getAlignmentPtrs());
+		uint32_t numGraphCopies = getGraphCopyCount(alignmentPtrs->size());
+		auto gsswGraphPtr = std::make_shared< GSSWGraph >(this->m_reference_ptr, variantsListPtr, regionPtr, this->m_adjudicator_ptr->getMatchValue(), this->m_adjudicator_ptr->getMisMatchValue(), this->m_adjudicator_ptr->getGapOpenValue(), this->m_adjudicator_ptr->getGapExtensionValue(), numGraphCopies, this->m_use_sw_kernels);
 		gsswGraphPtr->constructGraph();
 
-		auto referenceGraphPtr = std::make_shared< ReferenceGraph >(this->m_reference_ptr, variantsListPtr, regionPtr, this->m_adjudicator_ptr->getMatchValue(), this->m_adjudicator_ptr->getMisMatchValue(), this->m_adjudicator_ptr->getGapOpenValue(), this->m_adjudicator_ptr->getGapExtensionValue(), numGraphCopies);
+		auto referenceGraphPtr = std::make_shared< ReferenceGraph >(this->m_reference_ptr, variantsListPtr, regionPtr, this->m_adjudicator_ptr->getMatchValue(), this->m_adjudicator_ptr->getMisMatchValue(), this->m_adjudicator_ptr->getGapOpenValue(), this->m_adjudicator_ptr->getGapExtensionValue(), numGraphCopies, this->m_use_sw_kernels);
 		referenceGraphPtr->constructGraph();
 
 		/*
@@ -157,52 +157,91 @@ namespace graphite
 		std::cout << "===ALIGNMENTS===" << std::endl;
 		*/
 
-		IAlignment::SharedPtr alignmentPtr;
-		auto alignmentPtrs = alignmentListPtr->getAlignmentPtrs();
-		while (alignmentListPtr->getNextAlignment(alignmentPtr))
+		// this runs on a worker so it doesn't wait on the reads, buildGraphs joins them through the task group
+		for (size_t batchStart = 0; batchStart < alignmentPtrs->size(); batchStart += this->m_read_batch_size)
 		{
-			/*
-			static std::mutex mut;
-			{
-				mut.lock();
-				std::cout << std::string(alignmentPtr->getSequence(), alignmentPtr->getLength()) << " " << alignmentPtr->getID().substr(0, alignmentPtr->getID().size() - 1) << std::endl;
-				mut.unlock();
-			}
-			*/
-			auto gsswGraphContainer = gsswGraphPtr->getGraphContainer();
-			auto refGraphContainer = referenceGraphPtr->getGraphContainer();
-			auto funct = [gsswGraphContainer, refGraphContainer, gsswGraphPtr, referenceGraphPtr, alignmentPtr, this]()
+			size_t batchEnd = std::min< size_t >(batchStart + this->m_read_batch_size, alignmentPtrs->size());
+			auto funct = [gsswGraphPtr, referenceGraphPtr, alignmentPtrs, batchStart, batchEnd, graphReservationPtr, this]()
 			{
-				auto refTraceback = referenceGraphPtr->traceBackAlignment(alignmentPtr, refGraphContainer);
-				auto referenceMappingPtr = std::make_shared< GSSWMapping >(refTraceback, alignmentPtr);
-				auto referenceSWScore = referenceMappingPtr->getMappingScore();
-				uint32_t referenceSWPercent = ((referenceSWScore / (double)(alignmentPtr->getLength() * this->m_adjudicator_ptr->getMatchValue())) * 100);
+				// reads that match exactly one path get their mapping straight from the graph's k-mer index
+				std::vector< IAlignment::SharedPtr > variantAlignmentPtrs;
+				std::vector< GSSWGraph::GSSWGraphMappingPtr > exactMappingPtrs; // lines up with variantAlignmentPtrs, nullptr needs a traceback
+				std::vector< IAlignment::SharedPtr > unmatchedAlignmentPtrs;
+				for (size_t i = batchStart; i < batchEnd; ++i)
+				{
+					auto alignmentPtr = (*alignmentPtrs)[i];
+					auto exactMappingPtr = gsswGraphPtr->findExactMapping(alignmentPtr);
+					if (exactMappingPtr == nullptr)
+					{
+						unmatchedAlignmentPtrs.emplace_back(alignmentPtr);
+					}
+					else if (gsswGraphPtr->mappingTouchesVariants(exactMappingPtr))
+					{
+						variantAlignmentPtrs.emplace_back(alignmentPtr);
+						exactMappingPtrs.emplace_back(exactMappingPtr);
+					}
+				}
 
-				auto tracebackPtr = gsswGraphPtr->traceBackAlignment(alignmentPtr, gsswGraphContainer);
-				auto gsswMappingPtr = std::make_shared< GSSWMapping >(tracebackPtr, alignmentPtr);
+				// containers are checked out once per batch so copies are only made for threads that actually pick up this graph
+				auto gsswGraphContainer = gsswGraphPtr->getGraphContainer();
 
-				auto gsswSWScore = referenceMappingPtr->getMappingScore();
-				uint32_t gsswSWPercent = ((gsswSWScore / (double)(alignmentPtr->getLength() * this->m_adjudicator_ptr->getMatchValue())) * 100);
+				// score the rest of the batch, one read per lane, only a traceback that reaches a variant node can count an allele
+				std::vector< GraphSmithWaterman::ReadScore > graphSWScores;
+				gsswGraphPtr->scoreAlignments(unmatchedAlignmentPtrs, gsswGraphContainer, graphSWScores);
+				for (size_t i = 0; i < unmatchedAlignmentPtrs.size(); ++i)
+				{
+					if (gsswGraphPtr->alignmentMayTouchVariants(graphSWScores[i], unmatchedAlignmentPtrs[i]->getLength()))
+					{
+						variantAlignmentPtrs.emplace_back(unmatchedAlignmentPtrs[i]);
+						exactMappingPtrs.emplace_back(nullptr);
+					}
+				}
 
-				if (this->m_adjudicator_ptr->adjudicateMapping(gsswMappingPtr, referenceSWPercent))
+				// the reference graph only gives a score so it is never traced back, an exact match along the reference scores the same on both graphs
+				std::vector< uint32_t > referenceSWPercents(variantAlignmentPtrs.size(), 100);
+				std::vector< IAlignment::SharedPtr > referenceAlignmentPtrs;
+				std::vector< size_t > referenceIndices;
+				for (size_t i = 0; i < variantAlignmentPtrs.size(); ++i)
+				{
+					if (exactMappingPtrs[i] == nullptr || gsswGraphPtr->mappingTouchesAlternates(exactMappingPtrs[i]))
+					{
+						referenceAlignmentPtrs.emplace_back(variantAlignmentPtrs[i]);
+						referenceIndices.emplace_back(i);
+					}
+				}
+				if (!referenceAlignmentPtrs.empty())
 				{
-					MappingManager::Instance()->registerMapping(gsswMappingPtr);
+					std::vector< GraphSmithWaterman::ReadScore > referenceSWScores;
+					auto refGraphContainer = referenceGraphPtr->getGraphContainer();
+					referenceGraphPtr->scoreAlignments(referenceAlignmentPtrs, refGraphContainer, referenceSWScores);
+					referenceGraphPtr->checkinGraphContainer(refGraphContainer);
+					for (size_t i = 0; i < referenceAlignmentPtrs.size(); ++i)
+					{
+						referenceSWPercents[referenceIndices[i]] = ((referenceSWScores[i].score / (double)(referenceAlignmentPtrs[i]->getLength() * this->m_adjudicator_ptr->getMatchValue())) * 100);
+					}
 				}
-		    };
 
-			auto future = ThreadPool::Instance()->enqueue(funct);
-			futureFunctions.push_back(future);
-		}
+				for (size_t i = 0; i < variantAlignmentPtrs.size(); ++i)
+				{
+					auto alignmentPtr = variantAlignmentPtrs[i];
+					/*
+					static std::mutex mut;
+					{
+						mut.lock();
+						std::cout << std::string(alignmentPtr->getSequence(), alignmentPtr->getLength()) << " " << alignmentPtr->getID().substr(0, alignmentPtr->getID().size() - 1) << std::endl;
+						mut.unlock();
+					}
+					*/
+					auto tracebackPtr = (exactMappingPtrs[i] != nullptr) ? exactMappingPtrs[i] : gsswGraphPtr->traceBackAlignment(alignmentPtr, gsswGraphContainer);
+					auto gsswMappingPtr = std::make_shared< GSSWMapping >(tracebackPtr, alignmentPtr);
 
-		// wait for all the functions to complete (for all graphs to be created and adjudicated)
-		while (!futureFunctions.empty())
-		{
-			auto futureFunct = futureFunctions.front();
-			futureFunctions.pop_front();
-			if (futureFunct->wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
-			{
-				futureFunctions.emplace_back(futureFunct);
-			}
+					// the allele counts are updated while adjudicating so the mapping and its cigar are freed with the next read
+					this->m_adjudicator_ptr->adjudicateMapping(gsswMappingPtr, referenceSWPercents[i]);
+				}
+				gsswGraphPtr->checkinGraphContainer(gsswGraphContainer);
+			};
+
+			this->m_task_group.run(funct);
 		}
 	}
 
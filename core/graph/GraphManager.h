@@ -6,6 +6,8 @@
 #include "core/adjudicator/IAdjudicator.h"
 
 #include "core/graph/GSSWGraph.h"
+#include "core/util/ThreadPool.hpp"
+#include "core/util/MemoryBudget.hpp"
 
 #include <queue>
 #include <memory>
@@ -18,7 +20,7 @@ namespace graphite
 	public:
 		typedef std::shared_ptr< GraphManager > SharedPtr;
 
-		GraphManager(IReference::SharedPtr referencePtr, IVariantManager::SharedPtr variantManagerPtr, IAlignmentManager::SharedPtr alignmentManagerPtr, IAdjudicator::SharedPtr adjudicatorPtr);
+		GraphManager(IReference::SharedPtr referencePtr, IVariantManager::SharedPtr variantManagerPtr, IAlignmentManager::SharedPtr alignmentManagerPtr, IAdjudicator::SharedPtr adjudicatorPtr, uint32_t readBatchSize, uint32_t maxClusterSpan = 0, MemoryBudget::SharedPtr graphMemoryBudgetPtr = nullptr, bool useSWKernels = false);
 		~GraphManager() {}
 
 		/*
@@ -29,12 +31,29 @@ namespace graphite
 		 */
 		void buildGraphs(Region::SharedPtr region, uint32_t readLength);
 
+		/*
+		 * Takes the next cluster of variants off the sorted list, skipped variants
+		 * are passed over. startPosition and endPosition span the cluster's
+		 * regions. Returns false once the list is done.
+		 */
+		static bool GetNextCluster(IVariantList::SharedPtr variantsListPtr, uint32_t maxClusterSpan, std::vector< IVariant::SharedPtr >& variantPtrs, std::vector< Region::SharedPtr >& clusterRegionPtrs, position& startPosition, position& endPosition);
+
 	private:
-		void constructAndAdjudicateGraph(IVariantList::SharedPtr variantsListPtr, IAlignmentList::SharedPtr alignmentListPtr, Region::SharedPtr regionPtr, uint32_t readLength);
+		void constructAndAdjudicateGraph(IVariantList::SharedPtr variantsListPtr, IAlignmentList::SharedPtr alignmentListPtr, Region::SharedPtr regionPtr, uint32_t readLength, MemoryBudget::Reservation::SharedPtr graphReservationPtr);
+		uint32_t getGraphCopyCount(size_t alignmentCount);
+		static uint64_t EstimateGraphMemory(position graphLength, uint32_t readLength, uint32_t numGraphCopies);
 
 		std::vector< GSSWGraph::SharedPtr > m_gssw_graphs;
 		std::mutex m_gssw_graph_mutex;
 
+		// clusters are adjudicated concurrently, the budget caps how many graph and read tasks are outstanding at once
+		uint32_t m_task_budget;
+		uint32_t m_read_batch_size; // reads aligned per task, each batch checks out one graph container for all of its reads
+		uint32_t m_max_cluster_span; // the widest span of variant regions put in one graph, 0 doesn't limit it
+		TaskGroup m_task_group;
+		MemoryBudget::SharedPtr m_graph_memory_budget_ptr; // graphs wait for room before they are built, nullptr doesn't limit them
+		bool m_use_sw_kernels; // align with GraphSmithWaterman instead of gssw
+
 		IReference::SharedPtr m_reference_ptr;
 		IVariantManager::SharedPtr m_variant_manager_ptr;
 		IAlignmentManager::SharedPtr m_alignment_manager_ptr;
@@ -0,0 +1,743 @@
+#include "GraphSmithWaterman.h"
+#include "GraphFill.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <stdlib.h>
+
+namespace graphite
+{
+	namespace
+	{
+		// one lane of 32 bit scores, used when the wider kernels saturate and on cpus without them
+		struct ScalarWord
+		{
+			typedef int32_t Vector;
+			typedef int32_t Element;
+			static const uint32_t Lanes = 1;
+			static const int32_t MaxScore = std::numeric_limits< int32_t >::max();
+
+			static inline Vector Zero() { return 0; }
+			static inline Vector Set(int32_t value) { return value; }
+			static inline Vector AddProfile(Vector h, Vector profile, Vector bias) { return h + profile; }
+			static inline Vector Subtract(Vector a, Vector b) { return a - b; }
+			static inline Vector Max(Vector a, Vector b) { return (a > b) ? a : b; }
+			static inline Vector And(Vector a, Vector b) { return a & b; }
+			template < uint32_t Count > static inline Vector ShiftLanes(Vector a) { return 0; }
+			static inline bool AnyGreater(Vector a, Vector b) { return a > b; }
+			static inline int32_t HorizontalMax(Vector a) { return a; }
+		};
+
+		const size_t s_alignment = 64; // the widest vector
+		const int32_t s_alphabet_size = 5; // A, C, G, T and N as coded by the gssw nt_table
+		const int32_t s_nt_table_size = 128;
+		const uint32_t s_gssw_byte_lanes = 16;
+		const uint32_t s_gssw_word_lanes = 8;
+		const int32_t s_gssw_byte_limit = 255; // gssw moves to word lanes once a score plus the bias reaches this
+
+		size_t alignSize(size_t size)
+		{
+			return (size + s_alignment - 1) & ~(s_alignment - 1);
+		}
+	}
+
+	bool GraphFillScalar(GraphFillArgs& args)
+	{
+		return GraphFill< ScalarWord >(args);
+	}
+
+	GraphSmithWaterman::GraphSmithWaterman(gssw_graph* graphPtr, const int8_t* ntTable, const int8_t* scoreMatrix, int32_t gapOpen, int32_t gapExtension, Kernel kernel) :
+		m_kernel(kernel),
+		m_graph_ptr(graphPtr),
+		m_nt_table(ntTable),
+		m_score_matrix(scoreMatrix),
+		m_gap_open(gapOpen),
+		m_gap_extension(gapExtension),
+		m_column_count(0),
+		m_buffer(nullptr),
+		m_buffer_size(0),
+		m_batch_buffer(nullptr),
+		m_batch_buffer_size(0),
+		m_score_batch(nullptr),
+		m_score_batch_lanes(0)
+	{
+		switch (kernel)
+		{
+#if defined(__x86_64__) || defined(__i386__)
+		case Kernel::SSE41:
+			this->m_score_batch = GraphScoreSSE41Byte;
+			this->m_score_batch_lanes = 16;
+			break;
+		case Kernel::AVX2:
+			this->m_score_batch = GraphScoreAVX2Byte;
+			this->m_score_batch_lanes = 32;
+			break;
+		case Kernel::AVX512:
+			this->m_score_batch = GraphScoreAVX512Byte;
+			this->m_score_batch_lanes = 64;
+			break;
+#endif
+		default:
+			break;
+		}
+#if defined(__x86_64__) || defined(__i386__)
+		if (kernel != Kernel::Scalar)
+		{
+			// every vector instruction set has sse4.1, wider striped lanes wouldn't line up with gssw's
+			this->m_lane_widths = { { GraphFillSSE41Byte, s_gssw_byte_lanes, 1 }, { GraphFillSSE41Word, s_gssw_word_lanes, 2 } };
+		}
+#endif
+		this->m_lane_widths.push_back({ GraphFillScalar, 1, 4 });
+
+		this->m_bias = 1; // keeps the byte padding below every real score
+		this->m_max_match = 0;
+		for (int32_t i = 0; i < s_alphabet_size * s_alphabet_size; ++i)
+		{
+			this->m_bias = std::max< int32_t >(this->m_bias, -scoreMatrix[i]);
+			this->m_max_match = std::max< int32_t >(this->m_max_match, scoreMatrix[i]);
+		}
+
+		// the nodes are filled in the order they were added to the graph, which is topological
+		std::unordered_map< gssw_node*, uint32_t > nodeIndices;
+		for (uint32_t i = 0; i < graphPtr->size; ++i)
+		{
+			nodeIndices[graphPtr->nodes[i]] = i;
+		}
+		this->m_predecessor_offsets.push_back(0);
+		for (uint32_t i = 0; i < graphPtr->size; ++i)
+		{
+			gssw_node* node = graphPtr->nodes[i];
+			this->m_node_sequences.push_back(node->num);
+			this->m_node_lengths.push_back(node->len);
+			this->m_node_column_offsets.push_back(this->m_column_count);
+			this->m_column_count += node->len;
+			for (int32_t j = 0; j < node->count_prev; ++j)
+			{
+				auto iter = nodeIndices.find(node->prev[j]);
+				if (iter == nodeIndices.end() || iter->second >= i)
+				{
+					throw std::runtime_error("GraphSmithWaterman: graph nodes are not in topological order");
+				}
+				this->m_predecessor_indices.push_back(iter->second);
+			}
+			this->m_predecessor_offsets.push_back(this->m_predecessor_indices.size());
+		}
+	}
+
+	GraphSmithWaterman::~GraphSmithWaterman()
+	{
+		free(this->m_buffer);
+		free(this->m_batch_buffer);
+	}
+
+	GraphSmithWaterman::Kernel GraphSmithWaterman::GetBestKernel()
+	{
+		static Kernel s_best_kernel = GetSupportedKernels().back();
+		return s_best_kernel;
+	}
+
+	std::vector< GraphSmithWaterman::Kernel > GraphSmithWaterman::GetSupportedKernels()
+	{
+		std::vector< Kernel > kernels = { Kernel::Scalar };
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("sse4.1"))
+		{
+			kernels.push_back(Kernel::SSE41);
+		}
+		if (__builtin_cpu_supports("avx2"))
+		{
+			kernels.push_back(Kernel::AVX2);
+		}
+		if (__builtin_cpu_supports("avx512bw"))
+		{
+			kernels.push_back(Kernel::AVX512);
+		}
+#endif
+		return kernels;
+	}
+
+	std::string GraphSmithWaterman::GetKernelName(Kernel kernel)
+	{
+		switch (kernel)
+		{
+		case Kernel::SSE41: return "SSE4.1";
+		case Kernel::AVX2: return "AVX2";
+		case Kernel::AVX512: return "AVX-512BW";
+		default: return "scalar";
+		}
+	}
+
+	gssw_graph_mapping* GraphSmithWaterman::align(const char* read, uint32_t readLength)
+	{
+		scoreRead(read, readLength);
+		return traceBack();
+	}
+
+	int8_t GraphSmithWaterman::GetNucleotideCode(const int8_t* ntTable, char base)
+	{
+		uint8_t index = (uint8_t)base;
+		return (index < s_nt_table_size) ? ntTable[index] : s_alphabet_size - 1; // anything past the table is an N
+	}
+
+	/*
+	 * A byte fill only fails where gssw's would overflow, gssw then fills in
+	 * 8 word lanes so the lanes the scores are laid out in change with it.
+	 */
+	GraphSmithWaterman::ReadScore GraphSmithWaterman::scoreRead(const char* read, uint32_t readLength)
+	{
+		this->m_read.resize(readLength);
+		for (uint32_t i = 0; i < readLength; ++i)
+		{
+			this->m_read[i] = GetNucleotideCode(this->m_nt_table, read[i]);
+		}
+
+		this->m_max_score = 0;
+		this->m_max_node = 0;
+		this->m_max_column = 0;
+		if (readLength > 0 && this->m_column_count > 0)
+		{
+			uint32_t gsswLanes = s_gssw_byte_lanes;
+			for (const auto& laneWidth : this->m_lane_widths)
+			{
+				if (fill(laneWidth, gsswLanes))
+				{
+					if (gsswLanes == s_gssw_byte_lanes && this->m_max_score + this->m_bias >= s_gssw_byte_limit)
+					{
+						fill(laneWidth, s_gssw_word_lanes); // only a scalar fill gets past the byte limit
+					}
+					break;
+				}
+				gsswLanes = s_gssw_word_lanes;
+			}
+		}
+		return { this->m_max_score, this->m_max_node, this->m_max_column };
+	}
+
+	void GraphSmithWaterman::scoreReads(const std::vector< std::pair< const char*, uint32_t > >& reads, std::vector< ReadScore >& scores)
+	{
+		scores.resize(reads.size());
+		std::vector< uint32_t > pending;
+		uint32_t readIndex = 0;
+		if (this->m_score_batch != nullptr && this->m_column_count > 0)
+		{
+			// a batch that fills less than half of the lanes is slower than aligning its reads one at a time
+			std::vector< uint32_t > readIndices(reads.size());
+			for (uint32_t i = 0; i < readIndices.size(); ++i)
+			{
+				readIndices[i] = i;
+			}
+			while (reads.size() - readIndex >= this->m_score_batch_lanes / 2)
+			{
+				uint32_t batchSize = std::min< size_t >(this->m_score_batch_lanes, reads.size() - readIndex);
+				scoreBatch(reads, readIndices.data() + readIndex, batchSize, scores, pending);
+				readIndex += batchSize;
+			}
+		}
+		for (; readIndex < reads.size(); ++readIndex)
+		{
+			pending.push_back(readIndex);
+		}
+		for (auto pendingIndex : pending)
+		{
+			scores[pendingIndex] = scoreRead(reads[pendingIndex].first, reads[pendingIndex].second);
+		}
+	}
+
+	/*
+	 * The lanes are biased like the striped byte fill. A lane that reaches
+	 * gssw's byte limit holds a read gssw would have filled in word lanes.
+	 */
+	void GraphSmithWaterman::scoreBatch(const std::vector< std::pair< const char*, uint32_t > >& reads, const uint32_t* readIndices, uint32_t batchSize, std::vector< ReadScore >& scores, std::vector< uint32_t >& saturated)
+	{
+		int32_t bias = this->m_bias;
+		int32_t saturationScore = s_gssw_byte_limit - bias;
+
+		uint32_t lanes = this->m_score_batch_lanes;
+		uint32_t nodeCount = this->m_node_lengths.size();
+		uint32_t rowCount = 0;
+		for (uint32_t k = 0; k < batchSize; ++k)
+		{
+			rowCount = std::max(rowCount, reads[readIndices[k]].second);
+		}
+
+		size_t rowBytes = (size_t)lanes;
+		size_t profileBytes = alignSize(s_alphabet_size * rowCount * rowBytes);
+		size_t maskBytes = alignSize(rowCount * rowBytes);
+		size_t lastBytes = alignSize(nodeCount * rowCount * rowBytes);
+		size_t bufferSize = profileBytes + maskBytes + (2 * lastBytes) + alignSize(rowBytes);
+		if (bufferSize > this->m_batch_buffer_size)
+		{
+			free(this->m_batch_buffer);
+			void* buffer = nullptr;
+			if (posix_memalign(&buffer, s_alignment, bufferSize) != 0)
+			{
+				throw std::bad_alloc();
+			}
+			this->m_batch_buffer = static_cast< uint8_t* >(buffer);
+			this->m_batch_buffer_size = bufferSize;
+		}
+		uint8_t* profile = this->m_batch_buffer;
+		uint8_t* laneStartMasks = profile + profileBytes;
+		uint8_t* lastH = laneStartMasks + maskBytes;
+		uint8_t* lastE = lastH + lastBytes;
+		uint8_t* maxScores = lastE + lastBytes;
+
+		// rows past the end of a read and unused lanes get the padding score
+		std::fill(profile, profile + (s_alphabet_size * rowCount * lanes), 0);
+		std::fill(laneStartMasks, laneStartMasks + (rowCount * lanes), 0xff);
+		for (uint32_t k = 0; k < batchSize; ++k)
+		{
+			const char* read = reads[readIndices[k]].first;
+			uint32_t readLength = reads[readIndices[k]].second;
+			uint32_t gsswSegmentLength = (readLength + s_gssw_byte_lanes - 1) / s_gssw_byte_lanes;
+			for (uint32_t j = 0; j < readLength; ++j)
+			{
+				int8_t code = GetNucleotideCode(this->m_nt_table, read[j]);
+				for (int32_t nucleotide = 0; nucleotide < s_alphabet_size; ++nucleotide)
+				{
+					profile[((size_t)nucleotide * rowCount + j) * lanes + k] = (uint8_t)(this->m_score_matrix[(nucleotide * s_alphabet_size) + code] + bias);
+				}
+				if (j % gsswSegmentLength == 0)
+				{
+					laneStartMasks[(size_t)j * lanes + k] = 0;
+				}
+			}
+		}
+
+		GraphScoreArgs args;
+		args.nodeCount = nodeCount;
+		args.nodeSequences = this->m_node_sequences.data();
+		args.nodeLengths = this->m_node_lengths.data();
+		args.predecessorOffsets = this->m_predecessor_offsets.data();
+		args.predecessorIndices = this->m_predecessor_indices.data();
+		args.rowCount = rowCount;
+		args.gapOpen = this->m_gap_open;
+		args.gapExtension = this->m_gap_extension;
+		args.bias = bias;
+		args.profile = profile;
+		args.laneStartMasks = laneStartMasks;
+		args.lastH = lastH;
+		args.lastE = lastE;
+		args.maxScores = maxScores;
+		this->m_batch_max_nodes.resize(lanes);
+		this->m_batch_max_columns.resize(lanes);
+		args.maxNodes = this->m_batch_max_nodes.data();
+		args.maxColumns = this->m_batch_max_columns.data();
+		this->m_score_batch(args);
+
+		for (uint32_t k = 0; k < batchSize; ++k)
+		{
+			if (maxScores[k] >= saturationScore)
+			{
+				saturated.push_back(readIndices[k]);
+			}
+			else
+			{
+				scores[readIndices[k]] = { maxScores[k], this->m_batch_max_nodes[k], this->m_batch_max_columns[k] };
+			}
+		}
+	}
+
+	bool GraphSmithWaterman::fill(const LaneWidth& laneWidth, uint32_t gsswLanes)
+	{
+		uint32_t readLength = this->m_read.size();
+		uint32_t nodeCount = this->m_node_lengths.size();
+		this->m_lanes = laneWidth.lanes;
+		this->m_element_size = laneWidth.elementSize;
+		this->m_segment_length = (readLength + laneWidth.lanes - 1) / laneWidth.lanes;
+		this->m_column_bytes = (size_t)this->m_segment_length * laneWidth.lanes * laneWidth.elementSize;
+
+		size_t profileBytes = alignSize(s_alphabet_size * this->m_column_bytes);
+		size_t scoreBytes = alignSize(this->m_column_count * this->m_column_bytes);
+		size_t lastBytes = alignSize(nodeCount * this->m_column_bytes);
+		size_t columnBytes = alignSize(this->m_column_bytes);
+		size_t bufferSize = profileBytes + scoreBytes + (2 * lastBytes) + (3 * columnBytes);
+		if (bufferSize > this->m_buffer_size)
+		{
+			free(this->m_buffer);
+			void* buffer = nullptr;
+			if (posix_memalign(&buffer, s_alignment, bufferSize) != 0)
+			{
+				throw std::bad_alloc();
+			}
+			this->m_buffer = static_cast< uint8_t* >(buffer);
+			this->m_buffer_size = bufferSize;
+		}
+
+		uint8_t* profile = this->m_buffer;
+		this->m_scores = profile + profileBytes;
+		this->m_last_h = this->m_scores + scoreBytes;
+		uint8_t* lastE = this->m_last_h + lastBytes;
+		uint8_t* seedH = lastE + lastBytes;
+		uint8_t* columnE = seedH + columnBytes;
+		uint8_t* laneStartMasks = columnE + columnBytes;
+
+		// the lanes only need masks where they aren't gssw's, which is just the scalar fill
+		GraphFillArgs args;
+		args.laneStartMasks = (laneWidth.lanes == gsswLanes) ? nullptr : laneStartMasks;
+		switch (laneWidth.elementSize)
+		{
+		case 1:
+			buildProfile((uint8_t*)profile, this->m_bias, -this->m_bias);
+			args.saturationScore = s_gssw_byte_limit - this->m_bias;
+			break;
+		case 2:
+			buildProfile((int16_t*)profile, 0, std::numeric_limits< int16_t >::min() / 2);
+			args.saturationScore = std::numeric_limits< int16_t >::max() - this->m_max_match;
+			break;
+		default:
+			buildProfile((int32_t*)profile, 0, std::numeric_limits< int16_t >::min() / 2);
+			buildLaneStartMasks((int32_t*)laneStartMasks, gsswLanes);
+			args.saturationScore = std::numeric_limits< int32_t >::max();
+			break;
+		}
+		args.nodeCount = nodeCount;
+		args.nodeSequences = this->m_node_sequences.data();
+		args.nodeLengths = this->m_node_lengths.data();
+		args.nodeColumnOffsets = this->m_node_column_offsets.data();
+		args.predecessorOffsets = this->m_predecessor_offsets.data();
+		args.predecessorIndices = this->m_predecessor_indices.data();
+		args.segmentLength = this->m_segment_length;
+		args.gapOpen = this->m_gap_open;
+		args.gapExtension = this->m_gap_extension;
+		args.bias = this->m_bias;
+		args.profile = profile;
+		args.scores = this->m_scores;
+		args.lastH = this->m_last_h;
+		args.lastE = lastE;
+		args.seedH = seedH;
+		args.columnE = columnE;
+
+		if (!laneWidth.fill(args))
+		{
+			return false;
+		}
+		this->m_max_score = args.maxScore;
+		this->m_max_node = args.maxNode;
+		this->m_max_column = args.maxColumn;
+		return true;
+	}
+
+	/*
+	 * The padding at the end of the striped columns is given the lowest score
+	 * so it can never outscore a real read position.
+	 */
+	template < typename T >
+	void GraphSmithWaterman::buildProfile(T* profile, int32_t bias, int32_t paddingScore)
+	{
+		uint32_t readLength = this->m_read.size();
+		for (int32_t nucleotide = 0; nucleotide < s_alphabet_size; ++nucleotide)
+		{
+			const int8_t* scores = this->m_score_matrix + (nucleotide * s_alphabet_size);
+			for (uint32_t segment = 0; segment < this->m_segment_length; ++segment)
+			{
+				for (uint32_t lane = 0; lane < this->m_lanes; ++lane)
+				{
+					uint32_t row = (lane * this->m_segment_length) + segment;
+					int32_t score = (row < readLength) ? scores[this->m_read[row]] : paddingScore;
+					*profile++ = (T)(score + bias);
+				}
+			}
+		}
+	}
+
+	/*
+	 * Clears the lanes of the segments that start one of gssw's lanes, read
+	 * position j of gssw's layout is in lane j / ceil(readLength / gsswLanes).
+	 */
+	template < typename T >
+	void GraphSmithWaterman::buildLaneStartMasks(T* masks, uint32_t gsswLanes)
+	{
+		uint32_t readLength = this->m_read.size();
+		uint32_t gsswSegmentLength = (readLength + gsswLanes - 1) / gsswLanes;
+		for (uint32_t segment = 0; segment < this->m_segment_length; ++segment)
+		{
+			for (uint32_t lane = 0; lane < this->m_lanes; ++lane)
+			{
+				uint32_t row = (lane * this->m_segment_length) + segment;
+				*masks++ = (row % gsswSegmentLength == 0) ? 0 : (T)-1;
+			}
+		}
+	}
+
+	void GraphSmithWaterman::getPredecessors(uint32_t node, std::vector< uint32_t >& predecessors)
+	{
+		for (uint32_t i = this->m_predecessor_offsets[node]; i < this->m_predecessor_offsets[node + 1]; ++i)
+		{
+			uint32_t predecessor = this->m_predecessor_indices[i];
+			if (this->m_node_lengths[predecessor] > 0)
+			{
+				predecessors.push_back(predecessor);
+			}
+			else
+			{
+				getPredecessors(predecessor, predecessors); // nodes without sequence pass their seed through
+			}
+		}
+	}
+
+	int32_t GraphSmithWaterman::getSeedScore(uint32_t node, uint32_t row)
+	{
+		int32_t score = 0;
+		for (uint32_t i = this->m_predecessor_offsets[node]; i < this->m_predecessor_offsets[node + 1]; ++i)
+		{
+			score = std::max(score, getScore(getLastColumn(this->m_predecessor_indices[i]), row));
+		}
+		return score;
+	}
+
+	uint32_t GraphSmithWaterman::findPredecessor(uint32_t node, uint32_t row, int32_t score)
+	{
+		std::vector< uint32_t > predecessors;
+		getPredecessors(node, predecessors);
+		for (auto predecessor : predecessors)
+		{
+			if (getScore(getLastColumn(predecessor), row) == score)
+			{
+				return predecessor;
+			}
+		}
+		throw std::runtime_error("GraphSmithWaterman: no predecessor matches the traceback score");
+	}
+
+	/*
+	 * Only H is kept, so each step looks for the neighbouring cell that produces
+	 * the current score. A diagonal step is preferred, then a deletion and then
+	 * an insertion, the same order gssw's traceback tries them in. The carried
+	 * F can raise a cell above the H'' a gap was opened from, if no cell gives
+	 * the score exactly the gap is opened from the first one at or above it.
+	 */
+	gssw_graph_mapping* GraphSmithWaterman::traceBack()
+	{
+		if (this->m_max_score <= 0)
+		{
+			return buildMapping(0, 0, 0);
+		}
+
+		uint32_t node = this->m_max_node;
+		uint32_t column = this->m_max_column;
+		uint32_t row = 0;
+		const uint8_t* maxColumn = getColumn(node, column);
+		while (row + 1 < this->m_read.size() && getScore(maxColumn, row) != this->m_max_score) // the first read position with the max score ends the alignment
+		{
+			++row;
+		}
+		uint32_t endRow = row;
+
+		this->m_operations.clear();
+		int32_t score = this->m_max_score;
+		while (true)
+		{
+			int8_t reference = this->m_node_sequences[node][column];
+			int8_t base = this->m_read[row];
+			int32_t diagonal = 0;
+			if (row > 0)
+			{
+				diagonal = (column > 0) ? getScore(getColumn(node, column - 1), row - 1) : getSeedScore(node, row - 1);
+			}
+			if (score == diagonal + this->m_score_matrix[(reference * s_alphabet_size) + base])
+			{
+				this->m_operations.emplace_back(node, (reference == base) ? 'M' : 'X');
+				if (diagonal == 0)
+				{
+					break;
+				}
+				score = diagonal;
+				if (column > 0)
+				{
+					--column;
+				}
+				else
+				{
+					node = findPredecessor(node, row - 1, diagonal);
+					column = this->m_node_lengths[node] - 1;
+				}
+				--row;
+			}
+			else if (!traceDeletion(node, column, row, score, true) && !traceInsertion(node, column, row, score, true) &&
+					 !traceDeletion(node, column, row, score, false) && !traceInsertion(node, column, row, score, false))
+			{
+				throw std::runtime_error("GraphSmithWaterman: unable to trace back the alignment");
+			}
+		}
+		std::reverse(this->m_operations.begin(), this->m_operations.end());
+		return buildMapping(column, row, endRow);
+	}
+
+	bool GraphSmithWaterman::traceInsertion(uint32_t node, uint32_t column, uint32_t& row, int32_t& score, bool exact)
+	{
+		const uint8_t* scores = getColumn(node, column);
+		for (uint32_t length = 1; length <= row; ++length)
+		{
+			int32_t sourceScore = score + this->m_gap_open + ((length - 1) * this->m_gap_extension);
+			if (sourceScore > this->m_max_score)
+			{
+				break;
+			}
+			int32_t cellScore = getScore(scores, row - length);
+			if (cellScore == sourceScore || (!exact && cellScore > sourceScore))
+			{
+				this->m_operations.insert(this->m_operations.end(), length, std::make_pair(node, 'I'));
+				row -= length;
+				score = sourceScore;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool GraphSmithWaterman::traceDeletion(uint32_t& node, uint32_t& column, uint32_t row, int32_t& score, bool exact)
+	{
+		this->m_deletion_nodes.clear();
+		this->m_deletion_visits.clear();
+		this->m_deletion_nodes.push_back(node); // the current column is the last deleted reference base
+		bool found = false;
+		if (column > 0)
+		{
+			found = findDeletionSource(node, column - 1, row, score, 1, exact);
+		}
+		else
+		{
+			std::vector< uint32_t > predecessors;
+			getPredecessors(node, predecessors);
+			for (uint32_t i = 0; i < predecessors.size() && !found; ++i)
+			{
+				found = findDeletionSource(predecessors[i], this->m_node_lengths[predecessors[i]] - 1, row, score, 1, exact);
+			}
+		}
+		if (!found)
+		{
+			return false;
+		}
+		for (auto deletionNode : this->m_deletion_nodes)
+		{
+			this->m_operations.emplace_back(deletionNode, 'D');
+		}
+		node = this->m_deletion_source_node;
+		column = this->m_deletion_source_column;
+		score = this->m_deletion_source_score;
+		return true;
+	}
+
+	/*
+	 * length reference bases after (node, column) have been deleted so far. The walk back
+	 * through a node only depends on length + column so each of those is searched once.
+	 */
+	bool GraphSmithWaterman::findDeletionSource(uint32_t node, uint32_t column, uint32_t row, int32_t score, uint32_t length, bool exact)
+	{
+		if (!this->m_deletion_visits.emplace(node, length + column).second)
+		{
+			return false;
+		}
+		size_t pathSize = this->m_deletion_nodes.size();
+		while (true)
+		{
+			int32_t sourceScore = score + this->m_gap_open + ((length - 1) * this->m_gap_extension);
+			if (sourceScore > this->m_max_score)
+			{
+				break;
+			}
+			int32_t cellScore = getScore(getColumn(node, column), row);
+			if (cellScore == sourceScore || (!exact && cellScore > sourceScore))
+			{
+				this->m_deletion_source_node = node;
+				this->m_deletion_source_column = column;
+				this->m_deletion_source_score = sourceScore;
+				return true;
+			}
+			this->m_deletion_nodes.push_back(node);
+			++length;
+			if (column > 0)
+			{
+				--column;
+				continue;
+			}
+			std::vector< uint32_t > predecessors;
+			getPredecessors(node, predecessors);
+			for (auto predecessor : predecessors)
+			{
+				if (findDeletionSource(predecessor, this->m_node_lengths[predecessor] - 1, row, score, length, exact))
+				{
+					return true;
+				}
+			}
+			break;
+		}
+		this->m_deletion_nodes.resize(pathSize);
+		return false;
+	}
+
+	gssw_graph_mapping* GraphSmithWaterman::buildMapping(uint32_t startColumn, uint32_t startRow, uint32_t endRow)
+	{
+		gssw_graph_mapping* mappingPtr = (gssw_graph_mapping*)calloc(1, sizeof(gssw_graph_mapping));
+		mappingPtr->position = startColumn;
+		mappingPtr->score = this->m_max_score;
+		if (this->m_max_score <= 0)
+		{
+			return mappingPtr;
+		}
+
+		uint32_t nodeCount = 0;
+		for (size_t i = 0; i < this->m_operations.size(); ++i)
+		{
+			if (i == 0 || this->m_operations[i].first != this->m_operations[i - 1].first)
+			{
+				++nodeCount;
+			}
+		}
+		mappingPtr->cigar.length = nodeCount;
+		mappingPtr->cigar.elements = (gssw_node_cigar*)calloc(nodeCount, sizeof(gssw_node_cigar));
+
+		uint32_t trailingSoftClip = this->m_read.size() - endRow - 1;
+		std::vector< gssw_cigar_element > elements;
+		gssw_node_cigar* nodeCigar = mappingPtr->cigar.elements;
+		for (size_t i = 0; i < this->m_operations.size(); ++i)
+		{
+			if (i == 0 && startRow > 0)
+			{
+				elements.push_back({ 'S', startRow });
+			}
+			char type = this->m_operations[i].second;
+			if (!elements.empty() && elements.back().type == type)
+			{
+				++elements.back().length;
+			}
+			else
+			{
+				elements.push_back({ type, 1 });
+			}
+
+			bool lastOperation = (i + 1 == this->m_operations.size());
+			if (lastOperation || this->m_operations[i + 1].first != this->m_operations[i].first)
+			{
+				if (lastOperation && trailingSoftClip > 0)
+				{
+					elements.push_back({ 'S', trailingSoftClip });
+				}
+				nodeCigar->node = this->m_graph_ptr->nodes[this->m_operations[i].first];
+				nodeCigar->cigar = (gssw_cigar*)calloc(1, sizeof(gssw_cigar));
+				nodeCigar->cigar->length = elements.size();
+				nodeCigar->cigar->elements = (gssw_cigar_element*)malloc(elements.size() * sizeof(gssw_cigar_element));
+				std::copy(elements.begin(), elements.end(), nodeCigar->cigar->elements);
+				elements.clear();
+				++nodeCigar;
+			}
+		}
+		return mappingPtr;
+	}
+
+	void GraphSmithWaterman::DestroyMapping(gssw_graph_mapping* mappingPtr)
+	{
+		for (uint32_t i = 0; i < mappingPtr->cigar.length; ++i)
+		{
+			free(mappingPtr->cigar.elements[i].cigar->elements);
+			free(mappingPtr->cigar.elements[i].cigar);
+		}
+		free(mappingPtr->cigar.elements);
+		free(mappingPtr);
+	}
+}
@@ -0,0 +1,156 @@
+#ifndef GRAPHITE_GRAPHSMITHWATERMAN_H
+#define GRAPHITE_GRAPHSMITHWATERMAN_H
+
+#include "gssw.h"
+
+#include "core/graph/GraphSmithWatermanKernel.h"
+#include "core/util/Noncopyable.hpp"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace graphite
+{
+	/*
+	 * Aligns reads to a gssw_graph with graphite's own striped kernels. The graph
+	 * is only read, so one aligner is built per graph container and reused for
+	 * every read the container aligns. A single read is filled and traced back
+	 * in gssw's layout of 16 byte lanes with SSE4.1, or the scalar fill without
+	 * it, moving to 8 word lanes and then a 32 bit lane if the scores get too
+	 * large. AVX2 and AVX-512BW only score batches of reads, one read per byte
+	 * lane, there is no wider fill to trace back from.
+	 *
+	 * gssw moves a single node to word lanes when its bytes overflow, here the
+	 * whole graph moves. gssw's word loop differs from its byte loop when
+	 * gapOpen <= gapExtension so those settings can score differently and
+	 * GSSWGraph leaves them to gssw. gssw stays the default aligner, this is
+	 * used when --sw_kernels is given.
+	 */
+	class GraphSmithWaterman : private Noncopyable
+	{
+	public:
+		typedef std::shared_ptr< GraphSmithWaterman > SharedPtr;
+
+		enum class Kernel { Scalar, SSE41, AVX2, AVX512 };
+
+		// the best score of a read and the graph node (by index) and column the alignment ends in
+		struct ReadScore
+		{
+			int32_t score;
+			uint32_t endNode;
+			uint32_t endColumn;
+		};
+
+		GraphSmithWaterman(gssw_graph* graphPtr, const int8_t* ntTable, const int8_t* scoreMatrix, int32_t gapOpen, int32_t gapExtension, Kernel kernel = GetBestKernel());
+		~GraphSmithWaterman();
+
+		/*
+		 * The mapping is laid out the same way as gssw_graph_trace_back's and
+		 * has to be released with DestroyMapping.
+		 */
+		gssw_graph_mapping* align(const char* read, uint32_t readLength);
+
+		/*
+		 * Scores without a traceback. scoreReads aligns the reads in batches with
+		 * one read per 8 bit lane. Reads that reach gssw's byte limit and reads
+		 * left over from a batch too small to fill the lanes go through scoreRead.
+		 */
+		ReadScore scoreRead(const char* read, uint32_t readLength);
+		void scoreReads(const std::vector< std::pair< const char*, uint32_t > >& reads, std::vector< ReadScore >& scores);
+		Kernel getKernel() { return m_kernel; }
+
+		static void DestroyMapping(gssw_graph_mapping* mappingPtr);
+		static int8_t GetNucleotideCode(const int8_t* ntTable, char base);
+		static Kernel GetBestKernel();
+		static std::vector< Kernel > GetSupportedKernels();
+		static std::string GetKernelName(Kernel kernel);
+
+	private:
+		struct LaneWidth
+		{
+			GraphFillFunction fill;
+			uint32_t lanes;
+			uint32_t elementSize;
+		};
+
+		bool fill(const LaneWidth& laneWidth, uint32_t gsswLanes);
+		void scoreBatch(const std::vector< std::pair< const char*, uint32_t > >& reads, const uint32_t* readIndices, uint32_t batchSize, std::vector< ReadScore >& scores, std::vector< uint32_t >& saturated);
+		template < typename T >
+		void buildProfile(T* profile, int32_t bias, int32_t paddingScore);
+		template < typename T >
+		void buildLaneStartMasks(T* masks, uint32_t gsswLanes);
+		gssw_graph_mapping* traceBack();
+		bool traceInsertion(uint32_t node, uint32_t column, uint32_t& row, int32_t& score, bool exact);
+		bool traceDeletion(uint32_t& node, uint32_t& column, uint32_t row, int32_t& score, bool exact);
+		bool findDeletionSource(uint32_t node, uint32_t column, uint32_t row, int32_t score, uint32_t length, bool exact);
+		gssw_graph_mapping* buildMapping(uint32_t startColumn, uint32_t startRow, uint32_t endRow);
+		void getPredecessors(uint32_t node, std::vector< uint32_t >& predecessors);
+		uint32_t findPredecessor(uint32_t node, uint32_t row, int32_t score);
+		int32_t getSeedScore(uint32_t node, uint32_t row);
+
+		const uint8_t* getColumn(uint32_t node, uint32_t column) { return this->m_scores + ((size_t)this->m_node_column_offsets[node] + column) * this->m_column_bytes; }
+		const uint8_t* getLastColumn(uint32_t node) { return this->m_last_h + (size_t)node * this->m_column_bytes; }
+		int32_t getScore(const uint8_t* column, uint32_t row)
+		{
+			size_t index = (row % this->m_segment_length) * this->m_lanes + (row / this->m_segment_length);
+			switch (this->m_element_size)
+			{
+			case 1: return column[index];
+			case 2: return ((const int16_t*)column)[index];
+			default: return ((const int32_t*)column)[index];
+			}
+		}
+
+		Kernel m_kernel;
+		std::vector< LaneWidth > m_lane_widths;
+		gssw_graph* m_graph_ptr;
+		const int8_t* m_nt_table;
+		const int8_t* m_score_matrix;
+		int32_t m_gap_open;
+		int32_t m_gap_extension;
+		int32_t m_bias;
+		int32_t m_max_match;
+
+		std::vector< const int8_t* > m_node_sequences;
+		std::vector< uint32_t > m_node_lengths;
+		std::vector< uint32_t > m_node_column_offsets;
+		std::vector< uint32_t > m_predecessor_offsets;
+		std::vector< uint32_t > m_predecessor_indices;
+		uint32_t m_column_count;
+
+		std::vector< int8_t > m_read;
+		uint8_t* m_buffer;
+		size_t m_buffer_size;
+
+		GraphScoreFunction m_score_batch; // nullptr without a vector instruction set
+		uint32_t m_score_batch_lanes;
+		uint8_t* m_batch_buffer;
+		size_t m_batch_buffer_size;
+		std::vector< uint32_t > m_batch_max_nodes;
+		std::vector< uint32_t > m_batch_max_columns;
+
+		// the layout and result of the last fill
+		uint32_t m_segment_length;
+		uint32_t m_lanes;
+		uint32_t m_element_size;
+		size_t m_column_bytes;
+		uint8_t* m_scores;
+		uint8_t* m_last_h;
+		int32_t m_max_score;
+		uint32_t m_max_node;
+		uint32_t m_max_column;
+
+		// traceback scratch, operations are collected from the end of the alignment back to the start
+		std::vector< std::pair< uint32_t, char > > m_operations;
+		std::vector< uint32_t > m_deletion_nodes;
+		std::set< std::pair< uint32_t, uint32_t > > m_deletion_visits;
+		uint32_t m_deletion_source_node;
+		uint32_t m_deletion_source_column;
+		int32_t m_deletion_source_score;
+	};
+}
+
+#endif //GRAPHITE_GRAPHSMITHWATERMAN_H
@@ -0,0 +1,56 @@
+#if defined(__x86_64__) || defined(__i386__)
+
+#include "core/graph/GraphFill.hpp"
+
+#include <immintrin.h>
+
+// this file is compiled with -mavx2, only call into it after checking the cpu supports it
+namespace graphite
+{
+	namespace
+	{
+		// moves the elements up by up to 16 bytes across the 128 bit halves, the low lanes become zero
+		template < int Bytes >
+		inline __m256i AVX2ShiftBytes(__m256i a)
+		{
+			return _mm256_alignr_epi8(a, _mm256_permute2x128_si256(a, a, 0x08), 16 - Bytes);
+		}
+
+		struct AVX2Byte
+		{
+			typedef __m256i Vector;
+			typedef uint8_t Element;
+			static const uint32_t Lanes = 32;
+			static const int32_t MaxScore = 255;
+
+			static inline Vector Zero() { return _mm256_setzero_si256(); }
+			static inline Vector Set(int32_t value) { return _mm256_set1_epi8((char)value); }
+			static inline Vector AddProfile(Vector h, Vector profile, Vector bias) { return _mm256_subs_epu8(_mm256_adds_epu8(h, profile), bias); }
+			static inline Vector Subtract(Vector a, Vector b) { return _mm256_subs_epu8(a, b); }
+			static inline Vector Max(Vector a, Vector b) { return _mm256_max_epu8(a, b); }
+			static inline Vector And(Vector a, Vector b) { return _mm256_and_si256(a, b); }
+			template < uint32_t Count > static inline Vector ShiftLanes(Vector a) { return AVX2ShiftBytes< Count >(a); }
+			static inline bool AnyGreater(Vector a, Vector b)
+			{
+				Vector difference = _mm256_subs_epu8(a, b);
+				return !_mm256_testz_si256(difference, difference);
+			}
+			static inline int32_t HorizontalMax(Vector a)
+			{
+				__m128i b = _mm_max_epu8(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+				b = _mm_max_epu8(b, _mm_srli_si128(b, 8));
+				b = _mm_max_epu8(b, _mm_srli_si128(b, 4));
+				b = _mm_max_epu8(b, _mm_srli_si128(b, 2));
+				b = _mm_max_epu8(b, _mm_srli_si128(b, 1));
+				return _mm_extract_epi8(b, 0) & 0xff;
+			}
+		};
+	}
+
+	void GraphScoreAVX2Byte(GraphScoreArgs& args)
+	{
+		GraphScore< AVX2Byte >(args);
+	}
+}
+
+#endif
@@ -0,0 +1,63 @@
+#if defined(__x86_64__) || defined(__i386__)
+
+#include "core/graph/GraphFill.hpp"
+
+#include <immintrin.h>
+
+// this file is compiled with -mavx512bw, only call into it after checking the cpu supports it
+namespace graphite
+{
+	namespace
+	{
+		// moves the elements up across the 128 bit blocks, the low lanes become zero
+		template < int Bytes >
+		inline __m512i AVX512ShiftBytes(__m512i a)
+		{
+			if (Bytes % 4 == 0)
+			{
+				return _mm512_alignr_epi32(a, _mm512_setzero_si512(), (16 - (Bytes / 4)) & 15);
+			}
+			__m512i previousBlocks = _mm512_maskz_shuffle_i32x4(0xfff0, a, a, _MM_SHUFFLE(2, 1, 0, 0));
+			return _mm512_alignr_epi8(a, previousBlocks, (16 - Bytes) & 15);
+		}
+
+		inline __m256i AVX512HalfMaxEpu8(__m512i a)
+		{
+			return _mm256_max_epu8(_mm512_castsi512_si256(a), _mm512_extracti64x4_epi64(a, 1));
+		}
+
+		struct AVX512Byte
+		{
+			typedef __m512i Vector;
+			typedef uint8_t Element;
+			static const uint32_t Lanes = 64;
+			static const int32_t MaxScore = 255;
+
+			static inline Vector Zero() { return _mm512_setzero_si512(); }
+			static inline Vector Set(int32_t value) { return _mm512_set1_epi8((char)value); }
+			static inline Vector AddProfile(Vector h, Vector profile, Vector bias) { return _mm512_subs_epu8(_mm512_adds_epu8(h, profile), bias); }
+			static inline Vector Subtract(Vector a, Vector b) { return _mm512_subs_epu8(a, b); }
+			static inline Vector Max(Vector a, Vector b) { return _mm512_max_epu8(a, b); }
+			static inline Vector And(Vector a, Vector b) { return _mm512_and_si512(a, b); }
+			template < uint32_t Count > static inline Vector ShiftLanes(Vector a) { return AVX512ShiftBytes< Count >(a); }
+			static inline bool AnyGreater(Vector a, Vector b) { return _mm512_cmpgt_epu8_mask(a, b) != 0; }
+			static inline int32_t HorizontalMax(Vector a)
+			{
+				__m256i half = AVX512HalfMaxEpu8(a);
+				__m128i b = _mm_max_epu8(_mm256_castsi256_si128(half), _mm256_extracti128_si256(half, 1));
+				b = _mm_max_epu8(b, _mm_srli_si128(b, 8));
+				b = _mm_max_epu8(b, _mm_srli_si128(b, 4));
+				b = _mm_max_epu8(b, _mm_srli_si128(b, 2));
+				b = _mm_max_epu8(b, _mm_srli_si128(b, 1));
+				return _mm_extract_epi8(b, 0) & 0xff;
+			}
+		};
+	}
+
+	void GraphScoreAVX512Byte(GraphScoreArgs& args)
+	{
+		GraphScore< AVX512Byte >(args);
+	}
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef GRAPHITE_GRAPHSMITHWATERMANKERNEL_H
+#define GRAPHITE_GRAPHSMITHWATERMANKERNEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace graphite
+{
+	/*
+	 * Everything a striped graph fill needs, the buffers are owned by GraphSmithWaterman.
+	 * Columns are stored striped: read position j of a column lives in
+	 * segment (j % segmentLength), lane (j / segmentLength). The element
+	 * type of the buffers depends on which fill is called.
+	 */
+	struct GraphFillArgs
+	{
+		uint32_t nodeCount;
+		const int8_t* const* nodeSequences; // the numeric (nt_table) sequence of each node
+		const uint32_t* nodeLengths;
+		const uint32_t* nodeColumnOffsets; // index of the first column of each node in scores
+		const uint32_t* predecessorOffsets; // the predecessors of node n are predecessorIndices[predecessorOffsets[n]..predecessorOffsets[n + 1])
+		const uint32_t* predecessorIndices;
+		uint32_t segmentLength;
+		int32_t gapOpen;
+		int32_t gapExtension;
+		int32_t bias; // only used by the unsigned byte fills
+		int32_t saturationScore; // a score at or above this may have saturated the lanes
+		const void* profile; // one column per nucleotide code (0-4)
+		const void* laneStartMasks; // nullptr if the lanes are gssw's, otherwise one per segment, see GraphFill
+		void* scores; // H for every column of every node
+		void* lastH; // H of the last column of each node
+		void* lastE; // E flowing out of the last column of each node
+		void* seedH;
+		void* columnE;
+
+		int32_t maxScore;
+		uint32_t maxNode;
+		uint32_t maxColumn;
+	};
+
+	typedef bool (*GraphFillFunction)(GraphFillArgs& args);
+
+	/*
+	 * Scores a batch of reads against the graph at once, one read per lane.
+	 * Row j of a column holds read position j of every read in the batch and
+	 * rows past the end of a read are given the lowest score. Only the best
+	 * score of each lane is kept so there is nothing to trace back.
+	 */
+	struct GraphScoreArgs
+	{
+		uint32_t nodeCount;
+		const int8_t* const* nodeSequences;
+		const uint32_t* nodeLengths;
+		const uint32_t* predecessorOffsets;
+		const uint32_t* predecessorIndices;
+		uint32_t rowCount; // the length of the longest read in the batch
+		int32_t gapOpen;
+		int32_t gapExtension;
+		int32_t bias; // only used by the unsigned byte fills
+		const void* profile; // rowCount rows per nucleotide code (0-4)
+		const void* laneStartMasks; // one per row, the lanes whose read starts one of gssw's lanes there are cleared
+		void* lastH; // H of the last column of each node, rowCount rows per node
+		void* lastE;
+		void* maxScores; // one vector, the best score of each read
+		uint32_t* maxNodes; // the first node and column each read reached its best score in
+		uint32_t* maxColumns;
+	};
+
+	typedef void (*GraphScoreFunction)(GraphScoreArgs& args);
+
+	/*
+	 * Each fill returns false if the scores got too large for its lanes,
+	 * the caller then repeats the fill with wider lanes. The striped fills
+	 * only come in gssw's lane counts, 16 bytes and then 8 words, which
+	 * keeps their columns laid out the same as gssw's.
+	 */
+	bool GraphFillScalar(GraphFillArgs& args);
+#if defined(__x86_64__) || defined(__i386__)
+	bool GraphFillSSE41Byte(GraphFillArgs& args);
+	bool GraphFillSSE41Word(GraphFillArgs& args);
+
+	/*
+	 * A lane of a batch fill that reaches gssw's byte limit, 255 less the
+	 * bias, is scored again on its own since gssw moves it to word lanes.
+	 */
+	void GraphScoreSSE41Byte(GraphScoreArgs& args);
+	void GraphScoreAVX2Byte(GraphScoreArgs& args);
+	void GraphScoreAVX512Byte(GraphScoreArgs& args);
+#endif
+}
+
+#endif //GRAPHITE_GRAPHSMITHWATERMANKERNEL_H
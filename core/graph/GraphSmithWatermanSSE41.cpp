@@ -0,0 +1,82 @@
+#if defined(__x86_64__) || defined(__i386__)
+
+#include "core/graph/GraphFill.hpp"
+
+#include <smmintrin.h>
+
+// this file is compiled with -msse4.1, only call into it after checking the cpu supports it
+namespace graphite
+{
+	namespace
+	{
+		struct SSE41Byte
+		{
+			typedef __m128i Vector;
+			typedef uint8_t Element;
+			static const uint32_t Lanes = 16;
+			static const int32_t MaxScore = 255;
+
+			static inline Vector Zero() { return _mm_setzero_si128(); }
+			static inline Vector Set(int32_t value) { return _mm_set1_epi8((char)value); }
+			static inline Vector AddProfile(Vector h, Vector profile, Vector bias) { return _mm_subs_epu8(_mm_adds_epu8(h, profile), bias); }
+			static inline Vector Subtract(Vector a, Vector b) { return _mm_subs_epu8(a, b); }
+			static inline Vector Max(Vector a, Vector b) { return _mm_max_epu8(a, b); }
+			static inline Vector And(Vector a, Vector b) { return _mm_and_si128(a, b); }
+			template < uint32_t Count > static inline Vector ShiftLanes(Vector a) { return _mm_slli_si128(a, Count); }
+			static inline bool AnyGreater(Vector a, Vector b)
+			{
+				Vector difference = _mm_subs_epu8(a, b);
+				return !_mm_testz_si128(difference, difference);
+			}
+			static inline int32_t HorizontalMax(Vector a)
+			{
+				a = _mm_max_epu8(a, _mm_srli_si128(a, 8));
+				a = _mm_max_epu8(a, _mm_srli_si128(a, 4));
+				a = _mm_max_epu8(a, _mm_srli_si128(a, 2));
+				a = _mm_max_epu8(a, _mm_srli_si128(a, 1));
+				return _mm_extract_epi8(a, 0) & 0xff;
+			}
+		};
+
+		struct SSE41Word
+		{
+			typedef __m128i Vector;
+			typedef int16_t Element;
+			static const uint32_t Lanes = 8;
+			static const int32_t MaxScore = 32767;
+
+			static inline Vector Zero() { return _mm_setzero_si128(); }
+			static inline Vector Set(int32_t value) { return _mm_set1_epi16((short)value); }
+			static inline Vector AddProfile(Vector h, Vector profile, Vector bias) { return _mm_adds_epi16(h, profile); }
+			static inline Vector Subtract(Vector a, Vector b) { return _mm_subs_epi16(a, b); }
+			static inline Vector Max(Vector a, Vector b) { return _mm_max_epi16(a, b); }
+			static inline Vector And(Vector a, Vector b) { return _mm_and_si128(a, b); }
+			template < uint32_t Count > static inline Vector ShiftLanes(Vector a) { return _mm_slli_si128(a, Count * 2); }
+			static inline bool AnyGreater(Vector a, Vector b) { return _mm_movemask_epi8(_mm_cmpgt_epi16(a, b)) != 0; }
+			static inline int32_t HorizontalMax(Vector a)
+			{
+				a = _mm_max_epi16(a, _mm_srli_si128(a, 8));
+				a = _mm_max_epi16(a, _mm_srli_si128(a, 4));
+				a = _mm_max_epi16(a, _mm_srli_si128(a, 2));
+				return (int16_t)_mm_extract_epi16(a, 0);
+			}
+		};
+	}
+
+	bool GraphFillSSE41Byte(GraphFillArgs& args)
+	{
+		return GraphFill< SSE41Byte >(args);
+	}
+
+	bool GraphFillSSE41Word(GraphFillArgs& args)
+	{
+		return GraphFill< SSE41Word >(args);
+	}
+
+	void GraphScoreSSE41Byte(GraphScoreArgs& args)
+	{
+		GraphScore< SSE41Byte >(args);
+	}
+}
+
+#endif
@@ -2,8 +2,8 @@
 
 namespace graphite
 {
-	ReferenceGraph::ReferenceGraph(IReference::SharedPtr referencePtr, IVariantList::SharedPtr variantListPtr, Region::SharedPtr regionPtr, int matchValue, int misMatchValue, int gapOpenValue, int gapExtensionValue, uint32_t numGraphCopies) :
-		GSSWGraph(referencePtr, variantListPtr, regionPtr, matchValue, misMatchValue, gapOpenValue, gapExtensionValue, numGraphCopies)
+	ReferenceGraph::ReferenceGraph(IReference::SharedPtr referencePtr, IVariantList::SharedPtr variantListPtr, Region::SharedPtr regionPtr, int matchValue, int misMatchValue, int gapOpenValue, int gapExtensionValue, uint32_t numGraphCopies, bool useSWKernels) :
+		GSSWGraph(referencePtr, variantListPtr, regionPtr, matchValue, misMatchValue, gapOpenValue, gapExtensionValue, numGraphCopies, useSWKernels)
 	{
 	}
 
@@ -16,7 +16,7 @@ namespace graphite
 	public:
 		typedef std::shared_ptr< ReferenceGraph > SharedPtr;
 
-	    ReferenceGraph(IReference::SharedPtr referencePtr, IVariantList::SharedPtr variantListPtr, Region::SharedPtr regionPtr, int matchValue, int misMatchValue, int gapOpenValue, int gapExtensionValue, uint32_t numGraphCopies);
+	    ReferenceGraph(IReference::SharedPtr referencePtr, IVariantList::SharedPtr variantListPtr, Region::SharedPtr regionPtr, int matchValue, int misMatchValue, int gapOpenValue, int gapExtensionValue, uint32_t numGraphCopies, bool useSWKernels = false);
 		virtual ~ReferenceGraph();
 
 		/* GSSWGraph::GSSWGraphMappingPtr traceBackAlignment(IAlignment::SharedPtr alignmentPtr); */
@@ -89,29 +89,9 @@ namespace graphite
 
 	void GSSWMapping::setMapped(bool mapped)
 	{
-		if (!mapped)
-		{
-			this->m_allele_incrementor_callback_list.clear();
-		}
 		this->m_mapped = mapped;
 	}
 
-	void GSSWMapping::incrementAlleleCounts()
-	{
-		if (m_mapped)
-		{
-			for (auto incrementFunct : this->m_allele_incrementor_callback_list)
-			{
-				incrementFunct();
-			}
-		}
-	}
-
-	void GSSWMapping::addAlleleCountCallback(std::function< void () > functor)
-	{
-		this->m_allele_incrementor_callback_list.emplace_back(functor);
-	}
-
 	void GSSWMapping::printSimpleMapping()
 	{
 		gssw_node_cigar* nc = this->m_gssw_mapping_ptr->cigar.elements;
@@ -22,10 +22,8 @@ namespace graphite
 		std::vector< IAllele::SharedPtr > getAllelePtrs() override;
 		position getPosition() override { return m_position; }
 		std::vector< MappingAlignmentInfo::SharedPtr > getMappingAlignmentInfoPtrs(IAdjudicator::SharedPtr adjudicatorPtr);
-		void incrementAlleleCounts() override;
 		void setMapped(bool mapped) override;
 		bool getMapped() override { return m_mapped; }
-		void addAlleleCountCallback(std::function< void () > functor) override;
 
 		void printMapping() override;
 		void printSimpleMapping();
@@ -37,7 +35,6 @@ namespace graphite
 		std::unordered_map< IAllele*, gssw_node* > m_allele_gssw_nodes_map;
 		IAlignment::SharedPtr m_alignment_ptr;
 		position m_position;
-		std::vector< std::function< void () > > m_allele_incrementor_callback_list;
 		bool m_mapped;
 	};
 
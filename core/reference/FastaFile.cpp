@@ -0,0 +1,212 @@
+#include "FastaFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace graphite
+{
+	FastaFile::FastaFile(const std::string& path, uint32_t maxCachedContigs) :
+		m_path(path),
+		m_data(nullptr),
+		m_data_size(0),
+		m_max_cached_contigs((maxCachedContigs > 0) ? maxCachedContigs : 1)
+	{
+		int fileDescriptor = open(path.c_str(), O_RDONLY);
+		struct stat fileStat;
+		if (fileDescriptor < 0 || fstat(fileDescriptor, &fileStat) != 0)
+		{
+			if (fileDescriptor >= 0) { close(fileDescriptor); }
+			throw std::runtime_error("Unable to open fasta file: " + this->m_path);
+		}
+		this->m_data_size = fileStat.st_size;
+		if (this->m_data_size > 0)
+		{
+			void* data = mmap(nullptr, this->m_data_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+			if (data == MAP_FAILED)
+			{
+				close(fileDescriptor);
+				throw std::runtime_error("Unable to map fasta file: " + this->m_path);
+			}
+			this->m_data = (const char*)data;
+		}
+		close(fileDescriptor); // the mapping stays valid without the descriptor
+		loadIndex();
+	}
+
+	FastaFile::~FastaFile()
+	{
+		if (this->m_data != nullptr)
+		{
+			munmap((void*)this->m_data, this->m_data_size);
+		}
+	}
+
+	bool FastaFile::hasContig(const std::string& contigName)
+	{
+		return this->m_index.find(contigName) != this->m_index.end();
+	}
+
+	size_t FastaFile::getContigLength(const std::string& contigName)
+	{
+		return getIndexEntry(contigName).length;
+	}
+
+	const FastaFile::IndexEntry& FastaFile::getIndexEntry(const std::string& contigName)
+	{
+		auto indexIter = this->m_index.find(contigName);
+		if (indexIter == this->m_index.end())
+		{
+			throw std::runtime_error("Contig not found in fasta file: " + contigName);
+		}
+		return indexIter->second;
+	}
+
+	FastaFile::Contig::SharedPtr FastaFile::getContig(const std::string& contigName)
+	{
+		auto& indexEntry = getIndexEntry(contigName);
+		std::lock_guard< std::mutex > lock(this->m_cached_contigs_mutex);
+		for (auto iter = this->m_cached_contigs.begin(); iter != this->m_cached_contigs.end(); ++iter)
+		{
+			if (iter->first == contigName)
+			{
+				this->m_cached_contigs.splice(this->m_cached_contigs.begin(), this->m_cached_contigs, iter);
+				return iter->second;
+			}
+		}
+		auto& loadedContigPtr = this->m_loaded_contigs[contigName];
+		auto contigPtr = loadedContigPtr.lock(); // pushed out of the cache but a reference still holds it
+		if (contigPtr == nullptr)
+		{
+			contigPtr = loadContig(indexEntry, 0, indexEntry.length);
+			loadedContigPtr = contigPtr;
+		}
+		this->m_cached_contigs.emplace_front(contigName, contigPtr);
+		if (this->m_cached_contigs.size() > this->m_max_cached_contigs)
+		{
+			this->m_cached_contigs.pop_back(); // references still holding the contig keep it alive
+		}
+		return contigPtr;
+	}
+
+	FastaFile::Contig::SharedPtr FastaFile::getContig(const std::string& contigName, size_t startPosition, size_t length)
+	{
+		return loadContig(getIndexEntry(contigName), startPosition, length);
+	}
+
+	void FastaFile::loadIndex()
+	{
+		std::ifstream indexStream(this->m_path + ".fai");
+		if (!indexStream.is_open())
+		{
+			buildIndex();
+			return;
+		}
+		// name, length, offset, bases per line and bytes per line
+		std::string line;
+		while (std::getline(indexStream, line))
+		{
+			size_t nameEnd = line.find('\t');
+			if (nameEnd == std::string::npos) { continue; }
+			size_t fields[4];
+			const char* field = line.c_str() + nameEnd + 1;
+			for (auto& value : fields)
+			{
+				char* fieldEnd = nullptr;
+				value = strtoull(field, &fieldEnd, 10);
+				if (fieldEnd == field)
+				{
+					throw std::runtime_error("The fasta index is missing columns: " + this->m_path + ".fai");
+				}
+				field = fieldEnd;
+			}
+			IndexEntry indexEntry;
+			indexEntry.length = fields[0];
+			indexEntry.offset = fields[1];
+			indexEntry.lineBases = fields[2];
+			indexEntry.lineWidth = fields[3];
+			size_t byteCount = (indexEntry.lineBases > 0) ? ((indexEntry.length / indexEntry.lineBases) * indexEntry.lineWidth) + (indexEntry.length % indexEntry.lineBases) : 0;
+			if ((indexEntry.lineBases == 0 && indexEntry.length > 0) || indexEntry.lineWidth < indexEntry.lineBases || indexEntry.offset + byteCount > this->m_data_size)
+			{
+				throw std::runtime_error("The fasta index doesn't match the fasta file: " + this->m_path);
+			}
+			this->m_index[line.substr(0, nameEnd)] = indexEntry;
+		}
+	}
+
+	void FastaFile::buildIndex()
+	{
+		const char* data = this->m_data;
+		const char* end = this->m_data + this->m_data_size;
+		std::string contigName;
+		IndexEntry* indexEntryPtr = nullptr;
+		bool hasShortLine = false; // only a contig's last line can be shorter than the others, as with samtools faidx
+		while (data < end)
+		{
+			const char* lineEnd = (const char*)memchr(data, '\n', end - data);
+			if (lineEnd == nullptr) { lineEnd = end; }
+			if (*data == '>')
+			{
+				const char* nameEnd = data + 1;
+				while (nameEnd < lineEnd && !isspace(*nameEnd)) { ++nameEnd; }
+				contigName.assign(data + 1, nameEnd);
+				indexEntryPtr = &this->m_index[contigName];
+				indexEntryPtr->length = 0;
+				indexEntryPtr->offset = (lineEnd < end) ? (lineEnd + 1) - this->m_data : this->m_data_size;
+				indexEntryPtr->lineBases = 0;
+				indexEntryPtr->lineWidth = 0;
+				hasShortLine = false;
+			}
+			else if (indexEntryPtr != nullptr)
+			{
+				size_t lineBytes = lineEnd - data;
+				size_t lineLength = lineBytes;
+				if (lineLength > 0 && data[lineLength - 1] == '\r') { --lineLength; }
+				if (lineLength > 0 && (hasShortLine || (indexEntryPtr->lineBases > 0 && lineLength > indexEntryPtr->lineBases)))
+				{
+					throw std::runtime_error("The lines of " + contigName + " aren't all the same length in " + this->m_path);
+				}
+				if (indexEntryPtr->length == 0)
+				{
+					indexEntryPtr->lineBases = lineLength;
+					indexEntryPtr->lineWidth = lineBytes + 1;
+				}
+				hasShortLine = (lineLength < indexEntryPtr->lineBases || lineLength == 0);
+				indexEntryPtr->length += lineLength;
+			}
+			data = lineEnd + 1;
+		}
+	}
+
+	FastaFile::Contig::SharedPtr FastaFile::loadContig(const IndexEntry& indexEntry, size_t startPosition, size_t length)
+	{
+		startPosition = std::min(startPosition, indexEntry.length);
+		length = std::min(length, indexEntry.length - startPosition);
+		const char* data = this->m_data + indexEntry.offset;
+		if (length == 0 || indexEntry.length <= indexEntry.lineBases)
+		{
+			return std::make_shared< Contig >(data + startPosition, length); // on one line, so the bases are used where they are
+		}
+		// the line breaks are stepped over by position, only the requested bases are read
+		std::unique_ptr< char[] > bases(new char[length + 1]);
+		size_t baseCount = 0;
+		while (baseCount < length)
+		{
+			size_t basePosition = startPosition + baseCount;
+			size_t lineOffset = basePosition % indexEntry.lineBases;
+			size_t lineLength = std::min(indexEntry.lineBases - lineOffset, length - baseCount);
+			memcpy(bases.get() + baseCount, data + ((basePosition / indexEntry.lineBases) * indexEntry.lineWidth) + lineOffset, lineLength);
+			baseCount += lineLength;
+		}
+		bases[length] = '\0';
+		return std::make_shared< Contig >(std::move(bases), length);
+	}
+}
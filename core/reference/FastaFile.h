@@ -0,0 +1,91 @@
+#ifndef GRAPHITE_FASTAFILE_H
+#define GRAPHITE_FASTAFILE_H
+
+#include "core/util/Noncopyable.hpp"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace graphite
+{
+	/*
+	 * A FASTA file mapped into memory and looked up through its .fai index,
+	 * the index is built by scanning the file when there isn't one. Only a
+	 * contig written on a single line is handed out as a pointer into the
+	 * mapping. A contig that wraps over several lines, and any slice of one,
+	 * is a copy with the line breaks stripped, since the references that use
+	 * it read their bases as one run. The .fai's bases and bytes per line
+	 * locate any base without walking the lines, so a slice only copies its
+	 * own bases.
+	 *
+	 * A whole contig is loaded once while anything still holds it, so the
+	 * regions of a contig and every reference made for them share one copy.
+	 * The last maxCachedContigs loaded are also kept after they are let go
+	 * for regions that come back to them.
+	 *
+	 * Contigs point into the mapping so they are only valid as long as the
+	 * FastaFile is.
+	 */
+	class FastaFile : private Noncopyable
+	{
+	public:
+		typedef std::shared_ptr< FastaFile > SharedPtr;
+
+		class Contig : private Noncopyable
+		{
+		public:
+			typedef std::shared_ptr< Contig > SharedPtr;
+
+			Contig(const char* sequence, size_t length) : m_sequence(sequence), m_length(length) {}
+			Contig(std::unique_ptr< char[] > bases, size_t length) : m_bases(std::move(bases)), m_sequence(m_bases.get()), m_length(length) {}
+			~Contig() {}
+
+			const char* getSequence() { return m_sequence; }
+			size_t getLength() { return m_length; }
+			bool isMapped() { return m_bases == nullptr; }
+
+		private:
+			std::unique_ptr< char[] > m_bases; // only set when the contig's lines had to be joined
+			const char* m_sequence;
+			size_t m_length;
+		};
+
+		FastaFile(const std::string& path, uint32_t maxCachedContigs = 1);
+		~FastaFile();
+
+		bool hasContig(const std::string& contigName);
+		size_t getContigLength(const std::string& contigName);
+		Contig::SharedPtr getContig(const std::string& contigName);
+		// length bases from the zero based startPosition, cut short at the end of the contig, slices aren't cached
+		Contig::SharedPtr getContig(const std::string& contigName, size_t startPosition, size_t length);
+		std::string getPath() { return m_path; }
+
+	private:
+		struct IndexEntry
+		{
+			size_t length;
+			size_t offset;
+			size_t lineBases;
+			size_t lineWidth; // lineBases and the line break
+		};
+
+		const IndexEntry& getIndexEntry(const std::string& contigName);
+		void loadIndex();
+		void buildIndex();
+		Contig::SharedPtr loadContig(const IndexEntry& indexEntry, size_t startPosition, size_t length);
+
+		std::string m_path;
+		const char* m_data;
+		size_t m_data_size;
+		std::unordered_map< std::string, IndexEntry > m_index;
+		uint32_t m_max_cached_contigs;
+		std::list< std::pair< std::string, Contig::SharedPtr > > m_cached_contigs; // most recently used first
+		std::unordered_map< std::string, std::weak_ptr< Contig > > m_loaded_contigs; // every whole contig that is still held
+		std::mutex m_cached_contigs_mutex;
+	};
+}
+
+#endif //GRAPHITE_FASTAFILE_H
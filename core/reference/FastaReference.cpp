@@ -1,15 +1,20 @@
 #include "FastaReference.h"
 
+#include <algorithm>
+
 
 namespace graphite
 {
 
 	FastaReference::FastaReference(const std::string& path, Region::SharedPtr region) :
-		m_fasta_path(path),
+		FastaReference(std::make_shared< FastaFile >(path), region)
+	{
+	}
+
+	FastaReference::FastaReference(FastaFile::SharedPtr fastaFilePtr, Region::SharedPtr region) :
+		m_fasta_file_ptr(fastaFilePtr),
 		IReference()
 	{
-		m_fasta_reference = std::make_shared< ::FastaReference >();
-		m_fasta_reference->open(this->m_fasta_path);
 		setSequence(region);
 	}
 
@@ -19,35 +24,42 @@ namespace graphite
 
 	void FastaReference::setSequence(Region::SharedPtr regionPtr)
 	{
-		std::string seqName = regionPtr->getReferenceID();
-		this->m_sequence = this->m_fasta_reference->getSequence(seqName);
-
-		this->m_region = std::make_shared< Region >(seqName, Region::BASED::ONE);
-		this->m_region->setBased(Region::BASED::ZERO);
-		this->m_region->setStartPosition(0);
-		this->m_region->setEndPosition(this->m_region->getStartPosition() + this->m_sequence.size());
+		static const size_t s_slice_padding = 100000; // room for the reads and variant regions around the region's edges
 
-		/*
-		if (this->m_region->getStartPosition() == 0 || this->m_region->getEndPosition() == 0)
+		std::string seqName = regionPtr->getReferenceID();
+		size_t contigLength = this->m_fasta_file_ptr->getContigLength(seqName);
+		size_t sliceStartPosition = 0;
+		size_t sliceEndPosition = contigLength;
+		if (regionPtr->getEndPosition() != MAX_POSITION)
 		{
-			this->m_sequence = this->m_fasta_reference->getSequence(seqName);
-			this->m_region->setStartPosition(0);
-			this->m_region->setEndPosition(this->m_region->getStartPosition() + this->m_sequence.size());
+			size_t regionStartPosition = (regionPtr->getBased() == Region::BASED::ONE && regionPtr->getStartPosition() > 0) ? regionPtr->getStartPosition() - 1 : regionPtr->getStartPosition();
+			sliceStartPosition = (regionStartPosition > s_slice_padding) ? regionStartPosition - s_slice_padding : 0;
+			sliceEndPosition = std::min< size_t >(contigLength, (size_t)regionPtr->getEndPosition() + 1 + s_slice_padding);
+			sliceStartPosition = std::min(sliceStartPosition, sliceEndPosition);
+		}
+		if (sliceStartPosition == 0 && sliceEndPosition == contigLength)
+		{
+			this->m_contig_ptr = this->m_fasta_file_ptr->getContig(seqName);
 		}
 		else
 		{
-			if (regionPtr->getBased() == Region::BASED::ONE) // fastahack is one based so we just provide the start position as is, length we must add one because of math!
-			{
-				this->m_sequence = this->m_fasta_reference->getSubSequence(seqName, this->m_region->getStartPosition(), (this->m_region->getEndPosition() - this->m_region->getStartPosition()) + 1);
-				this->m_region->setStartPosition(this->m_region->getStartPosition() - 1);
-				this->m_region->setEndPosition(this->m_region->getEndPosition() - 1);
-			}
-			else
-			{
-				this->m_sequence = this->m_fasta_reference->getSubSequence(seqName, this->m_region->getStartPosition() + 1, (this->m_region->getEndPosition() - this->m_region->getStartPosition()) + 1);
-			}
+			this->m_contig_ptr = this->m_fasta_file_ptr->getContig(seqName, sliceStartPosition, sliceEndPosition - sliceStartPosition);
+		}
+
+		this->m_region = std::make_shared< Region >(seqName, sliceStartPosition, sliceStartPosition + this->m_contig_ptr->getLength(), Region::BASED::ZERO);
+	}
+
+	std::string FastaReference::getSequenceFromRegion(Region::SharedPtr regionPtr)
+	{
+		// zero based with an exclusive end
+		position startPosition = (regionPtr->getBased() == Region::BASED::ONE) ? regionPtr->getStartPosition() - 1 : regionPtr->getStartPosition();
+		position endPosition = regionPtr->getEndPosition();
+		if (this->m_region->getStartPosition() <= startPosition && endPosition <= this->m_region->getEndPosition())
+		{
+			return IReference::getSequenceFromRegion(regionPtr);
 		}
-		*/
+		auto contigPtr = this->m_fasta_file_ptr->getContig(regionPtr->getReferenceID(), startPosition, endPosition - startPosition);
+		return std::string(contigPtr->getSequence(), contigPtr->getLength());
 	}
 
 } // end namespace graphite
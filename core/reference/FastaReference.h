@@ -2,11 +2,10 @@
 #define GRAPHITE_FASTA_REFERENCE_H
 
 #include "IReference.h"
+#include "FastaFile.h"
 
 #include "core/region/Region.h"
-#include "Fasta.h"
 
-#include <map>
 #include <memory>
 
 namespace graphite
@@ -15,16 +14,24 @@ namespace graphite
 	{
 	public:
 		FastaReference(const std::string& path, Region::SharedPtr region);
+		/*
+		 * Shares fastaFilePtr's mapping and recently used contigs with the other
+		 * references made from it. A region with an end holds only its slice of
+		 * the contig, padded to either side, the sequence of a region outside of
+		 * the slice is read from the file.
+		 */
+		FastaReference(FastaFile::SharedPtr fastaFilePtr, Region::SharedPtr region);
 		~FastaReference();
 
-		const char* getSequence() override { return m_sequence.c_str(); }
-		size_t getSequenceSize() override { return m_sequence.size();  }
+		const char* getSequence() override { return m_contig_ptr->getSequence(); }
+		size_t getSequenceSize() override { return m_contig_ptr->getLength();  }
+		std::string getSequenceFromRegion(Region::SharedPtr regionPtr) override;
 
 	private:
 		void setSequence(Region::SharedPtr region);
 
-		std::string m_fasta_path;
-		std::shared_ptr< ::FastaReference > m_fasta_reference;
+		FastaFile::SharedPtr m_fasta_file_ptr;
+		FastaFile::Contig::SharedPtr m_contig_ptr;
 
 	};
 } // end namespace graphite
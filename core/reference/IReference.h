@@ -19,8 +19,8 @@ namespace graphite
 	    IReference(){}
 		virtual ~IReference() {}
 
-		virtual const char* getSequence() { m_sequence.c_str(); }
-		virtual size_t getSequenceSize(){ m_sequence.size(); }
+		virtual const char* getSequence() { return m_sequence.c_str(); }
+		virtual size_t getSequenceSize(){ return m_sequence.size(); }
 		virtual std::string getSequenceFromRegion(Region::SharedPtr regionPtr)
 		{
 			uint64_t sequenceLength = regionPtr->getEndPosition() - regionPtr->getStartPosition();
@@ -30,7 +30,7 @@ namespace graphite
 				startPosition -= 1;;
 				sequenceLength += 1;
 			}
-			std::string sequence = std::string(this->m_sequence.c_str() + startPosition, sequenceLength);
+			std::string sequence = std::string(getSequence() + startPosition, sequenceLength);
 			return sequence;
 		}
 
@@ -1,11 +1,13 @@
 #include "Sample.h"
+#include "SampleManager.h"
 
 namespace graphite
 {
 	Sample::Sample(const std::string& sampleName, const std::string& readGroup, const std::string& samplePath) :
 		m_sample_name(sampleName),
 		m_sample_readgroup(readGroup),
-		m_sample_path(samplePath)
+		m_sample_path(samplePath),
+		m_sample_index(SampleManager::RegisterSampleName(sampleName))
 	{
 	}
 
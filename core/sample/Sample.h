@@ -20,11 +20,13 @@ namespace graphite
 		std::string getName();
 		std::string getReadgroup();
 		std::string getPath();
+		uint32_t getIndex() { return m_sample_index; }
 
 	private:
 		std::string m_sample_name;
 		std::string m_sample_readgroup;
 		std::string m_sample_path;
+		uint32_t m_sample_index;
 	};
 }
 
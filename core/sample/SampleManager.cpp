@@ -2,6 +2,10 @@
 
 namespace graphite
 {
+	std::mutex SampleManager::s_sample_indices_lock;
+	std::unordered_map< std::string, uint32_t > SampleManager::s_sample_indices;
+	std::atomic< uint32_t > SampleManager::s_sample_index_count(0);
+
 	SampleManager::SampleManager(const std::vector< Sample::SharedPtr >& samplePtrs)
 	{
 		for (auto samplePtr : samplePtrs)
@@ -46,4 +50,35 @@ namespace graphite
 		}
 		return samplePtrs;
 	}
+
+	uint32_t SampleManager::RegisterSampleName(const std::string& sampleName)
+	{
+		std::lock_guard< std::mutex > lock(s_sample_indices_lock);
+		auto iter = s_sample_indices.find(sampleName);
+		if (iter != s_sample_indices.end())
+		{
+			return iter->second;
+		}
+		uint32_t sampleIndex = s_sample_indices.size();
+		s_sample_indices.emplace(sampleName, sampleIndex);
+		s_sample_index_count.store(sampleIndex + 1);
+		return sampleIndex;
+	}
+
+	bool SampleManager::GetSampleIndex(const std::string& sampleName, uint32_t& sampleIndex)
+	{
+		std::lock_guard< std::mutex > lock(s_sample_indices_lock);
+		auto iter = s_sample_indices.find(sampleName);
+		if (iter == s_sample_indices.end())
+		{
+			return false;
+		}
+		sampleIndex = iter->second;
+		return true;
+	}
+
+	uint32_t SampleManager::GetSampleIndexCount()
+	{
+		return s_sample_index_count.load();
+	}
 }
@@ -4,6 +4,7 @@
 #include "Sample.h"
 #include "core/util/Noncopyable.hpp"
 
+#include <atomic>
 #include <unordered_map>
 #include <mutex>
 #include <memory>
@@ -23,9 +24,22 @@ namespace graphite
 		uint32_t getSampleCount();
 		std::vector< Sample::SharedPtr > getSamplePtrs();
 
+		/*
+		 * Every distinct sample name gets a dense index the first time it is
+		 * seen, which alleles use to lay out their per sample counts. The
+		 * indices are process wide so they stay the same across managers.
+		 */
+		static uint32_t RegisterSampleName(const std::string& sampleName);
+		static bool GetSampleIndex(const std::string& sampleName, uint32_t& sampleIndex);
+		static uint32_t GetSampleIndexCount();
+
 	private:
 		std::mutex m_sample_ptrs_lock;
 		std::unordered_map< std::string, Sample::SharedPtr > m_sample_ptrs_map;
+
+		static std::mutex s_sample_indices_lock;
+		static std::unordered_map< std::string, uint32_t > s_sample_indices;
+		static std::atomic< uint32_t > s_sample_index_count;
 	};
 }
 
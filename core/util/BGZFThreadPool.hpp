@@ -0,0 +1,92 @@
+#ifndef GRAPHITE_BGZFTHREADPOOL_HPP
+#define GRAPHITE_BGZFTHREADPOOL_HPP
+
+#include "core/util/Noncopyable.hpp"
+
+#include "htslib/hts.h"
+#include "htslib/thread_pool.h"
+
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace graphite
+{
+	/*
+	 * One htslib thread pool shared by every BGZF stream, the BAM readers and
+	 * the bgzipped VCF readers. Each stream keeps its own queue of blocks that
+	 * the workers inflate ahead of the reader and hand back in file order, so
+	 * a single reader is no longer limited to one core of decompression.
+	 * Inflating keeps up with alignment on a few threads, so the pool gets a
+	 * small share of the thread count and the rest stay with the ThreadPool.
+	 */
+	class BGZFThreadPool : private Noncopyable
+	{
+	public:
+		static BGZFThreadPool* Instance()
+		{
+			static BGZFThreadPool* s_bgzf_thread_pool = new BGZFThreadPool(); // lazy initialization
+			return s_bgzf_thread_pool;
+		}
+
+		// the pool's share of threadCount, a quarter of it between 1 and s_max_thread_count
+		static uint32_t GetThreadShare(uint32_t threadCount)
+		{
+			uint32_t threadShare = threadCount / 4;
+			if (threadShare > s_max_thread_count) { return s_max_thread_count; }
+			return (threadShare > 0) ? threadShare : 1;
+		}
+
+		// the pool's workers are started on first use and can't be resized afterwards
+		void setThreadCount(uint32_t threadCount)
+		{
+			std::lock_guard< std::mutex > lock(this->m_mutex);
+			if (this->m_thread_pool.pool != nullptr)
+			{
+				throw std::runtime_error("BGZFThreadPool::setThreadCount called after the pool was started");
+			}
+			this->m_thread_count = (threadCount > 0) ? threadCount : 1;
+		}
+
+		uint32_t getThreadCount()
+		{
+			std::lock_guard< std::mutex > lock(this->m_mutex);
+			return this->m_thread_count;
+		}
+
+		htsThreadPool* getThreadPool()
+		{
+			std::lock_guard< std::mutex > lock(this->m_mutex);
+			if (this->m_thread_pool.pool == nullptr)
+			{
+				this->m_thread_pool.pool = hts_tpool_init(this->m_thread_count);
+				this->m_thread_pool.qsize = this->m_thread_count * 2;
+			}
+			return &this->m_thread_pool;
+		}
+
+	private:
+		BGZFThreadPool() :
+			m_thread_count(GetThreadShare(std::thread::hardware_concurrency()))
+		{
+			this->m_thread_pool.pool = nullptr;
+			this->m_thread_pool.qsize = 0;
+		}
+
+		~BGZFThreadPool()
+		{
+			if (this->m_thread_pool.pool != nullptr)
+			{
+				hts_tpool_destroy(this->m_thread_pool.pool);
+			}
+		}
+
+		static const uint32_t s_max_thread_count = 4;
+
+		std::mutex m_mutex;
+		uint32_t m_thread_count;
+		htsThreadPool m_thread_pool;
+	};
+}
+
+#endif //GRAPHITE_BGZFTHREADPOOL_HPP
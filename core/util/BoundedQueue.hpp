@@ -0,0 +1,80 @@
+#ifndef GRAPHITE_BOUNDEDQUEUE_HPP
+#define GRAPHITE_BOUNDEDQUEUE_HPP
+
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+
+#include "core/util/Noncopyable.hpp"
+
+namespace graphite
+{
+	/*
+	 * A blocking fixed capacity queue used to hand work between pipeline stages.
+	 * push blocks while the queue is full and pop blocks while it is empty,
+	 * once the queue is closed pop drains what is left and then returns false.
+	 * pop lets go of the caller's last item before it waits so a stage never
+	 * holds finished work, or the memory reserved for it, while it is idle.
+	 */
+	template < typename T >
+	class BoundedQueue : private Noncopyable
+	{
+	public:
+		BoundedQueue(size_t capacity) :
+			m_capacity((capacity > 0) ? capacity : 1),
+			m_closed(false)
+		{
+		}
+
+		~BoundedQueue()
+		{
+		}
+
+		// returns false if the queue was closed before the item could be added
+		bool push(const T& item)
+		{
+			{
+				std::unique_lock< std::mutex > lock(this->m_mutex);
+				this->m_not_full_condition.wait(lock, [this]{ return this->m_closed || this->m_items.size() < this->m_capacity; });
+				if (this->m_closed) { return false; }
+				this->m_items.push(item);
+			}
+			this->m_not_empty_condition.notify_one();
+			return true;
+		}
+
+		bool pop(T& item)
+		{
+			item = T();
+			{
+				std::unique_lock< std::mutex > lock(this->m_mutex);
+				this->m_not_empty_condition.wait(lock, [this]{ return this->m_closed || !this->m_items.empty(); });
+				if (this->m_items.empty()) { return false; }
+				item = this->m_items.front();
+				this->m_items.pop();
+			}
+			this->m_not_full_condition.notify_one();
+			return true;
+		}
+
+		void close()
+		{
+			{
+				std::unique_lock< std::mutex > lock(this->m_mutex);
+				this->m_closed = true;
+			}
+			this->m_not_empty_condition.notify_all();
+			this->m_not_full_condition.notify_all();
+		}
+
+	private:
+		std::queue< T > m_items;
+		size_t m_capacity;
+		bool m_closed;
+		std::mutex m_mutex;
+		std::condition_variable m_not_empty_condition;
+		std::condition_variable m_not_full_condition;
+	};
+}
+
+#endif //GRAPHITE_BOUNDEDQUEUE_HPP
@@ -0,0 +1,90 @@
+#ifndef GRAPHITE_FIELDSPLITTER_HPP
+#define GRAPHITE_FIELDSPLITTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace graphite
+{
+	/*
+	 * Finds the end of each of the first maxFields delimited fields of text
+	 * without copying anything. fieldEnds[i] is the offset of the delimiter
+	 * that ends field i, or length for the last field, so field i spans
+	 * [(i == 0) ? 0 : fieldEnds[i - 1] + 1, fieldEnds[i]). Returns the number
+	 * of fields found. The delimiters are found 16 bytes at a time so a VCF
+	 * line is split in one pass.
+	 */
+	inline size_t SplitFields(const char* text, size_t length, char delimiter, uint32_t* fieldEnds, size_t maxFields)
+	{
+		size_t fieldCount = 0;
+		if (maxFields == 0)
+		{
+			return fieldCount;
+		}
+		size_t i = 0;
+#if defined(__SSE2__)
+		const __m128i delimiters = _mm_set1_epi8(delimiter);
+		for (; i + 16 <= length; i += 16)
+		{
+			uint32_t delimiterMask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(text + i)), delimiters));
+			while (delimiterMask != 0)
+			{
+				fieldEnds[fieldCount++] = i + __builtin_ctz(delimiterMask);
+				if (fieldCount == maxFields)
+				{
+					return fieldCount;
+				}
+				delimiterMask &= delimiterMask - 1;
+			}
+		}
+#endif
+		for (; i < length; ++i)
+		{
+			if (text[i] == delimiter)
+			{
+				fieldEnds[fieldCount++] = i;
+				if (fieldCount == maxFields)
+				{
+					return fieldCount;
+				}
+			}
+		}
+		fieldEnds[fieldCount++] = length;
+		return fieldCount;
+	}
+
+	/*
+	 * Finds the value of key in a list of key=value entries, such as a VCF
+	 * INFO field, without splitting the list. Returns false if the key isn't
+	 * there, flags without a value are skipped.
+	 */
+	inline bool FindKeyValue(const char* text, size_t length, char delimiter, const char* key, const char*& value, size_t& valueLength)
+	{
+		size_t keyLength = strlen(key);
+		const char* end = text + length;
+		const char* entry = text;
+		while (entry < end)
+		{
+			const char* entryEnd = (const char*)memchr(entry, delimiter, end - entry);
+			if (entryEnd == nullptr)
+			{
+				entryEnd = end;
+			}
+			if ((size_t)(entryEnd - entry) > keyLength && entry[keyLength] == '=' && memcmp(entry, key, keyLength) == 0)
+			{
+				value = entry + keyLength + 1;
+				valueLength = entryEnd - value;
+				return true;
+			}
+			entry = entryEnd + 1;
+		}
+		return false;
+	}
+}
+
+#endif //GRAPHITE_FIELDSPLITTER_HPP
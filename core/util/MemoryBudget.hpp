@@ -0,0 +1,147 @@
+#ifndef GRAPHITE_MEMORYBUDGET_HPP
+#define GRAPHITE_MEMORYBUDGET_HPP
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+#include "core/util/Noncopyable.hpp"
+
+namespace graphite
+{
+	/*
+	 * Tracks an approximate number of bytes held by the work in flight. reserve
+	 * blocks until the bytes fit under the limit and hands back a Reservation
+	 * that gives them back when it is destroyed. A request larger than the
+	 * whole budget is let through once nothing else is reserved so oversized
+	 * work still makes progress, one item at a time. heldBytes are reservations
+	 * the caller already holds, they are not waited on since the caller can't
+	 * release them while it waits. A limit of 0 never blocks.
+	 *
+	 * tryReserve is reserve without the wait, it hands back nullptr when the
+	 * bytes don't fit yet so the caller can ask for less instead. A
+	 * reservation made from an estimate is resized once the real size is
+	 * known and split when parts of it are released at different times.
+	 */
+	class MemoryBudget : private Noncopyable, public std::enable_shared_from_this< MemoryBudget >
+	{
+	public:
+		typedef std::shared_ptr< MemoryBudget > SharedPtr;
+
+		class Reservation : private Noncopyable
+		{
+		public:
+			typedef std::shared_ptr< Reservation > SharedPtr;
+
+			Reservation(MemoryBudget::SharedPtr memoryBudgetPtr, uint64_t bytes) :
+				m_memory_budget_ptr(memoryBudgetPtr),
+				m_bytes(bytes)
+			{
+			}
+
+			~Reservation()
+			{
+				this->m_memory_budget_ptr->release(this->m_bytes);
+			}
+
+			uint64_t getBytes() { return this->m_bytes; }
+
+			// growing waits like reserve, this reservation counts as held
+			void resize(uint64_t bytes, uint64_t heldBytes = 0)
+			{
+				this->m_memory_budget_ptr->resize(this->m_bytes, bytes, heldBytes);
+				this->m_bytes = bytes;
+			}
+
+			// moves bytes into a new reservation, the budget's total is unchanged
+			SharedPtr split(uint64_t bytes)
+			{
+				bytes = std::min(bytes, this->m_bytes);
+				this->m_bytes -= bytes;
+				return std::make_shared< Reservation >(this->m_memory_budget_ptr, bytes);
+			}
+
+		private:
+			MemoryBudget::SharedPtr m_memory_budget_ptr;
+			uint64_t m_bytes;
+		};
+
+		MemoryBudget(uint64_t maxBytes) :
+			m_max_bytes(maxBytes),
+			m_reserved_bytes(0)
+		{
+		}
+
+		~MemoryBudget()
+		{
+		}
+
+		Reservation::SharedPtr reserve(uint64_t bytes, uint64_t heldBytes = 0)
+		{
+			{
+				std::unique_lock< std::mutex > lock(this->m_mutex);
+				this->m_released_condition.wait(lock, [this, bytes, heldBytes]{ return fits(bytes, heldBytes); });
+				this->m_reserved_bytes += bytes;
+			}
+			return std::make_shared< Reservation >(shared_from_this(), bytes);
+		}
+
+		Reservation::SharedPtr tryReserve(uint64_t bytes, uint64_t heldBytes = 0)
+		{
+			{
+				std::lock_guard< std::mutex > lock(this->m_mutex);
+				if (!fits(bytes, heldBytes))
+				{
+					return nullptr;
+				}
+				this->m_reserved_bytes += bytes;
+			}
+			return std::make_shared< Reservation >(shared_from_this(), bytes);
+		}
+
+		bool isBounded() { return this->m_max_bytes > 0; }
+		uint64_t getMaxBytes() { return this->m_max_bytes; }
+
+		uint64_t getReservedBytes()
+		{
+			std::lock_guard< std::mutex > lock(this->m_mutex);
+			return this->m_reserved_bytes;
+		}
+
+	private:
+		// called with m_mutex held
+		bool fits(uint64_t bytes, uint64_t heldBytes)
+		{
+			return this->m_max_bytes == 0 || this->m_reserved_bytes <= heldBytes || this->m_reserved_bytes + bytes <= this->m_max_bytes;
+		}
+
+		void resize(uint64_t fromBytes, uint64_t toBytes, uint64_t heldBytes)
+		{
+			if (toBytes <= fromBytes)
+			{
+				release(fromBytes - toBytes);
+				return;
+			}
+			std::unique_lock< std::mutex > lock(this->m_mutex);
+			this->m_released_condition.wait(lock, [this, fromBytes, toBytes, heldBytes]{ return fits(toBytes - fromBytes, heldBytes + fromBytes); });
+			this->m_reserved_bytes += toBytes - fromBytes;
+		}
+
+		void release(uint64_t bytes)
+		{
+			{
+				std::lock_guard< std::mutex > lock(this->m_mutex);
+				this->m_reserved_bytes -= bytes;
+			}
+			this->m_released_condition.notify_all();
+		}
+
+		uint64_t m_max_bytes;
+		uint64_t m_reserved_bytes;
+		std::mutex m_mutex;
+		std::condition_variable m_released_condition;
+	};
+}
+
+#endif //GRAPHITE_MEMORYBUDGET_HPP
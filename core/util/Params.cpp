@@ -35,7 +35,13 @@ namespace graphite
 			("a,gap_open_value", "Smith-Waterman Gap Open Value [optional - default is 6]", cxxopts::value< uint32_t >()->default_value("6"))
 			("e,gap_extionsion_value", "Smith-Waterman Gap Extension Value [optional - default is 1]", cxxopts::value< uint32_t >()->default_value("1"))
 			("g,graph_size", "The size of the graph [optional - default is 3000]", cxxopts::value< uint32_t >()->default_value("3000"))
-			("t,number_threads", "Thread count [optional - default is number of cores x 2]", cxxopts::value< uint32_t >()->default_value(std::to_string(std::thread::hardware_concurrency() * 2)));
+			("t,number_threads", "Thread count [optional - default is number of cores x 2]", cxxopts::value< uint32_t >()->default_value(std::to_string(std::thread::hardware_concurrency() * 2)))
+			("read_batch_size", "The number of reads aligned to a graph per task, with --sw_kernels they are also scored together in SIMD lanes [optional - default is 64]", cxxopts::value< uint32_t >()->default_value("64"))
+			("max_cluster_span", "The widest span in base pairs of overlapping variant regions adjudicated in one graph, longer clusters are split [optional - default is 0, no limit]", cxxopts::value< uint32_t >()->default_value("0"))
+			("max_memory", "Approximate memory limit in megabytes, contigs are processed in windows sized to fit [optional - default is 0, no limit]", cxxopts::value< uint64_t >()->default_value("0"))
+			("thread_pool_stats", "Print thread pool lock contention and steal counts when finished [optional]")
+			("bamtools", "Read BAMs with BamTools instead of htslib [optional]")
+			("sw_kernels", "Align reads with graphite's striped Smith-Waterman kernels instead of gssw, tracebacks use SSE4.1 and AVX2/AVX-512 only score read batches [optional]");
 		this->m_options.parse(argc, argv);
 	}
 
@@ -139,6 +145,37 @@ namespace graphite
 		return m_options["t"].as< uint32_t >();
 	}
 
+	uint32_t Params::getReadBatchSize()
+	{
+		uint32_t readBatchSize = m_options["read_batch_size"].as< uint32_t >();
+		return (readBatchSize > 0) ? readBatchSize : 1;
+	}
+
+	uint32_t Params::getMaxClusterSpan()
+	{
+		return m_options["max_cluster_span"].as< uint32_t >();
+	}
+
+	uint64_t Params::getMaxMemoryBytes()
+	{
+		return m_options["max_memory"].as< uint64_t >() * 1024 * 1024;
+	}
+
+	bool Params::getPrintThreadPoolStatistics()
+	{
+		return m_options.count("thread_pool_stats");
+	}
+
+	bool Params::getUseBamTools()
+	{
+		return m_options.count("bamtools");
+	}
+
+	bool Params::getUseSWKernels()
+	{
+		return m_options.count("sw_kernels");
+	}
+
 	uint32_t Params::getGraphSize()
 	{
 		return m_options["g"].as< uint32_t >();
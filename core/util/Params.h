@@ -37,6 +37,12 @@ namespace graphite
 		int getGapOpenValue();
 		int getGapExtensionValue();
 		uint32_t getGraphSize();
+		uint32_t getReadBatchSize();
+		uint32_t getMaxClusterSpan();
+		uint64_t getMaxMemoryBytes();
+		bool getPrintThreadPoolStatistics();
+		bool getUseBamTools();
+		bool getUseSWKernels();
 	private:
 		void validateFolderPaths(const std::vector< std::string >& paths, bool exitOnFailure);
 		void validateFilePaths(const std::vector< std::string >& paths, bool exitOnFailure);
@@ -0,0 +1,59 @@
+#ifndef GRAPHITE_SEQUENCECOMPARE_HPP
+#define GRAPHITE_SEQUENCECOMPARE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace graphite
+{
+	/*
+	 * The number of leading bytes a and b have in common, looking at no more
+	 * than length of them. Bytes are compared 16 at a time.
+	 */
+	inline size_t CommonPrefixLength(const char* a, const char* b, size_t length)
+	{
+		size_t i = 0;
+#if defined(__SSE2__)
+		for (; i + 16 <= length; i += 16)
+		{
+			uint32_t mismatchMask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)))) & 0xFFFF;
+			if (mismatchMask != 0)
+			{
+				return i + __builtin_ctz(mismatchMask);
+			}
+		}
+#endif
+		for (; i < length && a[i] == b[i]; ++i) {}
+		return i;
+	}
+
+	/*
+	 * The number of trailing bytes the aLength bytes at a and the bLength
+	 * bytes at b have in common, 16 at a time from the end.
+	 */
+	inline size_t CommonSuffixLength(const char* a, size_t aLength, const char* b, size_t bLength)
+	{
+		size_t length = (aLength < bLength) ? aLength : bLength;
+		const char* aEnd = a + aLength;
+		const char* bEnd = b + bLength;
+		size_t i = 0;
+#if defined(__SSE2__)
+		for (; i + 16 <= length; i += 16)
+		{
+			uint32_t mismatchMask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(aEnd - i - 16)), _mm_loadu_si128((const __m128i*)(bEnd - i - 16)))) & 0xFFFF;
+			if (mismatchMask != 0)
+			{
+				return i + __builtin_clz(mismatchMask) - 16; // the highest mismatching byte is the one closest to the end
+			}
+		}
+#endif
+		for (; i < length && aEnd[-(ptrdiff_t)i - 1] == bEnd[-(ptrdiff_t)i - 1]; ++i) {}
+		return i;
+	}
+}
+
+#endif //GRAPHITE_SEQUENCECOMPARE_HPP
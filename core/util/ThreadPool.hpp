@@ -2,7 +2,8 @@
 #define GRAPHITE_THREADPOOL_HPP
 
 #include <vector>
-#include <queue>
+#include <deque>
+#include <ostream>
 #include <memory>
 #include <thread>
 #include <mutex>
@@ -10,12 +11,20 @@
 #include <future>
 #include <functional>
 #include <stdexcept>
+#include <atomic>
+#include <exception>
 
 #include "core/util/Noncopyable.hpp"
 
 namespace graphite
 {
 
+    /*
+     * A work stealing pool. Every worker owns a deque, tasks enqueued from a worker go on the back
+     * of its own deque and are taken LIFO so nested work stays cache warm, tasks enqueued from
+     * other threads are spread round robin over the deques. An idle worker steals from the front
+     * of the other deques before it goes to sleep.
+     */
     class ThreadPool : private Noncopyable
     {
 	public:
@@ -41,7 +50,7 @@ namespace graphite
 			if (this->m_stopped)
 			{
 				{
-					std::unique_lock<std::mutex> lock(m_tasks_mutex);
+					std::unique_lock<std::mutex> lock(m_sleep_mutex);
 					this->m_stopped = false;
 					this->m_workers.clear();
 				}
@@ -52,7 +61,7 @@ namespace graphite
 		void stop()
 		{
 			{
-				std::unique_lock<std::mutex> lock(m_tasks_mutex);
+				std::unique_lock<std::mutex> lock(m_sleep_mutex);
 				this->m_stopped = true;
 			}
 			this->m_condition.notify_all();
@@ -72,36 +81,159 @@ namespace graphite
 				std::bind(std::forward< F >(funct), std::forward< Args >(args)...)
 				);
 			std::shared_ptr< std::future< return_type > > res = std::make_shared< std::future< return_type > >(task->get_future());
+			enqueueTask([task](){(*task)();});
+			return res;
+		}
+
+		void enqueueTask(std::function< void() > task)
+		{
+			std::vector< std::function< void() > > tasks;
+			tasks.emplace_back(std::move(task));
+			enqueueTasks(tasks);
+		}
+
+		// adds all the tasks taking each deque lock once
+		void enqueueTasks(std::vector< std::function< void() > >& tasks)
+		{
+			if (tasks.empty()) { return; }
+			if (this->m_stopped)
 			{
-				std::unique_lock< std::mutex > lock(this->m_tasks_mutex);
-				if (this->m_stopped)
+				throw std::runtime_error("enqueue on stopped ThreadPool");
+			}
+			this->m_pending_task_count += tasks.size(); // counted before they are visible so the count never drops below zero
+			size_t workerIndex = getWorkerIndex();
+			if (workerIndex != NOT_A_WORKER)
+			{
+				auto& workerQueue = *this->m_worker_queues[workerIndex];
+				lockWorkerQueue(workerQueue);
+				for (auto& task : tasks)
 				{
-					throw std::runtime_error("enqueue on stopped ThreadPool");
+					workerQueue.tasks.emplace_back(std::move(task));
 				}
-				this->m_tasks.emplace([task](){(*task)();});
+				workerQueue.mutex.unlock();
 			}
-			this->m_condition.notify_one();
-			return res;
+			else
+			{
+				size_t queueCount = this->m_worker_queues.size();
+				size_t firstQueueIndex = this->m_next_queue_index.fetch_add(1) % queueCount;
+				size_t tasksPerQueue = (tasks.size() + queueCount - 1) / queueCount;
+				size_t taskIndex = 0;
+				for (size_t i = 0; i < queueCount && taskIndex < tasks.size(); ++i)
+				{
+					auto& workerQueue = *this->m_worker_queues[(firstQueueIndex + i) % queueCount];
+					lockWorkerQueue(workerQueue);
+					for (size_t j = 0; j < tasksPerQueue && taskIndex < tasks.size(); ++j)
+					{
+						workerQueue.tasks.emplace_back(std::move(tasks[taskIndex++]));
+					}
+					workerQueue.mutex.unlock();
+				}
+			}
+
+			if (this->m_sleeping_count > 0)
+			{
+				{
+					std::lock_guard< std::mutex > lock(this->m_sleep_mutex);
+				}
+				if (tasks.size() == 1)
+				{
+					this->m_condition.notify_one();
+				}
+				else
+				{
+					this->m_condition.notify_all();
+				}
+			}
+			notifyWaiters();
 		}
 
+		// runs a single queued task on the calling thread, returns false if there was nothing to run
+		bool runPendingTask()
+		{
+			std::function< void() > task;
+			if (!popTask(getWorkerIndex(), task)) { return false; }
+			task();
+			return true;
+		}
+
+		/*
+		 * Blocks until isDone returns true. While waiting the calling thread runs queued tasks
+		 * so a worker can wait on other tasks without tying up a thread. Whatever makes isDone
+		 * true has to call notifyWaiters afterwards.
+		 */
+		void waitUntil(const std::function< bool() >& isDone)
+		{
+			while (!isDone())
+			{
+				if (runPendingTask()) { continue; }
+				std::unique_lock< std::mutex > lock(this->m_waiting_mutex);
+				++this->m_waiting_count;
+				this->m_waiting_condition.wait(lock, [this, &isDone]{ return isDone() || this->m_pending_task_count > 0; });
+				--this->m_waiting_count;
+			}
+		}
+
+		void notifyWaiters()
+		{
+			if (this->m_waiting_count == 0) { return; }
+			{
+				std::lock_guard< std::mutex > lock(this->m_waiting_mutex);
+			}
+			this->m_waiting_condition.notify_all();
+		}
+
+		/*
+		 * Calls funct(i) for every i in [startIndex, endIndex) and blocks until all calls return.
+		 * The range is split into a few chunks per thread rather than one task per index.
+		 */
+		template< class F >
+		void parallelFor(size_t startIndex, size_t endIndex, F funct);
+
 		void setThreadCount(uint32_t threadCount)
 		{
-			this->m_thread_count = threadCount;
 			stop();
+			this->m_thread_count = threadCount;
 			start();
 		}
 
 		int getTaskCount()
 		{
-			std::unique_lock< std::mutex > lock(this->m_tasks_mutex);
-			return this->m_tasks.size();
+			return this->m_pending_task_count;
+		}
+
+		// the number of times a thread had to block on a deque another thread was holding
+		uint64_t getContentionCount()
+		{
+			return this->m_contention_count;
+		}
+
+		// the number of tasks a worker took from another worker's deque
+		uint64_t getStealCount()
+		{
+			return this->m_steal_count;
+		}
+
+		void printStatistics(std::ostream& out)
+		{
+			out << "threads: " << this->m_thread_count << " lock contentions: " << getContentionCount() << " steals: " << getStealCount() << std::endl;
 		}
 
 	private:
+		struct WorkerQueue
+		{
+			std::mutex mutex;
+			std::deque< std::function< void() > > tasks;
+		};
 
 		ThreadPool() :
+			m_stopped(false),
 			m_thread_count(std::thread::hardware_concurrency() * 2),
-			m_stopped(false)
+			m_pending_task_count(0),
+			m_sleeping_count(0),
+			m_waiting_count(0),
+			m_next_queue_index(0),
+			m_contention_count(0),
+			m_steal_count(0)
 		{
 			init();
 		}
@@ -111,25 +243,94 @@ namespace graphite
 			stop();
 		}
 
+		static const size_t NOT_A_WORKER = static_cast< size_t >(-1);
+
+		// NOT_A_WORKER for threads that are not workers of this pool
+		static size_t& getWorkerIndex()
+		{
+			static thread_local size_t s_worker_index = NOT_A_WORKER;
+			return s_worker_index;
+		}
+
+		void lockWorkerQueue(WorkerQueue& workerQueue)
+		{
+			if (!workerQueue.mutex.try_lock())
+			{
+				++this->m_contention_count;
+				workerQueue.mutex.lock();
+			}
+		}
+
+		bool popTask(size_t workerIndex, std::function< void() >& task)
+		{
+			if (this->m_pending_task_count == 0) { return false; }
+			size_t queueCount = this->m_worker_queues.size();
+			if (workerIndex != NOT_A_WORKER)
+			{
+				auto& workerQueue = *this->m_worker_queues[workerIndex];
+				lockWorkerQueue(workerQueue);
+				if (!workerQueue.tasks.empty())
+				{
+					task = std::move(workerQueue.tasks.back());
+					workerQueue.tasks.pop_back();
+					workerQueue.mutex.unlock();
+					--this->m_pending_task_count;
+					return true;
+				}
+				workerQueue.mutex.unlock();
+			}
+			size_t firstVictimIndex = (workerIndex != NOT_A_WORKER) ? workerIndex + 1 : this->m_next_queue_index.load();
+			for (size_t i = 0; i < queueCount; ++i)
+			{
+				size_t victimIndex = (firstVictimIndex + i) % queueCount;
+				if (victimIndex == workerIndex) { continue; }
+				auto& victimQueue = *this->m_worker_queues[victimIndex];
+				lockWorkerQueue(victimQueue);
+				if (!victimQueue.tasks.empty())
+				{
+					task = std::move(victimQueue.tasks.front());
+					victimQueue.tasks.pop_front();
+					victimQueue.mutex.unlock();
+					--this->m_pending_task_count;
+					if (workerIndex != NOT_A_WORKER) { ++this->m_steal_count; }
+					return true;
+				}
+				victimQueue.mutex.unlock();
+			}
+			return false;
+		}
+
 		void init()
 		{
+			if (this->m_worker_queues.size() != this->m_thread_count)
+			{
+				// only resized while stopped, at that point every deque has been drained
+				this->m_worker_queues.clear();
+				for (size_t i = 0; i < this->m_thread_count; ++i)
+				{
+					this->m_worker_queues.emplace_back(std::unique_ptr< WorkerQueue >(new WorkerQueue()));
+				}
+			}
 			for (size_t i = 0; i < this->m_thread_count; ++i)
 			{
 				this->m_workers.emplace_back(
-					[this]
+					[this, i]
 					{
+						getWorkerIndex() = i;
 						for (;;)
 						{
 							std::function< void() > task;
+							if (popTask(i, task))
 							{
-								std::unique_lock< std::mutex > lock(this->m_tasks_mutex);
-								this->m_condition.wait(lock,
-													   [this]{ return this->m_stopped || !this->m_tasks.empty(); });
-								if (this->m_stopped && this->m_tasks.empty()) { return; }
-								task = std::move(this->m_tasks.front());
-								this->m_tasks.pop();
+								task();
+								continue;
 							}
-							task();
+							std::unique_lock< std::mutex > lock(this->m_sleep_mutex);
+							++this->m_sleeping_count;
+							this->m_condition.wait(lock,
+												   [this]{ return this->m_stopped || this->m_pending_task_count > 0; });
+							--this->m_sleeping_count;
+							if (this->m_stopped && this->m_pending_task_count == 0) { return; }
 						}
 					}
 					);
@@ -138,14 +339,143 @@ namespace graphite
 
 		static ThreadPool* s_threadpool;
 		std::vector< std::thread > m_workers;
-		std::queue< std::function< void() > > m_tasks;
+		std::vector< std::unique_ptr< WorkerQueue > > m_worker_queues;
 
-		std::mutex m_tasks_mutex;
+		std::mutex m_sleep_mutex;
 		std::condition_variable m_condition;
-		bool m_stopped;
+		std::mutex m_waiting_mutex;
+		std::condition_variable m_waiting_condition;
+		std::atomic< bool > m_stopped;
 		uint32_t m_thread_count;
+		std::atomic< size_t > m_pending_task_count;
+		std::atomic< uint32_t > m_sleeping_count;
+		std::atomic< uint32_t > m_waiting_count;
+		std::atomic< size_t > m_next_queue_index;
+		std::atomic< uint64_t > m_contention_count;
+		std::atomic< uint64_t > m_steal_count;
     };
 
+	/*
+	 * A set of tasks on the ThreadPool that can be waited on as a whole. Tasks may add more tasks
+	 * to their own group. join blocks until every task has finished and rethrows the first exception
+	 * thrown by a task. Waiting threads run queued tasks, so joining from a worker is safe.
+	 */
+	class TaskGroup : private Noncopyable
+	{
+	public:
+		typedef std::shared_ptr< TaskGroup > SharedPtr;
+
+		TaskGroup() :
+			m_thread_pool(ThreadPool::Instance()),
+			m_task_count(0)
+		{
+		}
+
+		~TaskGroup()
+		{
+			wait(0);
+		}
+
+		template< class F >
+		void run(F&& funct)
+		{
+			++this->m_task_count;
+			this->m_thread_pool->enqueueTask(wrapTask(std::forward< F >(funct)));
+		}
+
+		// enqueues all the tasks under a single pool lock
+		void runAll(std::vector< std::function< void() > >& functs)
+		{
+			std::vector< std::function< void() > > tasks;
+			tasks.reserve(functs.size());
+			for (auto& funct : functs)
+			{
+				tasks.emplace_back(wrapTask(std::move(funct)));
+			}
+			this->m_task_count += tasks.size();
+			this->m_thread_pool->enqueueTasks(tasks);
+		}
+
+		void join()
+		{
+			wait(0);
+			std::lock_guard< std::mutex > lock(this->m_exception_mutex);
+			if (this->m_exception_ptr)
+			{
+				auto exceptionPtr = this->m_exception_ptr;
+				this->m_exception_ptr = nullptr;
+				std::rethrow_exception(exceptionPtr);
+			}
+		}
+
+		// blocks until fewer than taskCount tasks of this group are unfinished
+		void waitForCapacity(size_t taskCount)
+		{
+			wait((taskCount > 0) ? taskCount - 1 : 0);
+		}
+
+		size_t getTaskCount()
+		{
+			return this->m_task_count;
+		}
+
+	private:
+		template< class F >
+		std::function< void() > wrapTask(F&& funct)
+		{
+			auto task = std::bind(std::forward< F >(funct));
+			return [this, task]() mutable
+			{
+				try
+				{
+					task();
+				}
+				catch (...)
+				{
+					std::lock_guard< std::mutex > lock(this->m_exception_mutex);
+					if (!this->m_exception_ptr) { this->m_exception_ptr = std::current_exception(); }
+				}
+				auto threadPoolPtr = this->m_thread_pool; // the group may be destroyed as soon as the count drops
+				--this->m_task_count;
+				threadPoolPtr->notifyWaiters();
+			};
+		}
+
+		void wait(size_t maxTaskCount)
+		{
+			this->m_thread_pool->waitUntil([this, maxTaskCount]{ return this->m_task_count <= maxTaskCount; });
+		}
+
+		ThreadPool* m_thread_pool;
+		std::atomic< size_t > m_task_count;
+		std::mutex m_exception_mutex;
+		std::exception_ptr m_exception_ptr;
+	};
+
+	template< class F >
+	void ThreadPool::parallelFor(size_t startIndex, size_t endIndex, F funct)
+	{
+		if (endIndex <= startIndex) { return; }
+		size_t count = endIndex - startIndex;
+		size_t chunkCount = (count < this->m_thread_count * 4) ? count : this->m_thread_count * 4;
+		size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+		std::vector< std::function< void() > > functs;
+		for (size_t chunkStart = startIndex; chunkStart < endIndex; chunkStart += chunkSize)
+		{
+			size_t chunkEnd = (chunkStart + chunkSize < endIndex) ? chunkStart + chunkSize : endIndex;
+			functs.emplace_back([chunkStart, chunkEnd, &funct]()
+			{
+				for (size_t i = chunkStart; i < chunkEnd; ++i)
+				{
+					funct(i);
+				}
+			});
+		}
+		TaskGroup taskGroup;
+		taskGroup.runAll(functs);
+		taskGroup.join();
+	}
+
 }
 
 #endif //GRAPHITE_THREADPOOL_HPP
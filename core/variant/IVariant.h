@@ -16,6 +16,7 @@ namespace graphite
 	class IAllele;
 	class IAlignment;
 	class Sample;
+	class VCFLineWriter;
     class IVariant : private Noncopyable, public std::enable_shared_from_this< IVariant >
     {
         public:
@@ -33,7 +34,7 @@ namespace graphite
 			virtual void processOverlappingAlleles() = 0; // set all allele variantwptrs to be this
 			virtual uint32_t getAllelePrefixOverlapMaxCount(IAllele::SharedPtr allelePtr) = 0;
 			virtual uint32_t getAlleleSuffixOverlapMaxCount(IAllele::SharedPtr allelePtr) = 0;
-			virtual std::string getVariantLine(IHeader::SharedPtr headerPtr) = 0;
+			virtual void writeVariantLine(VCFLineWriter& lineWriter) = 0;
 			virtual bool shouldSkip() = 0;
 			virtual void setSkip(bool) = 0;
 			virtual std::vector< Region::SharedPtr > getRegions() = 0;
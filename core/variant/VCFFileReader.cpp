@@ -1,6 +1,7 @@
  #include "core/file/ASCIIFileReader.h"
 #include "core/file/ASCIIGZFileReader.h"
 #include "core/util/ThreadPool.hpp"
+#include "core/util/BGZFThreadPool.hpp"
 #include "core/region/Region.h"
 #include "VariantList.h"
 #include "VCFFileReader.h"
@@ -13,6 +14,7 @@
 #include <future>
 #include <atomic>
 #include <memory>
+#include <limits>
 
 namespace graphite
 {
@@ -20,7 +22,15 @@ namespace graphite
 	VCFFileReader::VCFFileReader(const std::string& path, IReference::SharedPtr referencePtr, uint32_t readLength) :
 		m_path(path),
 		m_reference_ptr(referencePtr),
-		m_read_length(readLength)
+		m_read_length(readLength),
+		m_has_pending_line(false),
+		m_tabix_file_ptr(nullptr),
+		m_tabix_ptr(nullptr),
+		m_tabix_itr_ptr(nullptr),
+		m_cursor_position(0),
+		m_cursor_reference_reached(false),
+		m_contig_order_checked(false),
+		m_cursor_rank(std::numeric_limits< size_t >::max())
 	{
 		static uint32_t s_vcf_id = 0; // An id that is set and auto increments when a new reader is created
 		m_id = s_vcf_id;
@@ -30,7 +40,15 @@ namespace graphite
 	}
 
 	VCFFileReader::VCFFileReader(const std::string& path) :
-		m_path(path)
+		m_path(path),
+		m_has_pending_line(false),
+		m_tabix_file_ptr(nullptr),
+		m_tabix_ptr(nullptr),
+		m_tabix_itr_ptr(nullptr),
+		m_cursor_position(0),
+		m_cursor_reference_reached(false),
+		m_contig_order_checked(false),
+		m_cursor_rank(std::numeric_limits< size_t >::max())
 	{
 		setFileReader(m_path);
 		Open();
@@ -42,27 +60,60 @@ namespace graphite
 	}
 
 	void VCFFileReader::setFileReader(const std::string& path)
+	{
+		m_file_ptr = CreateFileReader(path);
+	}
+
+	IFile::SharedPtr VCFFileReader::CreateFileReader(const std::string& path)
 	{
 		std::string fileExtension = path.substr(path.find_last_of('.') + 1);
 		if (strcmp(fileExtension.c_str(), "gz") == 0) // if it's a gz file
 		{
-			m_file_ptr = std::make_shared< ASCIIGZFileReader >(path);
+			return std::make_shared< ASCIIGZFileReader >(path);
 		}
 		else // if it's not gz'd
 		{
-			m_file_ptr = std::make_shared< ASCIIFileReader >(path);
+			return std::make_shared< ASCIIFileReader >(path);
 		}
 	}
 
 
 	VCFFileReader::~VCFFileReader()
 	{
+		if (this->m_tabix_itr_ptr != nullptr) { tbx_itr_destroy(this->m_tabix_itr_ptr); }
+		if (this->m_tabix_ptr != nullptr) { tbx_destroy(this->m_tabix_ptr); }
+		if (this->m_tabix_file_ptr != nullptr) { hts_close(this->m_tabix_file_ptr); }
+		free(this->m_tabix_line.s);
 	}
 
 	void VCFFileReader::Open()
 	{
+		this->m_tabix_line.l = this->m_tabix_line.m = 0;
+		this->m_tabix_line.s = nullptr;
 		m_file_ptr->Open();
 		readHeader();
+		openIndex();
+		auto contigIDs = this->m_vcf_header->getContigIDs();
+		for (size_t i = 0; i < contigIDs.size(); ++i)
+		{
+			this->m_contig_ranks.emplace(contigIDs[i] + "\t", i);
+		}
+	}
+
+	void VCFFileReader::openIndex()
+	{
+		std::string fileExtension = this->m_path.substr(this->m_path.find_last_of('.') + 1);
+		if (strcmp(fileExtension.c_str(), "gz") != 0) { return; }
+		this->m_tabix_ptr = tbx_index_load(this->m_path.c_str()); // looks for a .csi and then a .tbi next to the file
+		if (this->m_tabix_ptr == nullptr) { return; } // no index, fall back to scanning
+		this->m_tabix_file_ptr = hts_open(this->m_path.c_str(), "r");
+		if (this->m_tabix_file_ptr == nullptr)
+		{
+			tbx_destroy(this->m_tabix_ptr);
+			this->m_tabix_ptr = nullptr;
+			return;
+		}
+		hts_set_thread_pool(this->m_tabix_file_ptr, BGZFThreadPool::Instance()->getThreadPool());
 	}
 
 	/*
@@ -89,16 +140,30 @@ namespace graphite
 		std::unordered_set< std::string > regionStringSet;
 		for (auto vcfPath : vcfPaths)
 		{
-			std::string line;
 			auto vcfFileReaderPtr = std::make_shared< VCFFileReader >(vcfPath);
-			while (vcfFileReaderPtr->m_file_ptr->getNextLine(line))
+			std::vector< std::string > referenceIDs;
+			if (vcfFileReaderPtr->isIndexed())
+			{
+				int referenceCount = 0;
+				const char** referenceNames = tbx_seqnames(vcfFileReaderPtr->m_tabix_ptr, &referenceCount);
+				referenceIDs.assign(referenceNames, referenceNames + referenceCount);
+				free(referenceNames);
+			}
+			else
+			{
+				referenceIDs = vcfFileReaderPtr->getVCFHeader()->getContigIDs();
+			}
+			if (referenceIDs.empty())
 			{
-				auto region = line.substr(0, line.find("\t"));
-				if (regionStringSet.find(region) == regionStringSet.end())
+				return std::vector< Region::SharedPtr >(); // the contigs have to be found while the variants are read
+			}
+			for (auto& referenceID : referenceIDs)
+			{
+				if (regionStringSet.find(referenceID) == regionStringSet.end())
 				{
-					auto regionPtr = std::make_shared< Region >(region, Region::BASED::ONE);
+					auto regionPtr = std::make_shared< Region >(referenceID, Region::BASED::ONE);
 					regionPtrs.emplace_back(regionPtr);
-					regionStringSet.emplace(region);
+					regionStringSet.emplace(referenceID);
 				}
 			}
 		}
@@ -106,6 +171,23 @@ namespace graphite
 		return regionPtrs;
 	}
 
+	Region::SharedPtr VCFFileReader::GetNextRegionInVCFs(const std::vector< VCFFileReader::SharedPtr >& vcfFileReaderPtrs, const std::unordered_set< std::string >& loadedReferenceIDs)
+	{
+		for (auto& vcfFileReaderPtr : vcfFileReaderPtrs)
+		{
+			std::string referenceID;
+			while (vcfFileReaderPtr->getNextReferenceID(referenceID))
+			{
+				if (loadedReferenceIDs.find(referenceID) == loadedReferenceIDs.end())
+				{
+					return std::make_shared< Region >(referenceID, Region::BASED::ONE);
+				}
+				vcfFileReaderPtr->skipNextLine(); // the contig was split up in an unsorted file, these lines are left out
+			}
+		}
+		return nullptr;
+	}
+
 	position VCFFileReader::getPositionFromLine(const char* line)
 	{
 		const char* tmpLine = line;
@@ -129,137 +211,233 @@ namespace graphite
 		std::string regionReferenceIDWithTab = regionPtr->getReferenceID() + "\t";
 		std::string line;
 		uint32_t count = 0;
-		// this->m_file_ptr->setFilePosition(findRegionStartPosition(regionPtr));
-		// std::cout << "region not yet found" << std::endl;
-		while (this->m_file_ptr->getNextLine(line))
+		if (isIndexed())
 		{
-			bool wasInRegion = false;
-			if (memcmp(regionReferenceIDWithTab.c_str(), line.c_str(), regionReferenceIDWithTab.size()) == 0) // if we are in the correct reference (chrom)
+			if (!continuesAt(regionPtr->getReferenceID(), regionPtr->getStartPosition()))
 			{
-				position linePosition = getPositionFromLine(line.c_str());
-				if ((regionPtr->getStartPosition() <= linePosition && linePosition <= regionPtr->getEndPosition()))
-				{
-					variantPtrs.emplace_back(Variant::BuildVariant(line, this->m_reference_ptr, m_read_length));
-					wasInRegion = true;
-					continue;
-				}
-				if (regionPtr->getEndPosition() < linePosition) { break; } // if we have passed the end position of the region then stop looking for variants
+				seek(regionPtr->getReferenceID(), regionPtr->getStartPosition());
 			}
-			if (wasInRegion)
+		}
+		else if (this->m_cursor_reference_id != regionPtr->getReferenceID())
+		{
+			moveToReference(regionPtr->getReferenceID());
+		}
+		while (getNextLineOnReference(regionReferenceIDWithTab, line))
+		{
+			position linePosition = getPositionFromLine(line.c_str());
+			if ((regionPtr->getStartPosition() <= linePosition && linePosition <= regionPtr->getEndPosition()))
+			{
+				variantPtrs.emplace_back(Variant::BuildVariant(line, this->m_reference_ptr, m_read_length));
+				continue;
+			}
+			if (regionPtr->getEndPosition() < linePosition) // if we have passed the end position of the region then stop looking for variants
 			{
+				this->m_pending_line = line;
+				this->m_has_pending_line = true;
 				break;
 			}
 		}
+		this->m_cursor_reference_id = regionPtr->getReferenceID();
+		this->m_cursor_position = regionPtr->getEndPosition();
 		return variantPtrs;
 	}
 
-	uint64_t VCFFileReader::findRegionStartPosition(Region::SharedPtr regionPtr)
+	bool VCFFileReader::getNextVariantPosition(const std::string& referenceID, position& nextPosition)
 	{
-		std::ifstream in(this->m_path, std::ifstream::ate | std::ifstream::binary);
-		auto fileSize = in.tellg();
-		in.close();
-		std::deque< std::shared_ptr< std::future< uint64_t > > > futureFunctions;
-		std::shared_ptr< std::atomic< bool > > posFound = std::make_shared< std::atomic< bool > >(false);
-		uint32_t numThreads = 20;
-		uint32_t partSize = fileSize / numThreads;
-		uint64_t seekPosition = 0;
-		for (auto i = 0; i < numThreads; ++i)
+		std::string referenceIDWithTab = referenceID + "\t";
+		if (this->m_cursor_reference_id != referenceID)
 		{
-			// std::cout << "starting thread: " << i << " at seek position: " << seekPosition << std::endl;
-			auto funct = std::bind(&VCFFileReader::getPositionFromFile, this, seekPosition, seekPosition + partSize, posFound, regionPtr, this->m_path);
-			auto future = ThreadPool::Instance()->enqueue(funct);
-			futureFunctions.push_back(future);
-			seekPosition += partSize;
-		}
-		uint64_t pos = 0;
-		while (!futureFunctions.empty())
-		{
-			auto futureFunct = futureFunctions.front();
-			futureFunctions.pop_front();
-			if (futureFunct->wait_for(std::chrono::milliseconds(100)) == std::future_status::ready)
+			if (isIndexed())
 			{
-				auto tmpPos = futureFunct->get();
-				if (tmpPos > 0)
-				{
-					pos = tmpPos;
-					break;
-				}
+				seek(referenceID, 1);
 			}
 			else
 			{
-				futureFunctions.emplace_back(futureFunct);
+				moveToReference(referenceID);
 			}
 		}
-
-		return pos;
+		// a pending line of another reference is scanned past like any other, the reference can still come after it
+		if (!this->m_has_pending_line || memcmp(referenceIDWithTab.c_str(), this->m_pending_line.c_str(), referenceIDWithTab.size()) != 0)
+		{
+			std::string line;
+			if (!getNextLineOnReference(referenceIDWithTab, line))
+			{
+				return false;
+			}
+			this->m_pending_line.swap(line);
+			this->m_has_pending_line = true;
+		}
+		nextPosition = getPositionFromLine(this->m_pending_line.c_str());
+		return true;
 	}
 
-	uint64_t VCFFileReader::getPositionFromFile(uint64_t seekPosition, uint64_t endSeekPosition, std::shared_ptr< std::atomic< bool > > posFound, Region::SharedPtr regionPtr, std::string path)
+	bool VCFFileReader::getNextLine(std::string& line)
 	{
-		static std::mutex l;
-
-		std::ifstream f;
-		f.open(path.c_str(), std::ifstream::in);
-
-		f.seekg(endSeekPosition, std::ifstream::beg);
-		std::string line;
-
-		bool newChrom = false;
+		if (this->m_has_pending_line)
+		{
+			line.swap(this->m_pending_line);
+			this->m_has_pending_line = false;
+			return true;
+		}
+		if (isIndexed())
+		{
+			if (this->m_tabix_itr_ptr == nullptr || tbx_itr_next(this->m_tabix_file_ptr, this->m_tabix_ptr, this->m_tabix_itr_ptr, &this->m_tabix_line) < 0)
+			{
+				return false;
+			}
+			line.assign(this->m_tabix_line.s, this->m_tabix_line.l);
+			return true;
+		}
+		return this->m_file_ptr->getNextLine(line);
+	}
 
-		if (seekPosition > 0)
+	bool VCFFileReader::getNextReferenceID(std::string& referenceID)
+	{
+		if (!this->m_has_pending_line)
 		{
-			// rewind by one line
-			while (f.unget() && f.peek() != '\n')
+			if (!getNextLine(this->m_pending_line))
 			{
-				std::lock_guard< std::mutex > lock(l);
-				char tmp = f.peek();
-				// std::cout << tmp << std::endl;
+				return false;
 			}
+			this->m_has_pending_line = true;
 		}
+		referenceID = this->m_pending_line.substr(0, this->m_pending_line.find('\t'));
+		return true;
+	}
 
-		std::getline(f, line); // fastforward to the eol
-		endSeekPosition = f.tellg();
-		f.seekg(seekPosition, std::ifstream::beg);
+	void VCFFileReader::skipNextLine()
+	{
+		std::string line;
+		getNextLine(line);
+	}
 
-		std::string regionReferenceIDWithTab = regionPtr->getReferenceID() + "\t";
-		position startPosition = regionPtr->getStartPosition();
-		uint64_t returnFilePos = 0;
-		uint64_t tmpFilePos = f.tellg();
-		std::getline(f, line); // get the partial line
-		uint64_t counter = 0;
-		while (std::getline(f, line) && f.tellg() < endSeekPosition)
+	/*
+	 * Lines of the references ahead of the cursor's are skipped, the first
+	 * line of a reference after the cursor's is left pending so the next
+	 * reference doesn't have to be read from the start of the file again.
+	 */
+	bool VCFFileReader::getNextLineOnReference(const std::string& referenceIDWithTab, std::string& line)
+	{
+		while (getNextLine(line))
 		{
+			if (memcmp(referenceIDWithTab.c_str(), line.c_str(), referenceIDWithTab.size()) == 0)
 			{
-				std::lock_guard< std::mutex > lock(l);
-				// std::cout << line << std::endl;
+				this->m_cursor_reference_reached = true;
+				return true;
 			}
-			if (line.size() > 0 && line[0] == '#') { continue; }
-			if (counter++ % 10 == 0 && posFound->load()) { break; } // another thread located the position before this thread
-			if (memcmp(regionReferenceIDWithTab.c_str(), line.c_str(), regionReferenceIDWithTab.size()) == 0) // if we are in the correct reference (chrom)
+			if (!this->m_cursor_reference_reached && (this->m_skipped_reference_id.empty() || memcmp(this->m_skipped_reference_id.c_str(), line.c_str(), this->m_skipped_reference_id.size()) != 0))
 			{
-				auto currentPosition = VCFFileReader::getPositionFromLine(line.c_str());
-				if (currentPosition >= startPosition)
+				this->m_skipped_reference_id = line.substr(0, line.find('\t') + 1);
+				// a file sorted in header order can't have the reference after a contig that comes later in the header
+				auto rankIter = this->m_contig_ranks.find(this->m_skipped_reference_id);
+				bool rankedAfterCursor = (rankIter != this->m_contig_ranks.end() && rankIter->second > this->m_cursor_rank);
+				this->m_cursor_reference_reached = rankedAfterCursor && linesFollowContigOrder();
+				if (!this->m_cursor_reference_reached)
 				{
-					returnFilePos = tmpFilePos;
-					f.seekg(returnFilePos, std::ifstream::beg);
-					std::getline(f, line); // get the partial line
-					{
-						std::lock_guard< std::mutex > lock(l);
-						// std::cout << "found position: " << currentPosition << " " << returnFilePos << std::endl;
-						// std::cout << "found line: " << line << std::endl;
-					}
-					*posFound = true;
+					this->m_passed_reference_ids.emplace(this->m_skipped_reference_id);
+				}
+			}
+			if (this->m_cursor_reference_reached)
+			{
+				this->m_pending_line.swap(line);
+				this->m_has_pending_line = true;
+				return false;
+			}
+		}
+		return false;
+	}
+
+	/*
+	 * Files sorted some other way than the ##contig lines, lexicographically
+	 * for one, would have references skipped by the ranks. The first time a
+	 * rank would skip one the lines are checked in a pass of their own and the
+	 * ranks are dropped if they are out of order, the references are then
+	 * found by scanning.
+	 */
+	bool VCFFileReader::linesFollowContigOrder()
+	{
+		if (!this->m_contig_order_checked)
+		{
+			this->m_contig_order_checked = true;
+			auto filePtr = CreateFileReader(this->m_path); // a reader of its own, the cursor's is left where it is
+			filePtr->Open();
+			std::string line;
+			std::string referenceIDWithTab;
+			size_t lastRank = 0;
+			while (filePtr->getNextLine(line))
+			{
+				if (line.empty() || line[0] == '#' || (!referenceIDWithTab.empty() && memcmp(referenceIDWithTab.c_str(), line.c_str(), referenceIDWithTab.size()) == 0)) { continue; }
+				referenceIDWithTab = line.substr(0, line.find('\t') + 1);
+				auto rankIter = this->m_contig_ranks.find(referenceIDWithTab);
+				if (rankIter == this->m_contig_ranks.end()) { continue; } // references without a ##contig line are never skipped by rank
+				if (rankIter->second < lastRank)
+				{
+					this->m_contig_ranks.clear();
+					this->m_cursor_rank = std::numeric_limits< size_t >::max();
 					break;
 				}
+				lastRank = rankIter->second;
 			}
-			tmpFilePos = f.tellg();
 		}
-		f.close();
+		return !this->m_contig_ranks.empty();
+	}
+
+	void VCFFileReader::moveToReference(const std::string& referenceID)
+	{
+		if (!this->m_cursor_reference_id.empty())
+		{
+			this->m_passed_reference_ids.emplace(this->m_cursor_reference_id + "\t");
+		}
+		if (this->m_passed_reference_ids.find(referenceID + "\t") != this->m_passed_reference_ids.end())
+		{
+			// the reference was already read past, start over from the first variant
+			std::string line;
+			setFileReader(this->m_path);
+			this->m_file_ptr->Open();
+			while (this->m_file_ptr->getNextLine(line) && line.size() > 0 && line[0] == '#') {}
+			this->m_pending_line.swap(line);
+			this->m_has_pending_line = (this->m_pending_line.size() > 0 && this->m_pending_line[0] != '#');
+			this->m_passed_reference_ids.clear();
+			this->m_skipped_reference_id.clear();
+		}
+		auto rankIter = this->m_contig_ranks.find(referenceID + "\t");
+		this->m_cursor_reference_id = referenceID;
+		this->m_cursor_reference_reached = false;
+		this->m_cursor_rank = (rankIter != this->m_contig_ranks.end()) ? rankIter->second : std::numeric_limits< size_t >::max();
+		this->m_cursor_position = 0;
+		this->m_skipped_reference_id.clear();
+	}
+
+	bool VCFFileReader::continuesAt(const std::string& referenceID, position startPosition)
+	{
+		if (this->m_tabix_itr_ptr == nullptr || this->m_cursor_reference_id != referenceID || startPosition <= this->m_cursor_position)
+		{
+			return false;
+		}
+		// consecutive windows, or nothing to skip before the start, keep reading where the last call stopped
+		if (startPosition == this->m_cursor_position + 1)
+		{
+			return true;
+		}
+		return this->m_has_pending_line && getPositionFromLine(this->m_pending_line.c_str()) >= startPosition;
+	}
+
+	void VCFFileReader::seek(const std::string& referenceID, position startPosition)
+	{
+		if (this->m_tabix_itr_ptr != nullptr)
+		{
+			tbx_itr_destroy(this->m_tabix_itr_ptr);
+			this->m_tabix_itr_ptr = nullptr;
+		}
+		int referenceIndex = tbx_name2id(this->m_tabix_ptr, referenceID.c_str());
+		if (referenceIndex >= 0)
 		{
-			std::lock_guard< std::mutex > lock(l);
-			// std::cout << "finished: " << returnFilePos << std::endl;
+			// tabix is 0 based and also returns records that start before but overlap the start, those are skipped by their position
+			this->m_tabix_itr_ptr = tbx_itr_queryi(this->m_tabix_ptr, referenceIndex, (startPosition > 0) ? startPosition - 1 : 0, std::numeric_limits< int >::max());
 		}
-		return returnFilePos;
+		this->m_has_pending_line = false;
+		this->m_cursor_reference_id = referenceID;
+		this->m_cursor_position = (startPosition > 0) ? startPosition - 1 : 0;
 	}
 
 } // end namespace graphite
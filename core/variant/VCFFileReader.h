@@ -10,12 +10,18 @@
 
 #include "Variant.h"
 
+#include "htslib/hts.h"
+#include "htslib/kstring.h"
+#include "htslib/tbx.h"
+
 #include <list>
 #include <tuple>
 #include <map>
 #include <thread>
 #include <mutex>
 #include <future>
+#include <unordered_set>
+#include <unordered_map>
 
 namespace graphite
 {
@@ -35,9 +41,32 @@ namespace graphite
 		std::string getFilePath();
 
 		uint32_t getID() { return this->m_id; }
+		bool isIndexed() { return this->m_tabix_ptr != nullptr; }
+		/*
+		 * bgzipped VCFs with a .tbi or .csi index seek straight to the region,
+		 * anything else is scanned from where the last call stopped.
+		 */
 		std::vector< IVariant::SharedPtr > getVariantsInRegion(Region::SharedPtr regionPtr);
+		/*
+		 * Reads are sequential, the line that ends a region is held back for the
+		 * next call so a contig can be loaded in consecutive windows. Returns
+		 * false if there are no more variants on the reference.
+		 */
+		bool getNextVariantPosition(const std::string& referenceID, position& nextPosition);
+
+		void setReferencePtr(IReference::SharedPtr referencePtr) { this->m_reference_ptr = referencePtr; }
 
+		/*
+		 * The contigs of the tabix indices, or of the ##contig header lines.
+		 * Empty if a file has neither, the contigs are then found with
+		 * GetNextRegionInVCFs while the variants are read.
+		 */
 		static std::vector< Region::SharedPtr > GetAllRegionsInVCF(const std::vector< std::string >& vcfPaths);
+		/*
+		 * The first contig, in file order, after where the readers stopped that
+		 * isn't in loadedReferenceIDs. nullptr once the readers are done.
+		 */
+		static Region::SharedPtr GetNextRegionInVCFs(const std::vector< VCFFileReader::SharedPtr >& vcfFileReaderPtrs, const std::unordered_set< std::string >& loadedReferenceIDs);
 
 		VCFFileReader(const std::string& path);
 		VCFHeader::SharedPtr getVCFHeader() { return this->m_vcf_header; }
@@ -49,8 +78,16 @@ namespace graphite
         void readHeader();
 		static position getPositionFromLine(const char* line);
 		void setFileReader(const std::string& path);
-		uint64_t findRegionStartPosition(Region::SharedPtr regionPtr);
-		uint64_t getPositionFromFile(uint64_t seekPosition, uint64_t endSeekPosition, std::shared_ptr< std::atomic< bool > > posFound, Region::SharedPtr regionPtr, std::string path);
+		static IFile::SharedPtr CreateFileReader(const std::string& path);
+		bool getNextLine(std::string& line);
+		void openIndex();
+		void seek(const std::string& referenceID, position startPosition);
+		bool continuesAt(const std::string& referenceID, position startPosition);
+		bool getNextLineOnReference(const std::string& referenceIDWithTab, std::string& line);
+		bool linesFollowContigOrder();
+		bool getNextReferenceID(std::string& referenceID);
+		void skipNextLine();
+		void moveToReference(const std::string& referenceID);
 
 		VCFHeader::SharedPtr m_vcf_header;
 		std::string m_path;
@@ -59,6 +96,21 @@ namespace graphite
 		uint32_t m_id;
 		IReference::SharedPtr m_reference_ptr;
 		uint32_t m_read_length;
+		std::string m_pending_line;
+		bool m_has_pending_line;
+
+		htsFile* m_tabix_file_ptr;
+		tbx_t* m_tabix_ptr;
+		hts_itr_t* m_tabix_itr_ptr;
+		kstring_t m_tabix_line;
+		std::string m_cursor_reference_id; // every line on this reference up to m_cursor_position has been read, apart from the pending line
+		position m_cursor_position;
+		bool m_cursor_reference_reached;
+		std::string m_skipped_reference_id; // with its tab
+		std::unordered_set< std::string > m_passed_reference_ids; // with their tabs
+		std::unordered_map< std::string, size_t > m_contig_ranks; // ##contig header order, with tabs, emptied if the lines don't follow it
+		bool m_contig_order_checked;
+		size_t m_cursor_rank;
 
 		std::mutex m_region_mutex;
 
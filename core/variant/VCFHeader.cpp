@@ -11,6 +11,7 @@ namespace graphite
 	{
 		std::string headerEnd = "#CHROM";
 		std::string formatString = "##FORMAT";
+		std::string contigString = "##contig=<";
 		bool addedFormat = false;
 		for (auto headerLine : vcfHeaderLines)
 		{
@@ -33,6 +34,15 @@ namespace graphite
 			}
 			else
 			{
+				if (strncmp(contigString.c_str(), headerLine.c_str(), contigString.size()) == 0)
+				{
+					auto idPosition = headerLine.find("ID=", contigString.size());
+					if (idPosition != std::string::npos)
+					{
+						idPosition += 3;
+						m_contig_ids.emplace_back(headerLine.substr(idPosition, headerLine.find_first_of(",>", idPosition) - idPosition));
+					}
+				}
 				m_lines.emplace_back(headerLine);
 			}
 		}
@@ -29,6 +29,7 @@ namespace graphite
 		/* bool isActiveSampleColumnName(const std::string& headerName) override; */
 		bool isActiveSampleColumnName(const std::string& headerName) override;
 		bool isSampleColumnName(const std::string& headerName) override;
+		std::vector< std::string > getContigIDs() { return this->m_contig_ids; } // the IDs of the ##contig lines in header order
 	private:
 		void setColumns(const std::string& headerString);
 		std::string getColumnsString();
@@ -42,6 +43,7 @@ namespace graphite
 		std::unordered_set< std::string > m_active_sample_names;
 		std::unordered_set< std::string > m_sample_names;
 		std::vector< std::string > m_sample_names_by_column_order;
+		std::vector< std::string > m_contig_ids;
 	};
 }
 
@@ -0,0 +1,94 @@
+#include "VCFLineWriter.h"
+#include "core/util/Types.h"
+
+namespace graphite
+{
+	namespace
+	{
+		const size_t s_flush_size = 1 << 22;
+		const char* s_digit_pairs = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+	}
+
+	VCFLineWriter::VCFLineWriter(IFileWriter::SharedPtr fileWriterPtr, IHeader::SharedPtr headerPtr) :
+		m_file_writer_ptr(fileWriterPtr),
+		m_header_ptr(headerPtr),
+		m_format_column_index(headerPtr->getColumnPosition("FORMAT"))
+	{
+		auto columnNames = headerPtr->getColumnNames();
+		this->m_column_count = columnNames.size();
+		this->m_sample_columns.resize(columnNames.size());
+		for (size_t i = 9; i < columnNames.size(); ++i)
+		{
+			auto& sampleColumn = this->m_sample_columns[i];
+			sampleColumn.active = headerPtr->isActiveSampleColumnName(columnNames[i]);
+			sampleColumn.indexed = sampleColumn.active && SampleManager::GetSampleIndex(columnNames[i], sampleColumn.sampleIndex);
+		}
+
+		for (auto i = 0; i < AllAlleleCountTypes.size(); ++i)
+		{
+			std::string alleleTypeCountString = AlleleCountTypeToShortString(AllAlleleCountTypes[i]);
+			this->m_format_string += ((i > 0) ? ":DP_" : "DP_") + alleleTypeCountString + ":DP4_" + alleleTypeCountString;
+			this->m_blank_sample_counts += ".:.:";
+		}
+		this->m_blank_sample_counts += ".";
+
+		if (this->m_file_writer_ptr != nullptr)
+		{
+			this->m_buffer.reserve(s_flush_size + (s_flush_size / 4));
+		}
+	}
+
+	VCFLineWriter::~VCFLineWriter()
+	{
+		flush();
+	}
+
+	void VCFLineWriter::writeHeader()
+	{
+		this->m_buffer.append(this->m_header_ptr->getHeader());
+	}
+
+	void VCFLineWriter::endLine()
+	{
+		if (this->m_buffer.size() >= s_flush_size)
+		{
+			flush();
+		}
+	}
+
+	void VCFLineWriter::flush()
+	{
+		if (this->m_file_writer_ptr == nullptr || this->m_buffer.empty())
+		{
+			return;
+		}
+		this->m_file_writer_ptr->write(this->m_buffer.c_str(), this->m_buffer.size());
+		this->m_buffer.clear();
+	}
+
+	void VCFLineWriter::appendCount(uint32_t count)
+	{
+		// two digits at a time, back to front
+		char digits[10];
+		char* end = digits + sizeof(digits);
+		char* start = end;
+		while (count >= 100)
+		{
+			const char* digitPair = s_digit_pairs + ((count % 100) * 2);
+			count /= 100;
+			*--start = digitPair[1];
+			*--start = digitPair[0];
+		}
+		if (count >= 10)
+		{
+			const char* digitPair = s_digit_pairs + (count * 2);
+			*--start = digitPair[1];
+			*--start = digitPair[0];
+		}
+		else
+		{
+			*--start = '0' + count;
+		}
+		this->m_buffer.append(start, end - start);
+	}
+}
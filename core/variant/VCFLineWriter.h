@@ -0,0 +1,66 @@
+#ifndef GRAPHITE_VCFLINEWRITER_H
+#define GRAPHITE_VCFLINEWRITER_H
+
+#include "IHeader.h"
+#include "core/file/IFileWriter.h"
+#include "core/util/Noncopyable.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace graphite
+{
+	/*
+	 * Collects formatted VCF lines in one buffer and hands it to the file
+	 * writer in large chunks. Everything that only depends on the header, the
+	 * FORMAT suffix, the blank sample counts and the sample index behind each
+	 * sample column, is worked out once when the writer is created.
+	 */
+	class VCFLineWriter : private Noncopyable
+	{
+	public:
+		typedef std::shared_ptr< VCFLineWriter > SharedPtr;
+
+		struct SampleColumn
+		{
+			bool active;
+			bool indexed; // false if the sample isn't known to the SampleManager, its counts are all 0
+			uint32_t sampleIndex;
+		};
+
+		// with a null fileWriterPtr the lines stay in the buffer
+		VCFLineWriter(IFileWriter::SharedPtr fileWriterPtr, IHeader::SharedPtr headerPtr);
+		~VCFLineWriter();
+
+		void writeHeader();
+		void endLine(); // flushes once the buffer is full enough
+		void flush();
+		void clear() { this->m_buffer.clear(); } // drops the buffered lines without writing them
+
+		void reserve(size_t dataLength) { this->m_buffer.reserve(this->m_buffer.size() + dataLength); }
+		void append(const char* data, size_t dataLength) { this->m_buffer.append(data, dataLength); }
+		void append(const std::string& data) { this->m_buffer.append(data); }
+		void append(char c) { this->m_buffer.push_back(c); }
+		void appendCount(uint32_t count);
+
+		int32_t getFormatColumnIndex() { return this->m_format_column_index; }
+		size_t getColumnCount() { return this->m_column_count; }
+		const SampleColumn& getSampleColumn(size_t columnIndex) { return this->m_sample_columns[columnIndex]; }
+		const std::string& getFormatString() { return this->m_format_string; }
+		const std::string& getBlankSampleCounts() { return this->m_blank_sample_counts; }
+		const std::string& getBuffer() { return this->m_buffer; }
+
+	private:
+		IFileWriter::SharedPtr m_file_writer_ptr;
+		IHeader::SharedPtr m_header_ptr;
+		std::string m_buffer;
+		int32_t m_format_column_index;
+		size_t m_column_count;
+		std::vector< SampleColumn > m_sample_columns; // by column, only the sample columns are filled in
+		std::string m_format_string;
+		std::string m_blank_sample_counts;
+	};
+}
+
+#endif //GRAPHITE_VCFLINEWRITER_H
@@ -3,6 +3,7 @@
 
 #include "core/util/ThreadPool.hpp"
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 
@@ -11,7 +12,9 @@ namespace graphite
 	VCFManager::VCFManager(const std::string& vcfPath, Region::SharedPtr regionPtr, IReference::SharedPtr referencePtr, uint32_t readLength) :
 		m_loaded_vcfs(false),
 		m_region_ptr(regionPtr),
-		m_reference_ptr(referencePtr)
+		m_reference_ptr(referencePtr),
+		m_read_length(readLength),
+		m_max_end_position(regionPtr->getEndPosition())
 	{
 		auto vcfFileReaderPtr = VCFFileReader::CreateVCFFileReader(vcfPath, referencePtr, readLength);
 		this->m_vcf_file_reader_ptrs.emplace_back(vcfFileReaderPtr);
@@ -20,7 +23,9 @@ namespace graphite
 	VCFManager::VCFManager(const std::vector< std::string >& vcfFilePaths, Region::SharedPtr regionPtr, IReference::SharedPtr referencePtr, uint32_t readLength) :
 		m_loaded_vcfs(false),
 		m_region_ptr(regionPtr),
-		m_reference_ptr(referencePtr)
+		m_reference_ptr(referencePtr),
+		m_read_length(readLength),
+		m_max_end_position(regionPtr->getEndPosition())
 	{
 		for (const auto& vcfPath : vcfFilePaths)
 		{
@@ -29,6 +34,16 @@ namespace graphite
 		}
 	}
 
+	VCFManager::VCFManager(const std::vector< VCFFileReader::SharedPtr >& vcfFileReaderPtrs, Region::SharedPtr regionPtr, IReference::SharedPtr referencePtr, uint32_t readLength, position maxEndPosition) :
+		m_vcf_file_reader_ptrs(vcfFileReaderPtrs),
+		m_loaded_vcfs(false),
+		m_region_ptr(regionPtr),
+		m_reference_ptr(referencePtr),
+		m_read_length(readLength),
+		m_max_end_position(maxEndPosition)
+	{
+	}
+
 	VCFManager::~VCFManager()
 	{
 	}
@@ -36,43 +51,111 @@ namespace graphite
 	void VCFManager::asyncLoadVCFs()
 	{
 		std::lock_guard< std::mutex > lock(this->m_loaded_mutex);
-		if (this->m_loaded_vcfs) { return; }
+		if (this->m_loaded_vcfs || this->m_loading_thread_ptr != nullptr) { return; } // only one thread ever reads from the vcf readers
 		this->m_loading_thread_ptr = std::make_shared< std::thread >(&VCFManager::processVCFs, this);
 	}
 
 	// the intention of this function is to process the vcfs in a blocking way
 	void VCFManager::processVCFs()
 	{
-		std::lock_guard< std::mutex > lock(this->m_loaded_mutex);
-		std::vector< std::thread > vcfLoadThreads;
-		std::unordered_map< std::string, std::shared_ptr< std::future< std::vector< IVariant::SharedPtr > > > > vcfFutureVariantListPtrsMap;
-		for (const auto& vcfFileReaderPtr : this->m_vcf_file_reader_ptrs)
+		// m_loaded_mutex isn't held over the parallelFor, the waiting thread runs other queued tasks and one of them could take it
+		std::vector< std::vector< IVariant::SharedPtr > > vcfVariantPtrsList(this->m_vcf_file_reader_ptrs.size());
+		ThreadPool::Instance()->parallelFor(0, this->m_vcf_file_reader_ptrs.size(), [&](size_t i)
 		{
-			auto funct = std::bind(&VCFFileReader::getVariantsInRegion, vcfFileReaderPtr, this->m_region_ptr);
-			auto functFuture = ThreadPool::Instance()->enqueue(funct);
-			vcfFutureVariantListPtrsMap.emplace(vcfFileReaderPtr->getFilePath(), functFuture);
+			vcfVariantPtrsList[i] = this->m_vcf_file_reader_ptrs[i]->getVariantsInRegion(this->m_region_ptr);
+		});
+		if (this->m_max_end_position > this->m_region_ptr->getEndPosition())
+		{
+			extendRegion(vcfVariantPtrsList);
 		}
 
+		std::unordered_map< VCFFileReader::SharedPtr, VariantList::SharedPtr > pathVCFVariantListPtrsMap;
 		std::vector< IVariant::SharedPtr > variantPtrs;
-		for (const auto& vcfFileReaderPtr : this->m_vcf_file_reader_ptrs)
+		for (size_t i = 0; i < this->m_vcf_file_reader_ptrs.size(); ++i)
 		{
-			std::string filePath = vcfFileReaderPtr->getFilePath();
-			auto  vcfFuturePtr = vcfFutureVariantListPtrsMap[filePath];
-			vcfFuturePtr->wait();
-			auto vcfVariantPtrs = vcfFuturePtr->get();
+			auto& vcfVariantPtrs = vcfVariantPtrsList[i];
 			auto tmpVCFVariantListPtr = std::make_shared< VariantList >(vcfVariantPtrs, m_reference_ptr);
 			tmpVCFVariantListPtr->processOverlappingAlleles();
-			this->m_path_vcf_variant_list_ptrs_map.emplace(vcfFileReaderPtr, tmpVCFVariantListPtr);
+			pathVCFVariantListPtrsMap.emplace(this->m_vcf_file_reader_ptrs[i], tmpVCFVariantListPtr);
 			variantPtrs.insert(variantPtrs.end(), vcfVariantPtrs.begin(), vcfVariantPtrs.end());
 		}
 
-		vcfFutureVariantListPtrsMap.clear();
-		this->m_variant_list_ptr = std::make_shared< VariantList >(variantPtrs, m_reference_ptr);
-		this->m_variant_list_ptr->sort();
-		this->m_variant_list_ptr->normalizeOverlappingVariants();
+		auto variantListPtr = std::make_shared< VariantList >(variantPtrs, m_reference_ptr);
+		variantListPtr->sort();
+		variantListPtr->normalizeOverlappingVariants();
+
+		std::lock_guard< std::mutex > lock(this->m_loaded_mutex);
+		this->m_path_vcf_variant_list_ptrs_map = pathVCFVariantListPtrsMap;
+		this->m_variant_list_ptr = variantListPtr;
 		this->m_loaded_vcfs = true;
 	}
 
+	void VCFManager::extendRegion(std::vector< std::vector< IVariant::SharedPtr > >& vcfVariantPtrsList)
+	{
+		// variant regions are padded by the read length and a small overlap, the margin covers the overlap on both sides
+		static const position s_cluster_margin = 100;
+		position paddedEndPosition = 0;
+		std::vector< size_t > checkedCounts(vcfVariantPtrsList.size(), 0);
+		while (true)
+		{
+			for (size_t i = 0; i < vcfVariantPtrsList.size(); ++i)
+			{
+				for (; checkedCounts[i] < vcfVariantPtrsList[i].size(); ++checkedCounts[i])
+				{
+					auto variantPtr = vcfVariantPtrsList[i][checkedCounts[i]];
+					auto variantRegionPtrs = variantPtr->getRegions();
+					if (variantRegionPtrs.empty()) { continue; }
+					// structural variants never share a graph so only the region around their start position counts
+					auto regionPtr = (variantPtr->isStructuralVariant()) ? variantRegionPtrs[0] : variantRegionPtrs[variantRegionPtrs.size() - 1];
+					paddedEndPosition = std::max(paddedEndPosition, regionPtr->getEndPosition());
+				}
+			}
+
+			bool hasNextPosition = false;
+			position nextPosition = 0;
+			for (auto& vcfFileReaderPtr : this->m_vcf_file_reader_ptrs)
+			{
+				position readerNextPosition;
+				if (vcfFileReaderPtr->getNextVariantPosition(this->m_region_ptr->getReferenceID(), readerNextPosition))
+				{
+					nextPosition = (hasNextPosition) ? std::min(nextPosition, readerNextPosition) : readerNextPosition;
+					hasNextPosition = true;
+				}
+			}
+			if (!hasNextPosition || nextPosition > this->m_max_end_position || nextPosition > paddedEndPosition + this->m_read_length + s_cluster_margin)
+			{
+				return;
+			}
+
+			auto extensionRegionPtr = std::make_shared< Region >(this->m_region_ptr->getReferenceID(), this->m_region_ptr->getEndPosition() + 1, nextPosition, Region::BASED::ONE);
+			for (size_t i = 0; i < this->m_vcf_file_reader_ptrs.size(); ++i)
+			{
+				auto extensionVariantPtrs = this->m_vcf_file_reader_ptrs[i]->getVariantsInRegion(extensionRegionPtr);
+				vcfVariantPtrsList[i].insert(vcfVariantPtrsList[i].end(), extensionVariantPtrs.begin(), extensionVariantPtrs.end());
+			}
+			this->m_region_ptr = std::make_shared< Region >(this->m_region_ptr->getReferenceID(), this->m_region_ptr->getStartPosition(), nextPosition, Region::BASED::ONE);
+		}
+	}
+
+	uint64_t VCFManager::getMemoryUsage()
+	{
+		// the vcf line, info fields and parsed strings aren't reachable from here so they are covered by a flat per variant cost
+		static const uint64_t s_variant_overhead = 1024;
+		static const uint64_t s_allele_overhead = 128;
+		static const uint64_t s_region_overhead = 128;
+		uint64_t memoryUsage = 0;
+		for (auto& variantPtr : this->m_variant_list_ptr->getAllVariantPtrs())
+		{
+			memoryUsage += sizeof(Variant) + s_variant_overhead + (variantPtr->getRegions().size() * s_region_overhead);
+			memoryUsage += (2 * variantPtr->getRefAllelePtr()->getLength()) + s_allele_overhead;
+			for (auto& altAllelePtr : variantPtr->getAltAllelePtrs())
+			{
+				memoryUsage += (2 * altAllelePtr->getLength()) + s_allele_overhead;
+			}
+		}
+		return memoryUsage;
+	}
+
 	std::unordered_map< VCFFileReader::SharedPtr, VariantList::SharedPtr > VCFManager::getVCFReadersAndVariantListsMap()
 	{
 		return this->m_path_vcf_variant_list_ptrs_map;
@@ -23,6 +23,13 @@ namespace graphite
 
 		VCFManager(const std::string& vcfPath, Region::SharedPtr regionPtr, IReference::SharedPtr referencePtr, uint32_t readLength);
 		VCFManager(const std::vector< std::string >& vcfFilePaths, Region::SharedPtr regionPtr, IReference::SharedPtr referencePtr, uint32_t readLength);
+		/*
+		 * Loads a window of a contig from readers that are shared by all of the
+		 * contig's windows. The window's end is pushed out, up to maxEndPosition,
+		 * until the next variant is too far away to share a graph with anything
+		 * loaded, so a window never splits a cluster of overlapping variants.
+		 */
+		VCFManager(const std::vector< VCFFileReader::SharedPtr >& vcfFileReaderPtrs, Region::SharedPtr regionPtr, IReference::SharedPtr referencePtr, uint32_t readLength, position maxEndPosition);
 		~VCFManager();
 
 		IVariantList::SharedPtr getVariantsInRegion(Region::SharedPtr regionPtr) override;
@@ -32,8 +39,11 @@ namespace graphite
 		IVariantList::SharedPtr getCompleteVariantList() override;
 		void releaseResources() override;
 		std::unordered_map< VCFFileReader::SharedPtr, VariantList::SharedPtr > getVCFReadersAndVariantListsMap();
+		Region::SharedPtr getRegion() { return this->m_region_ptr; } // the loaded region, including any extension
+		uint64_t getMemoryUsage(); // an estimate of the bytes held by the loaded variants
 	private:
 		void processVCFs(); // a blocking call that waits for all vcfs to load and then combines them
+		void extendRegion(std::vector< std::vector< IVariant::SharedPtr > >& vcfVariantPtrsList);
 
 		VariantList::SharedPtr m_variant_list_ptr;
 		std::vector< VCFFileReader::SharedPtr > m_vcf_file_reader_ptrs;
@@ -43,6 +53,8 @@ namespace graphite
 		std::mutex m_loaded_mutex;
 		std::shared_ptr< std::thread > m_loading_thread_ptr;
 		IReference::SharedPtr m_reference_ptr;
+		uint32_t m_read_length;
+		position m_max_end_position;
 	};
 }
 
@@ -1,6 +1,7 @@
 #include "Variant.h"
 #include "core/alignment/IAlignment.h"
 #include "core/util/Utility.h"
+#include "core/util/FieldSplitter.hpp"
 
 #include <unordered_map>
 #include <sstream>
@@ -8,7 +9,7 @@
 
 namespace graphite
 {
-	Variant::Variant(position pos, const std::string& chrom, const std::string& id, const std::string& quality, const std::string& filter, IAllele::SharedPtr refAllelePtr, std::vector< IAllele::SharedPtr > altAllelePtrs, uint32_t readLength) : m_position(pos), m_chrom(chrom), m_id(id), m_qual(quality), m_filter(filter), m_skip(false), m_read_length(readLength), m_reference_size(0), m_overlap(10)
+	Variant::Variant(position pos, const std::string& chrom, const std::string& id, const std::string& quality, const std::string& filter, IAllele::SharedPtr refAllelePtr, std::vector< IAllele::SharedPtr > altAllelePtrs, uint32_t readLength) : m_position(pos), m_chrom(chrom), m_id(id), m_qual(quality), m_filter(filter), m_field_count(0), m_skip(false), m_read_length(readLength), m_reference_size(0), m_overlap(10)
 	{
 		this->m_ref_allele_ptr = refAllelePtr;
 		this->m_alt_allele_ptrs = altAllelePtrs;
@@ -19,7 +20,7 @@ namespace graphite
 	}
 
 	Variant::Variant() :
-		m_skip(false), m_overlap(10)
+		m_field_count(0), m_skip(false), m_overlap(10)
 	{
 	}
 
@@ -29,110 +30,111 @@ namespace graphite
 
 	Variant::SharedPtr Variant::BuildVariant(const std::string& vcfLine, IReference::SharedPtr referencePtr, uint32_t readLength)
 	{
-		std::string fields;
 		auto variantPtr = std::make_shared< Variant >();
-		std::string ref;
-		std::string alts;
-		std::vector< std::string > vcfComponents;
-
-		split(vcfLine, '\t', vcfComponents);
+		variantPtr->m_line = vcfLine;
+		// the line is split once, the fields are read in place from here on
+		variantPtr->m_field_count = SplitFields(variantPtr->m_line.c_str(), variantPtr->m_line.size(), '\t', variantPtr->m_field_ends, 9);
 
-		if (vcfComponents.size() < 7)
+		if (variantPtr->m_field_count < 8)
 		{
 			std::cout << "vcf line is incorrectly formated" << std::endl;
-		}
+			variantPtr->setSkip(true);
+			return variantPtr;
+		}
+
+		size_t fieldLength;
+		const char* field = variantPtr->getField(0, fieldLength);
+		variantPtr->m_chrom.assign(field, fieldLength);
+		variantPtr->m_position = strtoul(variantPtr->getField(1, fieldLength), nullptr, 10);
+		field = variantPtr->getField(2, fieldLength);
+		variantPtr->m_id.assign(field, fieldLength);
+		field = variantPtr->getField(3, fieldLength);
+		std::string ref(field, fieldLength);
+		field = variantPtr->getField(4, fieldLength);
+		std::string alts(field, fieldLength);
+		field = variantPtr->getField(5, fieldLength);
+		variantPtr->m_qual.assign(field, fieldLength);
+		field = variantPtr->getField(6, fieldLength);
+		variantPtr->m_filter.assign(field, fieldLength);
 
-		variantPtr->m_chrom = vcfComponents[0];
-		variantPtr->m_position = stoul(vcfComponents[1]);
-		variantPtr->m_id = vcfComponents[2];
-		ref = vcfComponents[3];
-		alts = vcfComponents[4];
-
-		variantPtr->m_qual = vcfComponents[5];
-		variantPtr->m_filter = vcfComponents[6];
-		fields = vcfComponents[7];
-
-		variantPtr->m_info_fields.clear();
-		variantPtr->setUnorderedMapKeyValue(fields);
 		variantPtr->setAlleles(referencePtr, ref, alts, readLength);
 
-		variantPtr->m_line = std::string(vcfLine.c_str());
-
 		return variantPtr;
 	}
 
-	void Variant::setUnorderedMapKeyValue(const std::string& rawString)
+	const char* Variant::getField(size_t index, size_t& fieldLength) const
 	{
-		m_info_fields.clear();
-		std::vector< std::string > infoFieldKeyValueSplit;
-		split(rawString, ';', infoFieldKeyValueSplit);
-		for (const auto& infoField : infoFieldKeyValueSplit)
+		if (index >= this->m_field_count)
 		{
-			std::vector< std::string > infoFieldSplit;
-			split(infoField, '=', infoFieldSplit);
-			if (infoFieldSplit.size() == 2)
-			{
-				m_info_fields[infoFieldSplit[0]] = infoFieldSplit[1];
-			}
+			fieldLength = 0;
+			return "";
 		}
+		uint32_t fieldStart = (index == 0) ? 0 : this->m_field_ends[index - 1] + 1;
+		fieldLength = this->m_field_ends[index] - fieldStart;
+		return this->m_line.c_str() + fieldStart;
 	}
 
-	int getSVLengthFromInfo(std::unordered_map< std::string, std::string >& infoFields, position pos)
+	bool Variant::getInfoValue(const char* key, std::string& value)
+	{
+		size_t infoLength;
+		const char* info = getField(7, infoLength);
+		const char* infoValue;
+		size_t infoValueLength;
+		if (!FindKeyValue(info, infoLength, ';', key, infoValue, infoValueLength))
+		{
+			return false;
+		}
+		value.assign(infoValue, infoValueLength);
+		return true;
+	}
+
+	int Variant::getSVLengthFromInfo()
 	{
 		int svLength = 0;
-		if (infoFields.find("SVLEN") != infoFields.end())
+		std::string value;
+		if (getInfoValue("SVLEN", value))
 		{
-			svLength = stoi(infoFields["SVLEN"]);
+			svLength = atoi(value.c_str());
 		}
-		else if (infoFields.find("END") != infoFields.end())
+		else if (getInfoValue("END", value))
 		{
-			svLength = stoi(infoFields["END"]) - pos;
+			svLength = atoi(value.c_str()) - m_position;
 		}
-		else if (infoFields.find("SEQ") != infoFields.end())
+		else if (getInfoValue("SEQ", value))
 		{
-			svLength = infoFields["SEQ"].size();
+			svLength = value.size();
 		}
 		if (svLength < 0) { svLength = svLength * -1; }
 		return svLength;
 	}
 
-	std::string getInsertionSequenceFromInfo(std::unordered_map< std::string, std::string >& infoFields)
+	std::unordered_map< std::string, std::string > Variant::getInfoFields() const
 	{
-		auto seqIter = infoFields.find("SEQ");
-		if (seqIter == infoFields.end())
-		{
-			return "";
-		}
-		else
+		std::unordered_map< std::string, std::string > infoFields;
+		size_t infoLength;
+		const char* info = getField(7, infoLength);
+		std::vector< std::string > infoFieldKeyValueSplit;
+		split(std::string(info, infoLength), ';', infoFieldKeyValueSplit);
+		for (const auto& infoField : infoFieldKeyValueSplit)
 		{
-			return seqIter->second;
+			std::vector< std::string > infoFieldSplit;
+			split(infoField, '=', infoFieldSplit);
+			if (infoFieldSplit.size() == 2)
+			{
+				infoFields[infoFieldSplit[0]] = infoFieldSplit[1];
+			}
 		}
+		return infoFields;
 	}
 
 	bool isStandardAlt(const std::string& alt)
 	{
-		std::unordered_set< char > validSequence = {'A', 'C', 'G', 'T', ','};
-		for (auto c : alt)
-		{
-			if (validSequence.find(c) == validSequence.end())
-			{
-				return false;
-			}
-		}
-		return true;
+		return alt.find_first_not_of("ACGT,") == std::string::npos;
 	}
 
 	bool isSymbolicAlt(const std::string& alt)
 	{
-		std::unordered_set< char > symbolicSequence = {'<', '>'};
-		for (auto c : alt)
-		{
-			if (symbolicSequence.find(c) != symbolicSequence.end())
-			{
-				return true;
-			}
-		}
-		return false;
+		return alt.find_first_of("<>") != std::string::npos;
 	}
 
 	std::string getTruncatedSequence(const char* sequence, uint32_t svLength, uint32_t readLength)
@@ -164,24 +166,26 @@ namespace graphite
 	{
 		auto maxSize = readLength * 3;
 		// auto maxSize = std::numeric_limits< uint32_t >::max();
-		const char* reference = referencePtr->getSequence() + (m_position - referencePtr->getRegion()->getStartPosition());
+		position referencePosition = m_position + 1; // duplications are read from the base after POS
 		std::string ref;
 		std::string alt;
 		std::vector< std::string > alts;
 		if (svLength > maxSize)
 		{
-			std::string sequenceA = std::string(reference + 1, readLength);
+			// read through getSequenceFromRegion, the far breakpoint can be outside of a sliced reference
+			std::string anchorBase = referencePtr->getSequenceFromRegion(std::make_shared< Region >(this->m_chrom, referencePosition, referencePosition, Region::BASED::ONE));
+			std::string sequenceA = referencePtr->getSequenceFromRegion(std::make_shared< Region >(this->m_chrom, referencePosition + 1, referencePosition + readLength, Region::BASED::ONE));
 			std::string intermediateSequence(readLength, 'N');
-			std::string sequenceB = std::string((reference + 1) + (svLength - readLength), readLength);
-			ref = std::string(1, reference[0]) + sequenceA + intermediateSequence + sequenceB;
-			alt = std::string(1, reference[0]) + sequenceA + intermediateSequence + sequenceB + sequenceA + intermediateSequence + sequenceB;
+			std::string sequenceB = referencePtr->getSequenceFromRegion(std::make_shared< Region >(this->m_chrom, (referencePosition + 1) + (svLength - readLength), referencePosition + svLength, Region::BASED::ONE));
+			ref = anchorBase + sequenceA + intermediateSequence + sequenceB;
+			alt = anchorBase + sequenceA + intermediateSequence + sequenceB + sequenceA + intermediateSequence + sequenceB;
 
 			m_reference_size = svLength;
 		}
 		else
 		{
-			ref = std::string(reference, svLength + 1);
-			alt = ref + std::string(reference + 1, svLength); // the duplicated region does not contain the first bp of the reported ref sequence
+			ref = referencePtr->getSequenceFromRegion(std::make_shared< Region >(this->m_chrom, referencePosition, referencePosition + svLength, Region::BASED::ONE));
+			alt = ref + ref.substr(1); // the duplicated region does not contain the first bp of the reported ref sequence
 
 			m_reference_size = ref.size();
 		}
@@ -193,7 +197,6 @@ namespace graphite
 	{
 		auto maxSize = readLength * 3;
 		// auto maxSize = std::numeric_limits< uint32_t >::max();
-		const char* reference = referencePtr->getSequence() + (m_position - referencePtr->getRegion()->getStartPosition());
 		std::string ref;
 		std::string alt;
 		if (svLength > maxSize)
@@ -291,7 +294,7 @@ namespace graphite
 	{
 		m_is_sv = false;
 		bool shouldSkip = true;
-		int svLength = getSVLengthFromInfo(m_info_fields, m_position);
+		int svLength = 0;
 		if (isStandardAlt(alt))
 		{
 			setAsStandardAlt(vcfReferenceString, alt, readLength);
@@ -299,7 +302,7 @@ namespace graphite
 			svLength = vcfReferenceString.size();
 			m_variant_size = svLength;
 		}
-		else if (isSymbolicAlt(alt) && svLength > 0)
+		else if (isSymbolicAlt(alt) && (svLength = getSVLengthFromInfo()) > 0) // INFO is only read for symbolic alleles
 		{
 			m_is_sv = (svLength > (readLength * 3));
 			m_variant_size = svLength;
@@ -320,8 +323,8 @@ namespace graphite
 			}
 			else if (alt.compare("<INS>") == 0)
 			{
-				std::string insertionSequence  = getInsertionSequenceFromInfo(m_info_fields);
-				if (insertionSequence.size() > 0)
+				std::string insertionSequence;
+				if (getInfoValue("SEQ", insertionSequence) && insertionSequence.size() > 0)
 				{
 					setAsInsertion(vcfReferenceString, insertionSequence, readLength);
 					shouldSkip = false;
@@ -469,136 +472,118 @@ namespace graphite
 
 	std::string Variant::getInfoFieldsString()
 	{
-		std::string infoFields = "";
-		for (auto infoField : this->m_info_fields)
-		{
-			std::string prefix = (infoFields.size() > 0) ? ";" : "";
-			infoFields += prefix + infoField.first + "=" + infoField.second;
-		}
-		return (this->m_info_fields.size() > 0) ? infoFields : ".";
+		size_t infoLength;
+		const char* info = getField(7, infoLength);
+		return (infoLength > 0) ? std::string(info, infoLength) : ".";
 	}
 
-	std::string Variant::getVariantLine(IHeader::SharedPtr headerPtr)
+	void Variant::writeVariantLine(VCFLineWriter& lineWriter)
 	{
-		std::vector< std::string > lineSplit;
-		split(this->m_line, '\t', lineSplit);
-		std::string line = "";
-
+		auto formatColumnIdx = lineWriter.getFormatColumnIndex();
+		size_t formatLength;
+		const char* format = getField(formatColumnIdx, formatLength);
 		std::string samplePadding = "";
-		bool samplePaddingSet = false;
-		for (auto i = lineSplit.size(); i < 9 + headerPtr->getColumnNames().size(); ++i) // add blank sample columns
+		if (formatLength > 0) // samples that are missing from the line are padded out to the FORMAT
 		{
-			lineSplit.emplace_back("");
-
-			if (!samplePaddingSet)
-			{
-				samplePaddingSet = true;
-				auto formatIdx = headerPtr->getColumnPosition("FORMAT");
-				auto formatField = lineSplit[formatIdx];
-				auto numFields = std::count(formatField.begin(), formatField.end(), ':');
-				if (formatField.size() > 0)
-				{
-					samplePadding += ".";
-					for (auto n = 0; n < numFields; ++n) { samplePadding += ":."; }
-				}
-			}
+			samplePadding += ".";
+			for (auto n = std::count(format, format + formatLength, ':'); n > 0; --n) { samplePadding += ":."; }
+			samplePadding += ":";
 		}
 
-	    auto formatColumnIdx = headerPtr->getColumnPosition("FORMAT");
+		lineWriter.reserve(this->m_line.size() + (lineWriter.getColumnCount() * 64));
 		uint32_t i = 0;
 		for (i = 0; i < 9; ++i)
 		{
-			line += (i > 0) ? "\t" : "";
+			if (i > 0)
+			{
+				lineWriter.append('\t');
+			}
+			size_t fieldLength;
+			const char* field = getField(i, fieldLength);
+			lineWriter.append(field, fieldLength);
 			if (i == formatColumnIdx) // append the format info to the format columns
 			{
-				if (lineSplit.size() >= i && !lineSplit[i].empty())
+				if (fieldLength > 0)
 				{
-					line += lineSplit[i] + ":";
+					lineWriter.append(':');
 				}
-				line += getFormatString();
-			}
-			else if (lineSplit.size() >= i)
-			{
-				line += lineSplit[i];
+				lineWriter.append(lineWriter.getFormatString());
 			}
 		}
 
-		for (; i < headerPtr->getColumnNames().size(); ++i)
+		// the sample columns weren't split when the line was read, they are walked here
+		std::vector< uint32_t > alleleCounts(this->m_all_allele_ptrs.size() * 2);
+		const char* lineEnd = this->m_line.c_str() + this->m_line.size();
+		const char* sample = (this->m_field_count == 9 && this->m_field_ends[8] < this->m_line.size()) ? this->m_line.c_str() + this->m_field_ends[8] + 1 : nullptr;
+		for (; i < lineWriter.getColumnCount(); ++i)
 		{
-			auto columnName = headerPtr->getColumnNames()[i];
-			line += "\t";
-			if (lineSplit[i].empty())
+			lineWriter.append('\t');
+			size_t sampleLength = 0;
+			if (sample != nullptr)
+			{
+				const char* sampleEnd = (const char*)memchr(sample, '\t', lineEnd - sample);
+				sampleLength = ((sampleEnd != nullptr) ? sampleEnd : lineEnd) - sample;
+				lineWriter.append(sample, sampleLength);
+				sample = (sampleEnd != nullptr) ? sampleEnd + 1 : nullptr;
+			}
+			if (sampleLength == 0)
 			{
-				line += (samplePadding.size() > 0) ? samplePadding + ":" : "";
+				lineWriter.append(samplePadding);
 			}
 			else
 			{
-				line += lineSplit[i] + ":";
+				lineWriter.append(':');
+			}
+			auto& sampleColumn = lineWriter.getSampleColumn(i);
+			if (sampleColumn.active)
+			{
+				writeSampleCounts(lineWriter, sampleColumn, alleleCounts);
+			}
+			else
+			{
+				lineWriter.append(lineWriter.getBlankSampleCounts());
 			}
-			auto sampleCounts = (headerPtr->isActiveSampleColumnName(columnName)) ?  getSampleCounts(columnName) : getBlankSampleCounts();
-			line += sampleCounts;
-		}
-
-		return line + "\n";
-	}
-
-	std::string Variant::getFormatString()
-	{
-		std::string formatString = "";
-		for (auto i = 0; i < AllAlleleCountTypes.size(); ++i)
-		{
-			auto alleleCountType = AllAlleleCountTypes[i];
-			std::string suffix = (i < AllAlleleCountTypes.size() - 1) ? ":" : "";
-			std::string alleleTypeCountString = AlleleCountTypeToShortString(alleleCountType);
-			formatString += "DP_" + alleleTypeCountString + ":DP4_" + alleleTypeCountString + suffix;
 		}
-		return formatString;
-	}
 
-	std::string Variant::getBlankSampleCounts()
-	{
-		std::string alleleCountString = "";
-	    for (auto i = 0; i < AllAlleleCountTypes.size(); ++i)
-		{
-			alleleCountString += ".:.:";
-		}
-		alleleCountString += ".";
-		return alleleCountString;
+		lineWriter.append('\n');
 	}
 
-	std::string Variant::getSampleCounts(const std::string& sampleName)
+	void Variant::writeSampleCounts(VCFLineWriter& lineWriter, const VCFLineWriter::SampleColumn& sampleColumn, std::vector< uint32_t >& alleleCounts)
 	{
-		std::string alleleCountString = "";
 		for (auto i = 0; i < AllAlleleCountTypes.size(); ++i)
 		{
 			auto alleleCountType = AllAlleleCountTypes[i];
-			std::string suffix = (i < AllAlleleCountTypes.size() - 1) ? ":" : "";
-			std::string alleleTypeCountString = AlleleCountTypeToString(alleleCountType);
-			uint32_t totalCount = 0;
-			std::string sampleString = "";
-			for (size_t j = 0; j < m_all_allele_ptrs.size(); ++j)
+			if (i > 0)
 			{
-				auto allelePtr = m_all_allele_ptrs[j];
-				uint32_t forwardCount = allelePtr->getForwardCount(sampleName, alleleCountType);
-				uint32_t reverseCount = allelePtr->getReverseCount(sampleName, alleleCountType);
-				std::string prefix = (j == 0) ? "" : ",";
-
-				if (m_skip)
+				lineWriter.append(':');
+			}
+			if (m_skip)
+			{
+				lineWriter.append(".:", 2);
+				for (size_t j = 0; j < m_all_allele_ptrs.size(); ++j)
 				{
-					sampleString += prefix + ".,.";
+					lineWriter.append((j == 0) ? ".,." : ",.,.");
 				}
-				else
+				continue;
+			}
+			uint32_t totalCount = 0;
+			for (size_t j = 0; j < m_all_allele_ptrs.size(); ++j)
+			{
+				alleleCounts[j * 2] = (sampleColumn.indexed) ? m_all_allele_ptrs[j]->getCount(sampleColumn.sampleIndex, false, alleleCountType) : 0;
+				alleleCounts[(j * 2) + 1] = (sampleColumn.indexed) ? m_all_allele_ptrs[j]->getCount(sampleColumn.sampleIndex, true, alleleCountType) : 0;
+				totalCount += alleleCounts[j * 2] + alleleCounts[(j * 2) + 1];
+			}
+			lineWriter.appendCount(totalCount);
+			lineWriter.append(':');
+			for (size_t j = 0; j < alleleCounts.size(); ++j)
+			{
+				if (j > 0)
 				{
-					sampleString += prefix + std::to_string(forwardCount) + "," + std::to_string(reverseCount);
+					lineWriter.append(',');
 				}
-
-				totalCount += (forwardCount + reverseCount);
+				lineWriter.appendCount(alleleCounts[j]);
 			}
-			std::string totalCountString = (m_skip) ? "." : std::to_string(totalCount);
-			// alleleCountString += "DP<" + alleleTypeCountString + ">=" + totalCountString + ";DP4<" + alleleTypeCountString + ">=" + sampleString + ";";
-			alleleCountString += totalCountString + ":" + sampleString + suffix;
 		}
-		return alleleCountString;
 	}
 
 }
@@ -14,6 +14,7 @@
 #include <algorithm>
 
 #include "IVariant.h"
+#include "VCFLineWriter.h"
 #include "core/allele/Allele.h"
 #include "core/reference/Reference.h"
 #include "core/sample/Sample.h"
@@ -44,12 +45,12 @@ namespace graphite
 		position getPosition() override { return m_position; }
 		std::string getQual() const { return m_qual; }
 		std::string getFilter() const { return m_filter; }
-		std::unordered_map< std::string, std::string > getInfoFields() const { return m_info_fields; }
+		std::unordered_map< std::string, std::string > getInfoFields() const; // parsed on every call, the variant only keeps its line
 		std::string getID() const { return m_id; }
 		std::string getRef() { return std::string(this->m_ref_allele_ptr->getSequence()); }
 		IAllele::SharedPtr getRefAllelePtr() override { return this->m_ref_allele_ptr; }
 		std::vector< IAllele::SharedPtr > getAltAllelePtrs() override { return m_alt_allele_ptrs; }
-		std::string getVariantLine(IHeader::SharedPtr headerPtr) override;
+		void writeVariantLine(VCFLineWriter& lineWriter) override;
 		void processOverlappingAlleles() override;
 
 		uint32_t getAllelePrefixOverlapMaxCount(IAllele::SharedPtr allelePtr) override;
@@ -67,7 +68,7 @@ namespace graphite
 		void setAlleleOverlapMaxCountIfGreaterThan(IAllele::SharedPtr allelePtr, std::unordered_map< IAllele::SharedPtr, uint32_t >& alleleOverlapCountMap, uint32_t overlapCount);
 		void setRefAndAltAlleles(const std::string& ref, const std::vector< std::string >& alts);
 		std::string getInfoFieldsString();
-		std::string getSampleCounts(const std::string& sampleName);
+		void writeSampleCounts(VCFLineWriter& lineWriter, const VCFLineWriter::SampleColumn& sampleColumn, std::vector< uint32_t >& alleleCounts);
 
 		uint32_t m_max_prefix_match_length;
 		uint32_t m_max_suffix_match_length;
@@ -83,8 +84,9 @@ namespace graphite
 		IAllele::SharedPtr m_ref_allele_ptr;
 		std::vector< IAllele::SharedPtr > m_alt_allele_ptrs;
 		std::vector< IAllele::SharedPtr > m_all_allele_ptrs;
-		std::unordered_map< std::string, std::string > m_info_fields;
 		std::string m_line;
+		uint32_t m_field_ends[9]; // where each of the fixed columns, and FORMAT, ends in m_line
+		uint32_t m_field_count;
 		bool m_skip;
 		bool m_is_sv;
 		uint32_t m_read_length;
@@ -93,7 +95,9 @@ namespace graphite
 		uint32_t m_overlap; // the amount the region overlaps the critical section of the variant (used for getting alignments from this region)
 
 	private:
-		void setUnorderedMapKeyValue(const std::string& rawString);
+		const char* getField(size_t index, size_t& fieldLength) const;
+		bool getInfoValue(const char* key, std::string& value);
+		int getSVLengthFromInfo();
 		void setAlleles(Reference::SharedPtr referencePtr, const std::string& vcfReferenceString, const std::string& alts, uint32_t readLength);
 		void setAsDeletion(Reference::SharedPtr referencePtr, int svLength, uint32_t readLength);
 		void setAsDuplication(Reference::SharedPtr referencePtr, int svLength, uint32_t readLength);
@@ -101,8 +105,6 @@ namespace graphite
 		void setAsInsertion(const std::string& ref, const std::string& alt, uint32_t readLength);
 		void setAsStandardAlt(const std::string& ref, const std::string& alt, uint32_t readLength);
 
-		std::string getFormatString();
-		std::string getBlankSampleCounts();
 		std::vector< Region::SharedPtr > m_region_ptrs;
 	};
 
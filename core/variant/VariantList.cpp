@@ -1,11 +1,10 @@
 #include "VariantList.h"
 #include "Variant.h"
+#include "VCFLineWriter.h"
 #include "core/allele/EquivalentAllele.h"
 #include "core/file/BGZFFileWriter.h"
 
-#include "bgzf.h"
-#include "tabix.h"
-#include "knetfile.h"
+#include "htslib/bgzf.h"
 
 #include <unordered_set>
 
@@ -90,9 +89,12 @@ namespace graphite
 		{
 			bgzf_write(fp, headerPtr->getHeader().c_str(), headerPtr->getHeader().size());
 		}
+		VCFLineWriter lineWriter(nullptr, headerPtr);
 		for(const auto variantPtr : this->m_variant_ptrs)
 		{
-			bgzf_write(fp, variantPtr->getVariantLine(headerPtr).c_str(), variantPtr->getVariantLine(headerPtr).size());
+			lineWriter.clear();
+			variantPtr->writeVariantLine(lineWriter);
+			bgzf_write(fp, lineWriter.getBuffer().c_str(), lineWriter.getBuffer().size());
 		}
 		bgzf_close(fp);
 	}
@@ -302,15 +304,16 @@ namespace graphite
 
 	void VariantList::writeVariantList(IFileWriter::SharedPtr fileWriter, IHeader::SharedPtr headerPtr, bool printHeader)
 	{
+		VCFLineWriter lineWriter(fileWriter, headerPtr);
 		if (printHeader)
 		{
-			auto headerStr = headerPtr->getHeader();
-			fileWriter->write(headerStr.c_str(), headerStr.size());
+			lineWriter.writeHeader();
 		}
 		for(const auto variantPtr : this->m_variant_ptrs)
 		{
-			auto line = variantPtr->getVariantLine(headerPtr);
-			fileWriter->write(line.c_str(), line.size());
+			variantPtr->writeVariantLine(lineWriter);
+			lineWriter.endLine();
 		}
+		lineWriter.flush();
 	}
 }
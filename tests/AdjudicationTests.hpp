@@ -3,18 +3,16 @@
 
 #include "TestConfig.h"
 
-#include "core/reference/IReference.h"
-#include "core/util/ThreadPool.hpp"
-#include "core/variant/IVariantList.h"
-#include "core/variant/IVariant.h"
-#include "core/adjudicator/IAdjudicator.h"
-#include "core/mapping/MappingManager.h"
-
-#include "plugins/adjudicator/graph/GSSWGraph.h"
-#include "plugins/adjudicator/graph/GSSWAdjudicator.h"
-#include "plugins/adjudicator/graph/GSSWMapping.h"
-
-
+#include "core/region/Region.h"
+#include "core/reference/FastaReference.h"
+#include "core/variant/Variant.h"
+#include "core/variant/VariantList.h"
+#include "core/graph/GSSWGraph.h"
+#include "core/mapping/GSSWMapping.h"
+#include "core/adjudicator/GSSWAdjudicator.h"
+#include "core/sample/Sample.h"
+
+#include <string>
 #include <vector>
 
 namespace
@@ -22,730 +20,174 @@ namespace
 namespace adj_test
 {
 	using namespace graphite;
-	using namespace graphite::adjudicator;
-
-	class AdjudicationTest : public ::testing::Test
-	{
-		virtual void TearDown()
-		{
-			// clear all mappings after the test
-			MappingManager::Instance()->clearRegisteredMappings();
-		}
-	};
-
-	class ReferenceTest : public IReference
-	{
-	public:
-        ReferenceTest(Region::SharedPtr regionPtr, const char* sequence) : m_sequence(sequence) { this->m_region = regionPtr; }
-		~ReferenceTest() {}
 
-		const char* getSequence() override
-		{
-			return m_sequence;
-		}
-
-		size_t getSequenceSize() override
-		{
-			return strlen(m_sequence);
-		}
-
-	private:
-		const char* m_sequence;
-	};
-
-	class VariantListTest : public IVariantList
-	{
-	public:
-		VariantListTest(std::vector< IVariant::SharedPtr > variants) : m_variant_list(variants), m_index(0) {}
-		~VariantListTest() {}
-
-		bool getNextVariant(IVariant::SharedPtr& variantPtr) override
-		{
-			if (this->m_variant_list.size() <= this->m_index) { variantPtr = nullptr; return false; }
-			else { variantPtr = this->m_variant_list[this->m_index++]; return true; }
-		}
-
-		size_t getCount() override { return this->m_variant_list.size(); }
-		void sort() override {}
-		void printToVCF(std::ostream& out) {}
-
-	private:
-		std::vector< IVariant::SharedPtr > m_variant_list;
-		uint32_t m_index;
-	};
+	static const uint32_t s_read_length = 20;
+	static const int s_match = 1;
+	static const int s_mismatch = 4;
+	static const int s_gap_open = 6;
+	static const int s_gap_extension = 1;
 
 	class AlignmentTest : public IAlignment
 	{
 	public:
-		AlignmentTest(const std::string sequence, position pos) : m_sequence(sequence), m_position(pos)
+		AlignmentTest(const std::string& sequence, position pos, Sample::SharedPtr samplePtr, bool isReverseStrand = false) :
+			m_sequence(sequence), m_position(pos), m_reverse_strand(isReverseStrand)
 		{
+			this->m_sample_ptr = samplePtr;
 		}
 		~AlignmentTest() {}
 
 		const char* getSequence() override { return this->m_sequence.c_str(); }
-		const size_t getLength() override { return this->m_sequence.size(); }
 		const position getPosition() override { return this->m_position; }
+		const size_t getLength() override { return this->m_sequence.size(); }
+		const bool isReverseStrand() override { return this->m_reverse_strand; }
 		const void setSequence(char* seq, uint32_t len) override {}
 		const void removeSequence() override {}
+		const void incrementReferenceCount() override {}
+
 	private:
 		std::string m_sequence;
 		position m_position;
+		bool m_reverse_strand;
 	};
 
-		GSSWGraph::SharedPtr getGSSWGraph(IReference::SharedPtr referencePtr, IVariantList::SharedPtr variantListPtr, IAdjudicator::SharedPtr adjudicatorPtr, uint32_t graphSize = 3000, uint32_t startPosition = 1)
-	{
-		// uint32_t startPosition = 1;
-		// uint32_t graphSize = 3000;
-		auto gsswGraphPtr = std::make_shared< GSSWGraph >(referencePtr, variantListPtr, startPosition, graphSize, adjudicatorPtr->getMatchValue(), adjudicatorPtr->getMisMatchValue(), adjudicatorPtr->getGapOpenValue(), adjudicatorPtr->getGapExtensionValue());
-		gsswGraphPtr->constructGraph();
-		return gsswGraphPtr;
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateDualSNPMatch)
-	{
-		ThreadPool::Instance()->setThreadCount(1);
-		std::string seq = TEST_REFERENCE_SEQUENCE;
-		auto regionPtr = std::make_shared< Region >("1:1-3720");
-		auto refAllelePtr = std::make_shared< Allele >("A");
-		auto altAllelePtr = std::make_shared< Allele >("G");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		position pos = 10;
-		std::string chrom = "1";
-		std::string dot = ".";
-		auto variantPtr = std::make_shared< Variant >(pos, chrom, dot, dot, dot, refAllelePtr, altAllelePtrs);
-		std::vector< IVariant::SharedPtr > variantPtrs = { variantPtr };
-		auto referencePtr = std::make_shared< ReferenceTest >(regionPtr, seq.c_str());
-		auto variantListPtr = std::make_shared< VariantList >(variantPtrs, referencePtr);
-
-		uint32_t percent = 80;
-		int match = 1;
-		int mismatch = 4;
-		int gapOpen = 6;
-		int gapExtension = 1;
-		auto gsswAdjudicatorPtr = std::make_shared< GSSWAdjudicator >(percent, match, mismatch, gapOpen, gapExtension);
-		auto gsswGraphPtr = getGSSWGraph(referencePtr, variantListPtr, gsswAdjudicatorPtr);
-		auto alignmentPtr = std::make_shared< AlignmentTest >("CTCAAGTAGAATCTACTCTCTCAGGTGTTCATAATGTATCAATGTATATTGCTTTAAGCCTGAAGGTAACCTAAGTAAAGATGTACCATGTTCCACCAATGCTTCTTTTGATCATCATTTTATCCTGTTTTTTCTTTAGGATTCTTTCTT", 2);
-
-		variantListPtr->processOverlappingAlleles();
-
-		auto gsswMappingPtr = std::make_shared< GSSWMapping >(gsswGraphPtr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		MappingManager::Instance()->registerMapping(gsswMappingPtr);
-		MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicatorPtr);
-		ThreadPool::Instance()->joinAll();
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 1);
-		ASSERT_EQ(gsswMappingPtr->getMappingScore(), (alignmentPtr->getLength() * match));
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateDualSNPMisMatch)
-	{
-		std::string seq = TEST_REFERENCE_SEQUENCE;
-		auto regionPtr = std::make_shared< Region >("1:1-3720");
-		auto refAllelePtr = std::make_shared< Allele >("A");
-		auto altAllelePtr = std::make_shared< Allele >("C");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		position pos = 10;
-		std::string chrom = "1";
-		std::string dot = ".";
-		auto variantPtr = std::make_shared< Variant >(pos, chrom, dot, dot, dot, refAllelePtr, altAllelePtrs);
-		std::vector< IVariant::SharedPtr > variantPtrs = { variantPtr };
-		auto referencePtr = std::make_shared< ReferenceTest >(regionPtr, seq.c_str());
-		auto variantListPtr = std::make_shared< VariantList >(variantPtrs, referencePtr);
-
-		uint32_t percent = 80;
-		int match = 1;
-		int mismatch = 4;
-		int gapOpen = 6;
-		int gapExtension = 1;
-		auto gsswAdjudicatorPtr = std::make_shared< GSSWAdjudicator >(percent, match, mismatch, gapOpen, gapExtension);
-		auto gsswGraphPtr = getGSSWGraph(referencePtr, variantListPtr, gsswAdjudicatorPtr);
-		auto alignmentPtr = std::make_shared< AlignmentTest >("CTCAAGTAGAATCTACTCTCTCAGGTGTTCATAATGTATCAATGTATATTGCTTTAAGCCTGAAGGTAACCTAAGTAAAGATGTACCATGTTCCACCAATGCTTCTTTTGATCATCATTTTATCCTGTTTTTTCTTTAGGATTCTTTCTT", 2);
-
-		variantListPtr->processOverlappingAlleles();
-
-		auto gsswMappingPtr = std::make_shared< GSSWMapping >(gsswGraphPtr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		MappingManager::Instance()->registerMapping(gsswMappingPtr);
-		MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicatorPtr);
-		ThreadPool::Instance()->joinAll();
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 0);
-		// ASSERT_EQ(gsswMappingPtr->getMappingScore(), (alignmentPtr->getLength() * match));
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateDuoSNPMatch)
-	{
-		std::string seq = TEST_REFERENCE_SEQUENCE;
-		auto regionPtr = std::make_shared< Region >("1:1-3720");
-		auto refAllelePtr = std::make_shared< Allele >("C");
-		auto altAllelePtr = std::make_shared< Allele >("G");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		position pos = 17;
-		std::string chrom = "1";
-		std::string dot = ".";
-		auto variantPtr = std::make_shared< Variant >(pos, chrom, dot, dot, dot, refAllelePtr, altAllelePtrs);
-		std::vector< IVariant::SharedPtr > variantPtrs = { variantPtr };
-		auto referencePtr = std::make_shared< ReferenceTest >(regionPtr, seq.c_str());
-		auto variantListPtr = std::make_shared< VariantList >(variantPtrs, referencePtr);
-
-		uint32_t percent = 80;
-		int match = 1;
-		int mismatch = 4;
-		int gapOpen = 6;
-		int gapExtension = 1;
-		size_t alignmentOffset = 9;
-		size_t alignmentSize = 150;
-		auto gsswAdjudicatorPtr = std::make_shared< GSSWAdjudicator >(percent, match, mismatch, gapOpen, gapExtension);
-		auto gsswGraphPtr = getGSSWGraph(referencePtr, variantListPtr, gsswAdjudicatorPtr);
-		auto alignmentPtr = std::make_shared< AlignmentTest >(std::string(seq.c_str() + alignmentOffset, alignmentSize), alignmentOffset);
-
-		variantListPtr->processOverlappingAlleles();
-
-		auto gsswMappingPtr = std::make_shared< GSSWMapping >(gsswGraphPtr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		MappingManager::Instance()->registerMapping(gsswMappingPtr);
-		MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicatorPtr);
-		ThreadPool::Instance()->joinAll();
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 1);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(gsswMappingPtr->getMappingScore(), (alignmentPtr->getLength() * match));
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateTriSNPMisMatch)
+	// a C>A SNP at 1:30 of the test fasta with a graph reaching one read length to either side
+	class AdjudicationFixture
 	{
-		std::string seq = TEST_REFERENCE_SEQUENCE;
-		auto regionPtr = std::make_shared< Region >("1:1-3720");
-		auto refAllelePtr = std::make_shared< Allele >("T");
-		auto altAllele1Ptr = std::make_shared< Allele >("G");
-		auto altAllele2Ptr = std::make_shared< Allele >("A");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllele1Ptr, altAllele2Ptr };
-		position pos = 15;
-		std::string chrom = "1";
-		std::string dot = ".";
-		auto variantPtr = std::make_shared< Variant >(pos, chrom, dot, dot, dot, refAllelePtr, altAllelePtrs);
-		std::vector< IVariant::SharedPtr > variantPtrs = { variantPtr };
-		auto referencePtr = std::make_shared< ReferenceTest >(regionPtr, seq.c_str());
-		auto variantListPtr = std::make_shared< VariantList >(variantPtrs, referencePtr);
-
-		uint32_t percent = 80;
-		int match = 1;
-		int mismatch = 4;
-		int gapOpen = 6;
-		int gapExtension = 1;
-		size_t alignmentOffset = 9;
-		size_t alignmentSize = 150;
-		auto gsswAdjudicatorPtr = std::make_shared< GSSWAdjudicator >(percent, match, mismatch, gapOpen, gapExtension);
-		auto gsswGraphPtr = getGSSWGraph(referencePtr, variantListPtr, gsswAdjudicatorPtr);
-		auto alignmentPtr = std::make_shared< AlignmentTest >(std::string(seq.c_str() + alignmentOffset, alignmentSize), alignmentOffset);
-
-		variantListPtr->processOverlappingAlleles();
-
-		auto gsswMappingPtr = std::make_shared< GSSWMapping >(gsswGraphPtr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		MappingManager::Instance()->registerMapping(gsswMappingPtr);
-		MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicatorPtr);
-		ThreadPool::Instance()->joinAll();
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 1);
-		ASSERT_EQ(altAllele1Ptr->getTotalCount(), 0);
-		ASSERT_EQ(altAllele2Ptr->getTotalCount(), 0);
-		ASSERT_EQ(gsswMappingPtr->getMappingScore(), (alignmentPtr->getLength() * match));
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateTriSNPMatch)
-	{
-		std::string seq = TEST_REFERENCE_SEQUENCE;
-		auto regionPtr = std::make_shared< Region >("1:1-3720");
-		auto refAllelePtr = std::make_shared< Allele >("T");
-		auto altAllele1Ptr = std::make_shared< Allele >("G");
-		auto altAllele2Ptr = std::make_shared< Allele >("A");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllele1Ptr, altAllele2Ptr };
-		position pos = 15;
-		std::string chrom = "1";
-		std::string dot = ".";
-		auto variantPtr = std::make_shared< Variant >(pos, chrom, dot, dot, dot, refAllelePtr, altAllelePtrs);
-		std::vector< IVariant::SharedPtr > variantPtrs = { variantPtr };
-		auto referencePtr = std::make_shared< ReferenceTest >(regionPtr, seq.c_str());
-		auto variantListPtr = std::make_shared< VariantList >(variantPtrs, referencePtr);
-
-		uint32_t percent = 80;
-		int match = 1;
-		int mismatch = 4;
-		int gapOpen = 6;
-		int gapExtension = 1;
-		auto gsswAdjudicatorPtr = std::make_shared< GSSWAdjudicator >(percent, match, mismatch, gapOpen, gapExtension);
-		auto gsswGraphPtr = getGSSWGraph(referencePtr, variantListPtr, gsswAdjudicatorPtr);
-		auto alignmentPtr = std::make_shared< AlignmentTest >("AAATCAACTCTCTCAGGTGTTCATAATGTATCAATGTATATTGCTTTAAGCCTGAAGGTAACCTAAGTAAAGATGTACCATGTTCCACCAATGCTTCTTTTGATCATCATTTTATCCTGTTTTTTCTTTAGGATTCTTTCTTATTCCTTC", 6);
-
-		variantListPtr->processOverlappingAlleles();
-
-		auto gsswMappingPtr = std::make_shared< GSSWMapping >(gsswGraphPtr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		MappingManager::Instance()->registerMapping(gsswMappingPtr);
-		MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicatorPtr);
-		ThreadPool::Instance()->joinAll();
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllele1Ptr->getTotalCount(), 0);
-		ASSERT_EQ(altAllele2Ptr->getTotalCount(), 1);
-		ASSERT_EQ(gsswMappingPtr->getMappingScore(), (alignmentPtr->getLength() * match));
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateShortDeletionMatch)
-	{
-		std::string seq = TEST_REFERENCE_SEQUENCE;
-		auto regionPtr = std::make_shared< Region >("1:1-3720");
-		auto refAllelePtr = std::make_shared< Allele >("AGGTGTTCATAATGT");
-		auto altAllele1Ptr = std::make_shared< Allele >("AT");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllele1Ptr };
-		position pos = 24;
-		std::string chrom = "1";
-		std::string dot = ".";
-		auto variantPtr = std::make_shared< Variant >(pos, chrom, dot, dot, dot, refAllelePtr, altAllelePtrs);
-		std::vector< IVariant::SharedPtr > variantPtrs = { variantPtr };
-		auto referencePtr = std::make_shared< ReferenceTest >(regionPtr, seq.c_str());
-		auto variantListPtr = std::make_shared< VariantList >(variantPtrs, referencePtr);
-
-		uint32_t percent = 80;
-		int match = 1;
-		int mismatch = 4;
-		int gapOpen = 6;
-		int gapExtension = 1;
-		auto gsswAdjudicatorPtr = std::make_shared< GSSWAdjudicator >(percent, match, mismatch, gapOpen, gapExtension);
-		auto gsswGraphPtr = getGSSWGraph(referencePtr, variantListPtr, gsswAdjudicatorPtr);
-		auto alignmentPtr = std::make_shared< AlignmentTest >("TACTCTCTCATATCAATGTATATTGCTTTAAGCCTGAAGGTAACCTAAGTAAAGATGTACCATGTTCCACCAATGCTTCTTTTGATCATCATTTTATCCTGTTTTTTCTTTAGGATTCTTTCTTATTCCTTCCCCTG", 6);
-
-		variantListPtr->processOverlappingAlleles();
-
-		auto gsswMappingPtr = std::make_shared< GSSWMapping >(gsswGraphPtr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		// this is why you aren't deleting mappings
-		MappingManager::Instance()->registerMapping(gsswMappingPtr);
-		MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicatorPtr);
-		ThreadPool::Instance()->joinAll();
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllele1Ptr->getTotalCount(), 1);
-		ASSERT_EQ(gsswMappingPtr->getMappingScore(), (alignmentPtr->getLength() * match));
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateShortInsertionMatch)
-	{
-		std::string seq = TEST_REFERENCE_SEQUENCE;
-		auto regionPtr = std::make_shared< Region >("1:1-3720");
-
-		auto refAllelePtr = std::make_shared< Allele >("A");
-		auto altAllele1Ptr = std::make_shared< Allele >("AGGGGGGGGGG");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllele1Ptr };
-		position pos = 5;
-		std::string chrom = "1";
-		std::string dot = ".";
-		auto variantPtr = std::make_shared< Variant >(pos, chrom, dot, dot, dot, refAllelePtr, altAllelePtrs);
-		std::vector< IVariant::SharedPtr > variantPtrs = { variantPtr };
-		auto referencePtr = std::make_shared< ReferenceTest >(regionPtr, seq.c_str());
-		auto variantListPtr = std::make_shared< VariantList >(variantPtrs, referencePtr);
-
-		uint32_t percent = 80;
-		int match = 1;
-		int mismatch = 4;
-		int gapOpen = 6;
-		int gapExtension = 1;
-		auto gsswAdjudicatorPtr = std::make_shared< GSSWAdjudicator >(percent, match, mismatch, gapOpen, gapExtension);
-		auto gsswGraphPtr = getGSSWGraph(referencePtr, variantListPtr, gsswAdjudicatorPtr);
-		auto alignmentPtr = std::make_shared< AlignmentTest >("ACTCAGGGGGGGGGGAGTAAAATCTACTCTCTCAGGTGTTCATAATGTATCAATGTATATTGCTTTAAGCCTGAAGGTAACCTAAGTAAAGATGTACCATGTTCCACCAATGCTTCTTTTGATCATCATTTTATCCTGTTTTTTCTTTAGGATTCTTTCT", 1);
-
-		variantListPtr->processOverlappingAlleles();
-
-		auto gsswMappingPtr = std::make_shared< GSSWMapping >(gsswGraphPtr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		MappingManager::Instance()->registerMapping(gsswMappingPtr);
-		MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicatorPtr);
-		ThreadPool::Instance()->joinAll();
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllele1Ptr->getTotalCount(), 1);
-		ASSERT_EQ(gsswMappingPtr->getMappingScore(), (alignmentPtr->getLength() * match));
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateShortInsertionMultipleMatch)
-	{
-		std::string seq = TEST_REFERENCE_SEQUENCE;
-		auto regionPtr = std::make_shared< Region >("1:1-3720");
-
-		auto refAllelePtr = std::make_shared< Allele >("A");
-		auto altAllele1Ptr = std::make_shared< Allele >("AGGGGGGGGGG");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllele1Ptr };
-		position pos = 5;
-		std::string chrom = "1";
-		std::string dot = ".";
-		auto variantPtr = std::make_shared< Variant >(pos, chrom, dot, dot, dot, refAllelePtr, altAllelePtrs);
-		std::vector< IVariant::SharedPtr > variantPtrs = { variantPtr };
-		auto referencePtr = std::make_shared< ReferenceTest >(regionPtr, seq.c_str());
-		auto variantListPtr = std::make_shared< VariantList >(variantPtrs, referencePtr);
-
-		uint32_t percent = 80;
-		int match = 1;
-		int mismatch = 4;
-		int gapOpen = 6;
-		int gapExtension = 1;
-		auto gsswAdjudicatorPtr = std::make_shared< GSSWAdjudicator >(percent, match, mismatch, gapOpen, gapExtension);
-		auto gsswGraphPtr = getGSSWGraph(referencePtr, variantListPtr, gsswAdjudicatorPtr);
-		auto alignmentPtr = std::make_shared< AlignmentTest >("ACTCAGGGGGGGGGGAGTAAAATCTACTCTCTCAGGTGTTCATAATGTATCAATGTATATTGCTTTAAGCCTGAAGGTAACCTAAGTAAAGATGTACCATGTTCCACCAATGCTTCTTTTGATCATCATTTTATCCTGTTTTTTCTTTAGGATTCTTTCT", 1);
-
-		variantListPtr->processOverlappingAlleles();
-
-		auto gsswMappingPtr = std::make_shared< GSSWMapping >(gsswGraphPtr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		MappingManager::Instance()->registerMapping(gsswMappingPtr);
-		MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicatorPtr);
-		ThreadPool::Instance()->joinAll();
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllele1Ptr->getTotalCount(), 1);
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateDualIdenticalIntoVariant)
-	{
-		std::string seq = TEST_REFERENCE_SEQUENCE;
-		auto regionPtr = std::make_shared< Region >("1:1-3720");
-
-		auto refAllelePtr = std::make_shared< Allele >("TTCCCCTGACCCT");
-		auto altAllele1Ptr = std::make_shared< Allele >("TTCCCCTGTTTTATCTTTT");
-		auto altAllele2Ptr = std::make_shared< Allele >("TTCCGTTTTATCTTTT");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllele1Ptr, altAllele2Ptr };
-		position pos = 157;
-		std::string chrom = "1";
-		std::string dot = ".";
-		auto variantPtr = std::make_shared< Variant >(pos, chrom, dot, dot, dot, refAllelePtr, altAllelePtrs);
-		variantPtr->processOverlappingAlleles();
-		std::vector< IVariant::SharedPtr > variantPtrs = { variantPtr };
-		auto referencePtr = std::make_shared< ReferenceTest >(regionPtr, seq.c_str());
-		auto variantListPtr = std::make_shared< VariantList >(variantPtrs, referencePtr);
-
-		uint32_t percent = 80;
-		int match = 1;
-		int mismatch = 4;
-		int gapOpen = 6;
-		int gapExtension = 1;
-		auto gsswAdjudicatorPtr = std::make_shared< GSSWAdjudicator >(percent, match, mismatch, gapOpen, gapExtension);
-		auto gsswGraphPtr = getGSSWGraph(referencePtr, variantListPtr, gsswAdjudicatorPtr);
-		auto alignmentPtr = std::make_shared< AlignmentTest >("GTTTTATCTTTTATTCTCCAAATTTCTTTCCAATTCATCTTTGTTCTTCCCTTTCCTTTTTACTCTCTTTAAACATTCTATGGACTCTGCCTCCTTCACACTGATATTGAACGCCCATAGTTTCATATTTTGGATTGCGATTGTTTTATT", 1);
-
-		variantListPtr->processOverlappingAlleles();
-
-		auto gsswMappingPtr = std::make_shared< GSSWMapping >(gsswGraphPtr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		MappingManager::Instance()->registerMapping(gsswMappingPtr);
-		MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicatorPtr);
-		ThreadPool::Instance()->joinAll();
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllele1Ptr->getTotalCount(), 0);
-		ASSERT_EQ(altAllele2Ptr->getTotalCount(), 0);
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateDualIdenticalOutOfVariant)
-	{
-		std::string seq = TEST_REFERENCE_SEQUENCE;
-		auto regionPtr = std::make_shared< Region >("1:1-3720");
-
-		auto refAllelePtr = std::make_shared< Allele >("TGACCCTTCTTTTATTCTC");
-		auto altAllele1Ptr = std::make_shared< Allele >("TGACCCTTACCTG");
-		auto altAllele2Ptr = std::make_shared< Allele >("TGACCCTTGATT");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllele1Ptr, altAllele2Ptr };
-		position pos = 163;
-		std::string chrom = "1";
-		std::string dot = ".";
-		auto variantPtr = std::make_shared< Variant >(pos, chrom, dot, dot, dot, refAllelePtr, altAllelePtrs);
-		variantPtr->processOverlappingAlleles();
-		std::vector< IVariant::SharedPtr > variantPtrs = { variantPtr };
-		auto referencePtr = std::make_shared< ReferenceTest >(regionPtr, seq.c_str());
-		auto variantListPtr = std::make_shared< VariantList >(variantPtrs, referencePtr);
-
-		uint32_t percent = 80;
-		int match = 1;
-		int mismatch = 4;
-		int gapOpen = 6;
-		int gapExtension = 1;
-		auto gsswAdjudicatorPtr = std::make_shared< GSSWAdjudicator >(percent, match, mismatch, gapOpen, gapExtension);
-		auto gsswGraphPtr = getGSSWGraph(referencePtr, variantListPtr, gsswAdjudicatorPtr);
-		auto alignmentPtr = std::make_shared< AlignmentTest >("CTCAGGTGTTCATAATGTATCAATGTATATTGCTTTAAGCCTGAAGGTAACCTAAGTAAAGATGTACCATGTTCCACCAATGCTTCTTTTGATCATCATTTTATCCTGTTTTTTCTTTAGGATTCTTTCTTATTCCTTCCCCTGACCCTT", 1);
-
-		variantListPtr->processOverlappingAlleles();
-
-		auto gsswMappingPtr = std::make_shared< GSSWMapping >(gsswGraphPtr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		// gsswMappingPtr->printLongFormat();
-		MappingManager::Instance()->registerMapping(gsswMappingPtr);
-		MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicatorPtr);
-		ThreadPool::Instance()->joinAll();
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllele1Ptr->getTotalCount(), 0);
-		ASSERT_EQ(altAllele2Ptr->getTotalCount(), 0);
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateRemapPreviouslyMappedAlignment)
-	{
-		ThreadPool::Instance()->setThreadCount(1);
-		std::string seq = TEST_REFERENCE_SEQUENCE;
-		auto regionPtr = std::make_shared< Region >("1:1-3720");
-
-		auto refAllele1Ptr = std::make_shared< Allele >("C");
-		auto altAllele1Ptr = std::make_shared< Allele >("G");
-		std::vector< IAllele::SharedPtr > altAllele1Ptrs = { altAllele1Ptr };
-		position pos1 = 17;
-		std::string chrom = "1";
-		std::string dot = ".";
-		auto variant1Ptr = std::make_shared< Variant >(pos1, chrom, dot, dot, dot, refAllele1Ptr, altAllele1Ptrs);
-
-		auto refAllele2Ptr = std::make_shared< Allele >("TGAC");
-		auto altAllele2Ptr = std::make_shared< Allele >("ATCTATTCTCTCAGG");
-		std::vector< IAllele::SharedPtr > altAllele2Ptrs = { altAllele2Ptr };
-		position pos2 = 3503;
-		auto variant2Ptr = std::make_shared< Variant >(pos2, chrom, dot, dot, dot, refAllele2Ptr, altAllele2Ptrs);
-
-		std::vector< IVariant::SharedPtr > variant1Ptrs = { variant1Ptr };
-		std::vector< IVariant::SharedPtr > variant2Ptrs = { variant2Ptr };
-		auto referencePtr = std::make_shared< ReferenceTest >(regionPtr, seq.c_str());
-		auto variantList1Ptr = std::make_shared< VariantList >(variant1Ptrs, referencePtr);
-		auto variantList2Ptr = std::make_shared< VariantList >(variant2Ptrs, referencePtr);
-
-		uint32_t percent = 50;
-		int match = 1;
-		int mismatch = 4;
-		int gapOpen = 6;
-		int gapExtension = 1;
-		auto gsswAdjudicatorPtr = std::make_shared< GSSWAdjudicator >(percent, match, mismatch, gapOpen, gapExtension);
-		auto gsswGraph1Ptr = getGSSWGraph(referencePtr, variantList1Ptr, gsswAdjudicatorPtr, 1000, 1);
-		auto gsswGraph2Ptr = getGSSWGraph(referencePtr, variantList2Ptr, gsswAdjudicatorPtr, 3000, 500);
-		auto alignmentPtr = std::make_shared< AlignmentTest >("AGTAAAATCTATTCTCTCAGGT", 2);
-
-		variantList1Ptr->processOverlappingAlleles();
-		variantList2Ptr->processOverlappingAlleles();
-
-		auto gsswMapping1Ptr = std::make_shared< GSSWMapping >(gsswGraph1Ptr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		auto gsswMapping2Ptr = std::make_shared< GSSWMapping >(gsswGraph2Ptr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		MappingManager::Instance()->registerMapping(gsswMapping1Ptr);
-		MappingManager::Instance()->registerMapping(gsswMapping2Ptr);
-		MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicatorPtr);
-		ThreadPool::Instance()->joinAll();
-
-		ASSERT_EQ(refAllele1Ptr->getTotalCount(), 0);
-		ASSERT_EQ(altAllele1Ptr->getTotalCount(), 0);
-		ASSERT_EQ(refAllele2Ptr->getTotalCount(), 0);
-		ASSERT_EQ(altAllele2Ptr->getTotalCount(), 1);
-
-	}
-
-	void adjudicateAlleles(const std::string& seq, position pos, Allele::SharedPtr refAllelePtr, std::vector< IAllele::SharedPtr > altAllelePtrs, IAlignment::SharedPtr alignmentPtr)
-	{
-		auto regionPtr = std::make_shared< Region >("1:0-" + std::to_string(seq.size()));
-		std::string chrom = "1";
-		std::string dot = ".";
-		auto variantPtr = std::make_shared< Variant >(pos, chrom, dot, dot, dot, refAllelePtr, altAllelePtrs);
-		variantPtr->processOverlappingAlleles();
-		std::vector< IVariant::SharedPtr > variantPtrs = { variantPtr };
-		auto referencePtr = std::make_shared< ReferenceTest >(regionPtr, seq.c_str());
-		auto variantListPtr = std::make_shared< VariantList >(variantPtrs, referencePtr);
-
-		uint32_t percent = 80;
-		int match = 1;
-		int mismatch = 4;
-		int gapOpen = 6;
-		int gapExtension = 1;
-		auto gsswAdjudicatorPtr = std::make_shared< GSSWAdjudicator >(percent, match, mismatch, gapOpen, gapExtension);
-		auto gsswGraphPtr = getGSSWGraph(referencePtr, variantListPtr, gsswAdjudicatorPtr, seq.size(), 0);
-		variantListPtr->processOverlappingAlleles();
-
-		auto gsswMappingPtr = std::make_shared< GSSWMapping >(gsswGraphPtr->traceBackAlignment(alignmentPtr), alignmentPtr);
-		MappingManager::Instance()->registerMapping(gsswMappingPtr);
-		MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicatorPtr);
-		ThreadPool::Instance()->joinAll();
-	}
-
-		/*
-		  The key to the test names are
-		  Adjudicate{quality}{type}Match{W/P/N/A}
-		  W = whole node match
-		  P = partial node match
-		  N = does not go through node
-		  A = ambiguous, no call
-		 */
-	TEST_F(AdjudicationTest, AdjudicateExactReferenceMatchWWW)
-	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("TAG");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("ATACGTTTACGCTTACGT", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 1);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 0);
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateExactRefMatchWWP)
-	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("TAG");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("ATACGTTTACG", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 1);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 0);
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateExactRefMatchPWW)
-	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("TAG");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("TTTACGCTTACGT", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 1);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 0);
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateExactRefMatchPWP)
-	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("TAG");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("TTTACG", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 1);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 0);
-	}
-
-    TEST_F(AdjudicationTest, AdjudicateExactAltMatchWWW)
-	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("TAG");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("ATACGTTAGCTTACGT", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 1);
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateExactAltMatchWWP)
-	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("TAG");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("ATACGTTAGC", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 1);
-	}
-
-	TEST_F(AdjudicationTest, AdjudicateExactAltMatchPWP)
-	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("TAG");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("TTAGC", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
+	public:
+		AdjudicationFixture(bool useSWKernels = false)
+		{
+			std::string vcfLine = "1\t30\t.\tC\tA\t.\tPASS\t.\tGT\t0\t0";
+			auto regionPtr = std::make_shared< Region >("1", Region::BASED::ONE);
+			referencePtr = std::make_shared< FastaReference >(TEST_FASTA_FILE, regionPtr);
+			variantPtr = Variant::BuildVariant(vcfLine.c_str(), referencePtr, s_read_length);
+			std::vector< IVariant::SharedPtr > variantPtrs = { variantPtr };
+			auto variantListPtr = std::make_shared< VariantList >(variantPtrs, referencePtr);
+			variantListPtr->processOverlappingAlleles();
+
+			auto graphRegionPtr = std::make_shared< Region >("1", variantPtr->getPosition() - s_read_length, variantPtr->getPosition() + s_read_length, Region::BASED::ONE);
+			gsswGraphPtr = std::make_shared< GSSWGraph >(referencePtr, variantListPtr, graphRegionPtr, s_match, s_mismatch, s_gap_open, s_gap_extension, 1, useSWKernels);
+			gsswGraphPtr->constructGraph();
+			adjudicatorPtr = std::make_shared< GSSWAdjudicator >(80, s_match, s_mismatch, s_gap_open, s_gap_extension);
+		}
 
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 1);
-	}
+		// reference bases 21 through 40 with the variant base replaced
+		std::string readWithBase(char base)
+		{
+			auto readRegionPtr = std::make_shared< Region >("1", 21, 40, Region::BASED::ONE);
+			std::string read = referencePtr->getSequenceFromRegion(readRegionPtr);
+			read[9] = base;
+			return read;
+		}
 
-	TEST_F(AdjudicationTest, AdjudicateExactAltMatchPWW)
-	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("TAG");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("TTAGCTTACGT", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
+		bool adjudicate(const std::string& read, Sample::SharedPtr samplePtr, uint32_t referenceSWPercent, bool isReverseStrand = false)
+		{
+			auto alignmentPtr = std::make_shared< AlignmentTest >(read, 21, samplePtr, isReverseStrand);
+			auto graphContainerPtr = gsswGraphPtr->getGraphContainer();
+			auto gsswMappingPtr = std::make_shared< GSSWMapping >(gsswGraphPtr->traceBackAlignment(alignmentPtr, graphContainerPtr), alignmentPtr);
+			gsswGraphPtr->checkinGraphContainer(graphContainerPtr);
+			return adjudicatorPtr->adjudicateMapping(gsswMappingPtr, referenceSWPercent);
+		}
 
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 1);
-	}
+		FastaReference::SharedPtr referencePtr;
+		Variant::SharedPtr variantPtr;
+		GSSWGraph::SharedPtr gsswGraphPtr;
+		GSSWAdjudicator::SharedPtr adjudicatorPtr;
+	};
 
-	TEST_F(AdjudicationTest, AdjudicateExactAltMatchWPN)
+	TEST(AdjudicationTests, AltReadCountsTheAltAllele)
 	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("TAG");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("TTA", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
+		AdjudicationFixture fixture;
+		auto samplePtr = std::make_shared< Sample >("adjudication_alt", "", "");
+		ASSERT_TRUE(fixture.adjudicate(fixture.readWithBase('A'), samplePtr, 75)); // one mismatch against the reference
 
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 1);
+		auto refAllelePtr = fixture.variantPtr->getRefAllelePtr();
+		auto altAllelePtr = fixture.variantPtr->getAltAllelePtrs()[0];
+		ASSERT_EQ(altAllelePtr->getForwardCount("adjudication_alt", AlleleCountType::NinteyFivePercent), 1);
+		ASSERT_EQ(altAllelePtr->getReverseCount("adjudication_alt", AlleleCountType::NinteyFivePercent), 0);
+		ASSERT_EQ(refAllelePtr->getTotalCount(AlleleCountType::NinteyFivePercent), 0);
+		ASSERT_EQ(refAllelePtr->getTotalCount(AlleleCountType::Ambiguous), 0);
 	}
 
-	TEST_F(AdjudicationTest, AdjudicateExactAltMatchNPW)
+	TEST(AdjudicationTests, RefReadCountsTheRefAllele)
 	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("TAG");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("TTAGCTTACGT", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
+		AdjudicationFixture fixture;
+		auto samplePtr = std::make_shared< Sample >("adjudication_ref", "", "");
+		ASSERT_TRUE(fixture.adjudicate(fixture.readWithBase('C'), samplePtr, 100, true));
 
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 1);
+		auto refAllelePtr = fixture.variantPtr->getRefAllelePtr();
+		auto altAllelePtr = fixture.variantPtr->getAltAllelePtrs()[0];
+		ASSERT_EQ(refAllelePtr->getReverseCount("adjudication_ref", AlleleCountType::NinteyFivePercent), 1);
+		ASSERT_EQ(refAllelePtr->getForwardCount("adjudication_ref", AlleleCountType::NinteyFivePercent), 0);
+		for (auto alleleCountType : AllAlleleCountTypes)
+		{
+			ASSERT_EQ(altAllelePtr->getTotalCount(alleleCountType), 0);
+		}
 	}
 
-	TEST_F(AdjudicationTest, AdjudicateExactAltMatchNWN)
+	TEST(AdjudicationTests, AltReadScoringLikeTheReferenceIsAmbiguous)
 	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("AGGGACCTAGGCT");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("AGGGACCTAGGCT", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
+		AdjudicationFixture fixture;
+		auto samplePtr = std::make_shared< Sample >("adjudication_ambiguous", "", "");
+		ASSERT_TRUE(fixture.adjudicate(fixture.readWithBase('A'), samplePtr, 100));
 
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 1);
+		auto altAllelePtr = fixture.variantPtr->getAltAllelePtrs()[0];
+		ASSERT_EQ(altAllelePtr->getForwardCount("adjudication_ambiguous", AlleleCountType::Ambiguous), 1);
+		ASSERT_EQ(altAllelePtr->getForwardCount("adjudication_ambiguous", AlleleCountType::NinteyFivePercent), 0);
 	}
 
-	TEST_F(AdjudicationTest, AdjudicateExactAltMatchNPN)
+	// counts land as each mapping is adjudicated, there is nothing left to flush afterwards
+	TEST(AdjudicationTests, CountsArePerSampleAndImmediate)
 	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("AGGGACCTAGGCT");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("GGACCTAGG", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
-
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 1);
+		AdjudicationFixture fixture;
+		auto firstSamplePtr = std::make_shared< Sample >("adjudication_first", "", "");
+		auto secondSamplePtr = std::make_shared< Sample >("adjudication_second", "", "");
+		auto altAllelePtr = fixture.variantPtr->getAltAllelePtrs()[0];
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			fixture.adjudicate(fixture.readWithBase('A'), firstSamplePtr, 75);
+			ASSERT_EQ(altAllelePtr->getForwardCount("adjudication_first", AlleleCountType::NinteyFivePercent), i + 1);
+		}
+		fixture.adjudicate(fixture.readWithBase('A'), secondSamplePtr, 75, true);
+		ASSERT_EQ(altAllelePtr->getForwardCount("adjudication_first", AlleleCountType::NinteyFivePercent), 3);
+		ASSERT_EQ(altAllelePtr->getReverseCount("adjudication_second", AlleleCountType::NinteyFivePercent), 1);
+		ASSERT_EQ(altAllelePtr->getTotalCount(AlleleCountType::NinteyFivePercent), 4);
 	}
 
-	TEST_F(AdjudicationTest, AdjudicateExactAmbiguousWAN)
+	// gssw scores a batch one read at a time, the kernels side by side in their lanes, the scores have to be the same
+	TEST(AdjudicationTests, BatchScoresMatchWithAndWithoutKernels)
 	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACG");
-		auto altAllelePtr = std::make_shared< Allele >("TTACT");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("ATACGTTTAC", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
+		AdjudicationFixture gsswFixture;
+		AdjudicationFixture kernelFixture(true);
+		std::string read = gsswFixture.readWithBase('A');
+		std::vector< std::string > reads = { read, gsswFixture.readWithBase('C'), read.substr(0, 8), read.substr(5), read.substr(0, 6) + read.substr(9), read.substr(0, 12) + "TT" + read.substr(12), "GGGGGGGGGG" };
+		std::vector< IAlignment::SharedPtr > alignmentPtrs;
+		for (auto& batchRead : reads)
+		{
+			alignmentPtrs.emplace_back(std::make_shared< AlignmentTest >(batchRead, 21, nullptr));
+		}
 
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 0);
-	}
+		std::vector< GraphSmithWaterman::ReadScore > gsswScores;
+		auto gsswContainerPtr = gsswFixture.gsswGraphPtr->getGraphContainer();
+		gsswFixture.gsswGraphPtr->scoreAlignments(alignmentPtrs, gsswContainerPtr, gsswScores);
+		gsswFixture.gsswGraphPtr->checkinGraphContainer(gsswContainerPtr);
 
-	TEST_F(AdjudicationTest, AdjudicateExactAmbiguousNAW)
-	{
-		std::string seq = "ATACGTTTACGCTTACGT";
-		auto refAllelePtr = std::make_shared< Allele >("TTACGCT");
-		auto altAllelePtr = std::make_shared< Allele >("TGGCGCT");
-		std::vector< IAllele::SharedPtr > altAllelePtrs = { altAllelePtr };
-		auto alignmentPtr = std::make_shared< AlignmentTest >("CGCTTACGT", 0);
-		adjudicateAlleles(seq, 6, refAllelePtr, altAllelePtrs, alignmentPtr);
+		std::vector< GraphSmithWaterman::ReadScore > kernelScores;
+		auto kernelContainerPtr = kernelFixture.gsswGraphPtr->getGraphContainer();
+		kernelFixture.gsswGraphPtr->scoreAlignments(alignmentPtrs, kernelContainerPtr, kernelScores);
+		kernelFixture.gsswGraphPtr->checkinGraphContainer(kernelContainerPtr);
 
-		ASSERT_EQ(refAllelePtr->getTotalCount(), 0);
-		ASSERT_EQ(altAllelePtr->getTotalCount(), 0);
+		ASSERT_EQ(gsswScores.size(), reads.size());
+		ASSERT_EQ(kernelScores.size(), reads.size());
+		for (size_t i = 0; i < reads.size(); ++i)
+		{
+			ASSERT_EQ(gsswScores[i].score, kernelScores[i].score) << reads[i];
+			if (gsswScores[i].score > 0)
+			{
+				ASSERT_EQ(gsswScores[i].endNode, kernelScores[i].endNode) << reads[i];
+				ASSERT_EQ(gsswScores[i].endColumn, kernelScores[i].endColumn) << reads[i];
+			}
+		}
 	}
 }
 }
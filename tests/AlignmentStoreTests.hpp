@@ -0,0 +1,169 @@
+#ifndef GRAPHITE_ALIGNMENTSTORETESTS_HPP
+#define GRAPHITE_ALIGNMENTSTORETESTS_HPP
+
+#include "core/alignment/AlignmentStore.h"
+#include "core/alignment/StoredAlignment.h"
+#include "core/sample/Sample.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+namespace alignment_store_test
+{
+	using namespace graphite;
+
+	TEST(AlignmentStoreTests, ReadsRoundTripThroughThePackedRecords)
+	{
+		auto samplePtr = std::make_shared< Sample >("store_sample", "store_rg", "");
+		auto alignmentStorePtr = std::make_shared< AlignmentStore >();
+		alignmentStorePtr->addAlignment(200, "read2", "ACGTNRYacgt", samplePtr, false, true, true, false, 60);
+		alignmentStorePtr->addAlignment(100, "read1", "TTGCA", samplePtr, true, true, false, true, 300);
+		alignmentStorePtr->sortByPosition();
+		ASSERT_EQ(alignmentStorePtr->getCount(), 2);
+
+		auto alignmentPtrs = alignmentStorePtr->getAlignmentPtrsInRegion(1, 1000);
+		ASSERT_EQ(alignmentPtrs.size(), 2);
+		ASSERT_EQ(alignmentPtrs[0]->getPosition(), 100);
+		ASSERT_STREQ(alignmentPtrs[0]->getSequence(), "TTGCA");
+		ASSERT_TRUE(alignmentPtrs[0]->isFirstMate());
+		ASSERT_TRUE(alignmentPtrs[0]->isDuplicate());
+		ASSERT_FALSE(alignmentPtrs[0]->isReverseStrand());
+		ASSERT_EQ(alignmentPtrs[0]->getOriginalMapQuality(), 255);
+		ASSERT_EQ(alignmentPtrs[1]->getPosition(), 200);
+		ASSERT_STREQ(alignmentPtrs[1]->getSequence(), "ACGTNRYACGT"); // lower case bases come back upper case
+		ASSERT_EQ(alignmentPtrs[1]->getLength(), 11);
+		ASSERT_TRUE(alignmentPtrs[1]->isReverseStrand());
+		ASSERT_FALSE(alignmentPtrs[1]->isFirstMate());
+		ASSERT_EQ(alignmentPtrs[1]->getOriginalMapQuality(), 60);
+		ASSERT_EQ(alignmentPtrs[1]->getSample(), samplePtr);
+
+		ASSERT_EQ(alignmentStorePtr->getAlignmentPtrsInRegion(150, 1000).size(), 1);
+		ASSERT_EQ(alignmentStorePtr->getAlignmentPtrsInRegion(1, 99).size(), 0);
+
+		// every call makes new views but they still point at the same read
+		auto otherAlignmentPtrs = alignmentStorePtr->getAlignmentPtrsInRegion(150, 1000);
+		ASSERT_NE(otherAlignmentPtrs[0], alignmentPtrs[1]);
+		ASSERT_EQ(otherAlignmentPtrs[0]->getRecordPtr(), alignmentPtrs[1]->getRecordPtr());
+	}
+
+	TEST(AlignmentStoreTests, ReadsInSeveralWindowsAreAddedOnce)
+	{
+		auto samplePtr = std::make_shared< Sample >("store_sample", "store_rg", "");
+		std::string longSequence(5000, 'G'); // longer than the first slab
+		auto firstWindowStorePtr = std::make_shared< AlignmentStore >(); // the window ends at 25
+		firstWindowStorePtr->addAlignment(10, "read1", "ACGT", samplePtr, true, true, false, false, 60);
+		firstWindowStorePtr->addAlignment(20, "read2", longSequence, samplePtr, true, true, false, false, 60);
+		firstWindowStorePtr->addAlignment(20, "read2", "CCCC", samplePtr, false, true, false, false, 60); // the other mate
+		auto secondWindowStorePtr = std::make_shared< AlignmentStore >();
+		secondWindowStorePtr->addAlignment(20, "read2", longSequence, samplePtr, true, true, false, false, 60); // crosses into the second window
+		secondWindowStorePtr->addAlignment(25, "read4", "AAAA", samplePtr, true, true, false, false, 60);
+		secondWindowStorePtr->addAlignment(30, "read3", "TTTTT", samplePtr, true, true, false, false, 60);
+
+		auto alignmentStorePtr = std::make_shared< AlignmentStore >();
+		alignmentStorePtr->addAlignments(firstWindowStorePtr, 0);
+		alignmentStorePtr->addAlignments(secondWindowStorePtr, 25);
+		alignmentStorePtr->sortByPosition();
+		ASSERT_EQ(alignmentStorePtr->getCount(), 5);
+
+		auto alignmentPtrs = alignmentStorePtr->getAlignmentPtrsInRegion(1, 100);
+		ASSERT_EQ(alignmentPtrs.size(), 5);
+		ASSERT_STREQ(alignmentPtrs[0]->getSequence(), "ACGT");
+		ASSERT_EQ(std::string(alignmentPtrs[1]->getSequence()), longSequence);
+		ASSERT_STREQ(alignmentPtrs[2]->getSequence(), "CCCC");
+		ASSERT_STREQ(alignmentPtrs[3]->getSequence(), "AAAA");
+		ASSERT_STREQ(alignmentPtrs[4]->getSequence(), "TTTTT");
+		ASSERT_EQ(alignmentPtrs[4]->getSample(), samplePtr);
+	}
+
+	TEST(AlignmentStoreTests, LongReadsAreFoundPastShorterOnes)
+	{
+		auto samplePtr = std::make_shared< Sample >("store_sample", "store_rg", "");
+		auto alignmentStorePtr = std::make_shared< AlignmentStore >();
+		alignmentStorePtr->addAlignment(10, "long", std::string(500, 'A'), samplePtr, true, true, false, false, 60);
+		for (position startPosition = 20; startPosition < 600; startPosition += 10)
+		{
+			alignmentStorePtr->addAlignment(startPosition, "short" + std::to_string(startPosition), "CCCCC", samplePtr, true, true, false, false, 60);
+		}
+		alignmentStorePtr->sortByPosition();
+		ASSERT_EQ(alignmentStorePtr->getMaxLength(), 500);
+
+		auto alignmentPtrs = alignmentStorePtr->getAlignmentPtrsInRegion(400, 405); // only the long read and the one at 400 reach it
+		ASSERT_EQ(alignmentPtrs.size(), 2);
+		ASSERT_EQ(alignmentPtrs[0]->getPosition(), 10);
+		ASSERT_EQ(alignmentPtrs[1]->getPosition(), 400);
+		ASSERT_EQ(alignmentStorePtr->getAlignmentPtrsInRegion(520, 522).size(), 1);
+	}
+
+	TEST(AlignmentStoreTests, ReadsInSeveralRegionsAreReturnedOnce)
+	{
+		auto samplePtr = std::make_shared< Sample >("store_sample", "store_rg", "");
+		auto alignmentStorePtr = std::make_shared< AlignmentStore >();
+		for (position startPosition = 0; startPosition < 1000; startPosition += 50)
+		{
+			alignmentStorePtr->addAlignment(startPosition, "read" + std::to_string(startPosition), std::string(100, 'G'), samplePtr, true, true, false, false, 60);
+		}
+		alignmentStorePtr->sortByPosition();
+
+		// the first two regions overlap and the third is close enough that reads cross into it
+		auto alignmentPtrs = alignmentStorePtr->getAlignmentPtrsInRegions({ {410, 420}, {200, 300}, {250, 280} });
+		std::vector< position > positions;
+		for (auto& alignmentPtr : alignmentPtrs)
+		{
+			positions.emplace_back(alignmentPtr->getPosition());
+		}
+		ASSERT_EQ(positions, std::vector< position >({ 100, 150, 200, 250, 300, 350, 400 }));
+		ASSERT_EQ(alignmentStorePtr->getAlignmentPtrsInRegions({}).size(), 0);
+	}
+
+	TEST(AlignmentStoreTests, ViewsKeepTheStoreAndDecodeOnDemand)
+	{
+		auto samplePtr = std::make_shared< Sample >("store_sample", "store_rg", "");
+		auto alignmentStorePtr = std::make_shared< AlignmentStore >();
+		alignmentStorePtr->addAlignment(100, "read1", "ACGTA", samplePtr, true, true, false, false, 60);
+		alignmentStorePtr->addAlignment(110, "read1", "GGCCT", samplePtr, false, true, false, false, 60);
+		alignmentStorePtr->sortByPosition();
+
+		auto alignmentPtrs = alignmentStorePtr->getAlignmentPtrsInRegion(1, 1000);
+		std::weak_ptr< AlignmentStore > alignmentStoreWPtr = alignmentStorePtr;
+		alignmentStorePtr = nullptr;
+		ASSERT_FALSE(alignmentStoreWPtr.expired()); // the views hold the store
+
+		ASSERT_EQ(alignmentPtrs[1]->getLength(), 5);
+		ASSERT_STREQ(alignmentPtrs[1]->getSequence(), "GGCCT");
+		ASSERT_STREQ(alignmentPtrs[0]->getSequence(), "ACGTA");
+		ASSERT_EQ(alignmentPtrs[0]->getNameHash(), AlignmentStore::HashName("read1", 5, true));
+		ASSERT_EQ(alignmentPtrs[1]->getNameHash(), AlignmentStore::HashName("read1", 5, false));
+		ASSERT_NE(alignmentPtrs[0]->getNameHash(), alignmentPtrs[1]->getNameHash()); // mates are told apart
+
+		alignmentPtrs[0]->removeSequence();
+		ASSERT_STREQ(alignmentPtrs[0]->getSequence(), "ACGTA");
+		alignmentPtrs.clear();
+		ASSERT_TRUE(alignmentStoreWPtr.expired());
+	}
+
+	TEST(AlignmentStoreTests, SetSequenceRejectsADifferentLength)
+	{
+		auto samplePtr = std::make_shared< Sample >("store_sample", "store_rg", "");
+		auto alignmentStorePtr = std::make_shared< AlignmentStore >();
+		alignmentStorePtr->addAlignment(100, "read1", "ACGTA", samplePtr, true, true, false, false, 60);
+		alignmentStorePtr->sortByPosition();
+		auto alignmentPtr = alignmentStorePtr->getAlignmentPtrsInRegion(1, 1000)[0];
+
+		std::string bases = "TTTTT";
+		alignmentPtr->setSequence(&bases[0], bases.size());
+		ASSERT_STREQ(alignmentPtr->getSequence(), "TTTTT");
+
+		std::string longerBases = "GGGGGG";
+		ASSERT_THROW(alignmentPtr->setSequence(&longerBases[0], longerBases.size()), std::runtime_error);
+		ASSERT_THROW(alignmentPtr->setSequence(&longerBases[0], 4), std::runtime_error);
+		ASSERT_STREQ(alignmentPtr->getSequence(), "TTTTT");
+
+		alignmentPtr->removeSequence(); // the stored bases are decoded again
+		ASSERT_STREQ(alignmentPtr->getSequence(), "ACGTA");
+	}
+}
+}
+
+#endif //GRAPHITE_ALIGNMENTSTORETESTS_HPP
@@ -7,13 +7,13 @@
 #include "core/variant/IVariantList.h"
 #include "core/variant/IVariant.h"
 #include "core/adjudicator/IAdjudicator.h"
-#include "core/mapping/MappingManager.h"
 
 #include "core/graph/GSSWGraph.h"
 #include "core/adjudicator/GSSWAdjudicator.h"
 #include "core/mapping/GSSWMapping.h"
 
 
+#include <thread>
 #include <vector>
 
 namespace
@@ -194,6 +194,58 @@ namespace adj_test
 		ASSERT_EQ(variantPtr->getAlleleSuffixOverlapMaxCount(altAllele1Ptr), 0);
 		ASSERT_EQ(variantPtr->getAlleleSuffixOverlapMaxCount(altAllele2Ptr), 0);
 	}
+
+	TEST(AlleleTest, countsAreKeptPerSampleStrandAndType)
+	{
+		auto sample1Ptr = std::make_shared< Sample >("allele_test_sample_1", "allele_test_rg_1", "");
+		auto sample2Ptr = std::make_shared< Sample >("allele_test_sample_2", "allele_test_rg_2", "");
+		auto sample1ReadgroupPtr = std::make_shared< Sample >("allele_test_sample_1", "allele_test_rg_3", "");
+		ASSERT_EQ(sample1Ptr->getIndex(), sample1ReadgroupPtr->getIndex());
+		ASSERT_NE(sample1Ptr->getIndex(), sample2Ptr->getIndex());
+
+		auto allelePtr = std::make_shared< Allele >("ACGT");
+		allelePtr->incrementReverseCount(sample1Ptr, AlleleCountType::NinteyFivePercent);
+		allelePtr->incrementCount(false, sample1ReadgroupPtr, AlleleCountType::NinteyFivePercent);
+		allelePtr->incrementCount(false, sample1Ptr, AlleleCountType::NinteyFivePercent);
+		allelePtr->incrementForwardCount(sample2Ptr, AlleleCountType::Ambiguous);
+
+		// a sample registered after the allele started counting
+		auto lateSamplePtr = std::make_shared< Sample >("allele_test_sample_late", "allele_test_rg_late", "");
+		allelePtr->incrementReverseCount(lateSamplePtr, AlleleCountType::LowPercent);
+
+		ASSERT_EQ(allelePtr->getForwardCount("allele_test_sample_1", AlleleCountType::NinteyFivePercent), 2);
+		ASSERT_EQ(allelePtr->getReverseCount("allele_test_sample_1", AlleleCountType::NinteyFivePercent), 1);
+		ASSERT_EQ(allelePtr->getForwardCount("allele_test_sample_1", AlleleCountType::Ambiguous), 0);
+		ASSERT_EQ(allelePtr->getForwardCount("allele_test_sample_2", AlleleCountType::Ambiguous), 1);
+		ASSERT_EQ(allelePtr->getReverseCount("allele_test_sample_late", AlleleCountType::LowPercent), 1);
+		ASSERT_EQ(allelePtr->getForwardCount("allele_test_unknown_sample", AlleleCountType::LowPercent), 0);
+		ASSERT_EQ(allelePtr->getTotalCount(AlleleCountType::Ambiguous), 5);
+		ASSERT_EQ(allelePtr->getCount(sample1Ptr->getIndex(), false, AlleleCountType::NinteyFivePercent), 2);
+		ASSERT_EQ(allelePtr->getCount(lateSamplePtr->getIndex(), true, AlleleCountType::LowPercent), 1);
+	}
+
+	TEST(AlleleTest, concurrentCountsAreNotLost)
+	{
+		auto samplePtr = std::make_shared< Sample >("allele_test_sample_1", "allele_test_rg_1", "");
+		auto allelePtr = std::make_shared< Allele >("ACGT");
+		std::vector< std::thread > threads;
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			threads.emplace_back([allelePtr, samplePtr, i]()
+			{
+				for (uint32_t j = 0; j < 10000; ++j)
+				{
+					allelePtr->incrementCount(i % 2 == 1, samplePtr, AlleleCountType::NinteyPercent);
+				}
+			});
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		ASSERT_EQ(allelePtr->getForwardCount("allele_test_sample_1", AlleleCountType::NinteyPercent), 40000);
+		ASSERT_EQ(allelePtr->getReverseCount("allele_test_sample_1", AlleleCountType::NinteyPercent), 40000);
+	}
 }
 }
 #endif //GRAPHITE_ALLELETESTS_HPP
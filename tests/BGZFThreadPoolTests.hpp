@@ -0,0 +1,69 @@
+#ifndef GRAPHITE_TESTS_BGZFTHREADPOOLTESTS_HPP
+#define GRAPHITE_TESTS_BGZFTHREADPOOLTESTS_HPP
+
+#include "core/util/BGZFThreadPool.hpp"
+#include "core/file/ASCIIGZFileReader.h"
+
+#include "htslib/bgzf.h"
+
+#include "TemporaryDirectory.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+namespace bgzf_thread_pool_test
+{
+	using namespace graphite;
+
+	TEST(BGZFThreadPoolTests, ThreadShareIsSmallAndAtLeastOne)
+	{
+		ASSERT_EQ(BGZFThreadPool::GetThreadShare(0), 1);
+		ASSERT_EQ(BGZFThreadPool::GetThreadShare(1), 1);
+		ASSERT_EQ(BGZFThreadPool::GetThreadShare(8), 2);
+		ASSERT_EQ(BGZFThreadPool::GetThreadShare(16), 4);
+		ASSERT_EQ(BGZFThreadPool::GetThreadShare(128), 4);
+	}
+
+	// enough lines for dozens of BGZF blocks so the pool's workers inflate them out of order
+	TEST(BGZFThreadPoolTests, LinesRoundTripThroughThePool)
+	{
+		test_util::TemporaryDirectory temporaryDirectory;
+		std::string path = temporaryDirectory.getFilePath("lines.txt.gz");
+		const uint32_t lineCount = 200000;
+		BGZF* bgzfPtr = bgzf_open(path.c_str(), "w");
+		ASSERT_NE(bgzfPtr, nullptr);
+		for (uint32_t i = 0; i < lineCount; ++i)
+		{
+			std::string line = "line\t" + std::to_string(i) + "\t" + std::string(i % 37, 'A' + (i % 26)) + "\n";
+			ASSERT_EQ(bgzf_write(bgzfPtr, line.c_str(), line.size()), static_cast< ssize_t >(line.size()));
+		}
+		ASSERT_EQ(bgzf_close(bgzfPtr), 0);
+
+		{
+			ASCIIGZFileReader reader(path); // bgzipped so it reads through the shared pool
+			ASSERT_NE(BGZFThreadPool::Instance()->getThreadPool()->pool, nullptr);
+			std::string line;
+			uint32_t count = 0;
+			while (reader.getNextLine(line))
+			{
+				ASSERT_STREQ(line.c_str(), ("line\t" + std::to_string(count) + "\t" + std::string(count % 37, 'A' + (count % 26))).c_str());
+				++count;
+			}
+			ASSERT_EQ(count, lineCount);
+		}
+	}
+
+	TEST(BGZFThreadPoolTests, SetThreadCountAfterFirstUseThrows)
+	{
+		auto bgzfThreadPoolPtr = BGZFThreadPool::Instance();
+		ASSERT_NE(bgzfThreadPoolPtr->getThreadPool()->pool, nullptr);
+		uint32_t threadCount = bgzfThreadPoolPtr->getThreadCount();
+		ASSERT_THROW(bgzfThreadPoolPtr->setThreadCount(threadCount + 1), std::runtime_error);
+		ASSERT_EQ(bgzfThreadPoolPtr->getThreadCount(), threadCount);
+	}
+}
+}
+
+#endif //GRAPHITE_TESTS_BGZFTHREADPOOLTESTS_HPP
@@ -5,6 +5,11 @@
 
 #include "core/region/Region.h"
 #include "core/reference/FastaReference.h"
+#include "core/reference/FastaFile.h"
+#include "TemporaryDirectory.hpp"
+
+#include <fstream>
+#include <stdexcept>
 
 TEST(FastaTests, GetBaseOneRegion)
 {
@@ -42,4 +47,141 @@ TEST(FastaTests, GetBaseZeroRegionSimple)
 	ASSERT_STREQ(regionString.c_str(), "A");
 }
 
+TEST(FastaTests, WrappedContigIsJoinedOnce)
+{
+	auto fastaFilePtr = std::make_shared< graphite::FastaFile >(TEST_FASTA_FILE);
+	auto fastaRegionPtr = std::make_shared< graphite::Region >("1", graphite::Region::BASED::ONE);
+	auto referencePtr = std::make_shared< graphite::FastaReference >(fastaFilePtr, fastaRegionPtr);
+	auto otherReferencePtr = std::make_shared< graphite::FastaReference >(fastaFilePtr, fastaRegionPtr);
+	ASSERT_EQ(referencePtr->getSequenceSize(), 3600);
+	ASSERT_EQ(referencePtr->getSequence(), otherReferencePtr->getSequence()); // both regions share the contig
+	ASSERT_FALSE(fastaFilePtr->getContig("1")->isMapped());
+	ASSERT_EQ(std::string(referencePtr->getSequence(), referencePtr->getSequenceSize()).find('\n'), std::string::npos);
+	auto regionPtr = std::make_shared< graphite::Region >("1:59-62", graphite::Region::BASED::ONE); // crosses the first line break
+	ASSERT_STREQ(referencePtr->getSequenceFromRegion(regionPtr).c_str(), "CAGA");
+	ASSERT_FALSE(fastaFilePtr->hasContig("2"));
+	ASSERT_THROW(fastaFilePtr->getContig("2"), std::runtime_error);
+}
+
+std::string getFastaTestSequence(size_t length)
+{
+	std::string sequence;
+	sequence.reserve(length);
+	for (size_t i = 0; i < length; ++i)
+	{
+		sequence += "ACGT"[((i * 7) + (i / 13)) % 4];
+	}
+	return sequence;
+}
+
+// the sequence in lines of lineBases, with its .fai if writeIndex is set
+std::string writeWrappedFasta(test_util::TemporaryDirectory& temporaryDirectory, const std::string& contigName, const std::string& sequence, size_t lineBases, bool writeIndex)
+{
+	std::string fastaPath = temporaryDirectory.getFilePath("wrapped.fasta");
+	std::string header = ">" + contigName + "\n";
+	{
+		std::ofstream fastaStream(fastaPath);
+		fastaStream << header;
+		for (size_t i = 0; i < sequence.size(); i += lineBases)
+		{
+			fastaStream << sequence.substr(i, lineBases) << "\n";
+		}
+	}
+	std::string indexPath = temporaryDirectory.getFilePath("wrapped.fasta.fai");
+	if (writeIndex)
+	{
+		std::ofstream indexStream(indexPath);
+		indexStream << contigName << "\t" << sequence.size() << "\t" << header.size() << "\t" << lineBases << "\t" << (lineBases + 1) << "\n";
+	}
+	return fastaPath;
+}
+
+TEST(FastaTests, SingleLineContigsAreMappedWithoutAnIndex)
+{
+	test_util::TemporaryDirectory temporaryDirectory;
+	std::string fastaPath = temporaryDirectory.getFilePath("single_line.fasta"); // no .fai so the index is built from the file
+	{
+		std::ofstream fastaStream(fastaPath);
+		fastaStream << ">chrA description\nACGTACGTNN\n>chrB\nGGGG\nCC\n";
+	}
+	graphite::FastaFile fastaFile(fastaPath);
+	auto contigAPtr = fastaFile.getContig("chrA");
+	ASSERT_TRUE(contigAPtr->isMapped());
+	ASSERT_EQ(std::string(contigAPtr->getSequence(), contigAPtr->getLength()), "ACGTACGTNN");
+	auto contigBPtr = fastaFile.getContig("chrB"); // pushes chrA out of the cache, the pointer still holds it
+	ASSERT_FALSE(contigBPtr->isMapped());
+	ASSERT_STREQ(contigBPtr->getSequence(), "GGGGCC");
+	ASSERT_EQ(std::string(contigAPtr->getSequence(), contigAPtr->getLength()), "ACGTACGTNN");
+	ASSERT_NE(fastaFile.getContig("chrB"), nullptr);
+	ASSERT_EQ(fastaFile.getContig("chrB"), contigBPtr);
+}
+
+TEST(FastaTests, ContigsInUseAreSharedPastTheCache)
+{
+	test_util::TemporaryDirectory temporaryDirectory;
+	std::string fastaPath = temporaryDirectory.getFilePath("two_contigs.fasta");
+	{
+		std::ofstream fastaStream(fastaPath);
+		fastaStream << ">chrA\nACGT\nAC\n>chrB\nGGGG\nCC\n";
+	}
+	graphite::FastaFile fastaFile(fastaPath, 1);
+	auto contigAPtr = fastaFile.getContig("chrA");
+	auto contigBPtr = fastaFile.getContig("chrB"); // pushes chrA out of the cache
+	ASSERT_EQ(fastaFile.getContig("chrA"), contigAPtr); // still held so it isn't joined again
+	ASSERT_EQ(fastaFile.getContig("chrB"), contigBPtr);
+
+	contigAPtr = nullptr; // nothing holds chrA now so it is joined again
+	auto reloadedAPtr = fastaFile.getContig("chrA");
+	ASSERT_STREQ(reloadedAPtr->getSequence(), "ACGTAC");
+	ASSERT_EQ(fastaFile.getContig("chrA"), reloadedAPtr);
+}
+
+TEST(FastaTests, SlicesCopyOnlyTheirBases)
+{
+	std::string sequence = getFastaTestSequence(1000);
+	for (bool writeIndex : { true, false })
+	{
+		test_util::TemporaryDirectory temporaryDirectory;
+		graphite::FastaFile fastaFile(writeWrappedFasta(temporaryDirectory, "chrW", sequence, 60, writeIndex));
+		ASSERT_EQ(fastaFile.getContigLength("chrW"), sequence.size());
+		for (size_t startPosition : { 0, 1, 59, 60, 61, 119, 500, 990 })
+		{
+			auto slicePtr = fastaFile.getContig("chrW", startPosition, 25); // the last one is cut short by the end of the contig
+			ASSERT_EQ(std::string(slicePtr->getSequence(), slicePtr->getLength()), sequence.substr(startPosition, 25));
+		}
+		ASSERT_EQ(fastaFile.getContig("chrW", 2000, 10)->getLength(), 0);
+		auto contigPtr = fastaFile.getContig("chrW");
+		ASSERT_EQ(std::string(contigPtr->getSequence(), contigPtr->getLength()), sequence);
+	}
+}
+
+TEST(FastaTests, BoundedRegionHoldsOnlyItsSlice)
+{
+	test_util::TemporaryDirectory temporaryDirectory;
+	std::string sequence = getFastaTestSequence(400000);
+	auto fastaFilePtr = std::make_shared< graphite::FastaFile >(writeWrappedFasta(temporaryDirectory, "chrS", sequence, 60, true));
+	auto referencePtr = std::make_shared< graphite::FastaReference >(fastaFilePtr, std::make_shared< graphite::Region >("chrS:200001-200100", graphite::Region::BASED::ONE));
+	ASSERT_LT(referencePtr->getSequenceSize(), sequence.size());
+	ASSERT_GT(referencePtr->getRegion()->getStartPosition(), 0);
+
+	// inside the slice, then before and after it where the sequence is read from the file
+	for (graphite::position startPosition : { 199990, 100, 399900 })
+	{
+		auto regionPtr = std::make_shared< graphite::Region >("chrS", startPosition, startPosition + 49, graphite::Region::BASED::ONE);
+		ASSERT_EQ(referencePtr->getSequenceFromRegion(regionPtr), sequence.substr(startPosition - 1, 50));
+	}
+	ASSERT_EQ(std::string(referencePtr->getSequence() + (200000 - referencePtr->getRegion()->getStartPosition()), 100), sequence.substr(200000, 100));
+}
+
+TEST(FastaTests, UnevenLinesAreRejected)
+{
+	test_util::TemporaryDirectory temporaryDirectory;
+	std::string fastaPath = temporaryDirectory.getFilePath("uneven.fasta");
+	{
+		std::ofstream fastaStream(fastaPath);
+		fastaStream << ">chrU\nACGT\nAC\nACGT\n";
+	}
+	ASSERT_THROW(graphite::FastaFile fastaFile(fastaPath), std::runtime_error);
+}
+
 #endif
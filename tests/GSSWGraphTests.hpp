@@ -42,6 +42,29 @@ TEST(GSSWGraphTests, GSSWSimpleGraph)
     ASSERT_STREQ(gsswPtr->nodes[3]->seq, "GATGGA"); // GATGGA
 }
 
+TEST(GSSWGraphTests, AlignmentMayTouchVariants)
+{
+    uint32_t readLength = 6;
+	std::string vcfLine = "1\t10\trs11575897\tT\tG\t34439.5\tPASS\tAA=G;AC=22;AF=0.0178427;AN=1233;DP=84761;NS=1233;AMR_AF=0.0000;AFR_AF=0.0000;EUR_AF=0.0000;SAS_AF=0.0000;EAS_AF=0.0451\tGT\t0\t0"; // is not the complete first line
+	auto regionPtr = std::make_shared< graphite::Region >("1", graphite::Region::BASED::ONE);
+	auto referencePtr = std::make_shared< graphite::FastaReference >(TEST_FASTA_FILE, regionPtr);
+	auto variantPtr = graphite::Variant::BuildVariant(vcfLine.c_str(), referencePtr, readLength);
+
+	std::vector< graphite::IVariant::SharedPtr > variantPtrs = {variantPtr};
+	auto variantListPtr = std::make_shared< graphite::VariantList >(variantPtrs, referencePtr);
+
+    auto gsswRegionPtr = std::make_shared< graphite::Region >("1", variantPtr->getPosition() - readLength, variantPtr->getPosition() + readLength, graphite::Region::BASED::ONE);
+	auto gsswGraphPtr = std::make_shared< graphite::GSSWGraph >(referencePtr, variantListPtr, gsswRegionPtr, 1, 1, 1, 1, 1);
+	gsswGraphPtr->constructGraph();
+
+	// TGATGT T GATGGAA, node 0 is reference outside of the variant and node 1 is the alt
+	ASSERT_FALSE(gsswGraphPtr->alignmentMayTouchVariants({ 0, 0, 0 }, readLength)); // unaligned
+	ASSERT_FALSE(gsswGraphPtr->alignmentMayTouchVariants({ 6, 0, 5 }, readLength)); // TGATGT fits in node 0
+	ASSERT_TRUE(gsswGraphPtr->alignmentMayTouchVariants({ 5, 0, 5 }, readLength)); // room for a one base deletion
+	ASSERT_TRUE(gsswGraphPtr->alignmentMayTouchVariants({ 6, 0, 4 }, readLength));
+	ASSERT_TRUE(gsswGraphPtr->alignmentMayTouchVariants({ 1, 1, 0 }, readLength));
+}
+
 TEST(GSSWGraphTests, GSSWSimpleLargeVariant)
 {
 	uint32_t readLength = 3;
@@ -0,0 +1,86 @@
+#ifndef GRAPHITE_GRAPHKMERINDEXTESTS_HPP
+#define GRAPHITE_GRAPHKMERINDEXTESTS_HPP
+
+#include "GraphSmithWatermanTests.hpp"
+#include "core/graph/GraphKmerIndex.h"
+
+namespace
+{
+namespace graph_kmer_index_test
+{
+	using namespace graphite;
+	using namespace graph_sw_test;
+
+	TEST(GraphKmerIndexTests, ExactReadsMapLikeTheAligner)
+	{
+		std::mt19937 generator(5);
+		std::string referencePath;
+		auto testGraphPtr = bubbleGraph(generator, referencePath);
+		auto kmerIndexPtr = std::make_shared< GraphKmerIndex >(testGraphPtr->graph, testGraphPtr->nt_table);
+		auto aligner = std::make_shared< GraphSmithWaterman >(testGraphPtr->graph, testGraphPtr->nt_table, testGraphPtr->mat, s_gap_open, s_gap_extension);
+		ASSERT_TRUE(kmerIndexPtr->isIndexed());
+
+		uint32_t exactCount = 0;
+		for (uint32_t position = 0; position + 100 <= referencePath.size(); position += 7)
+		{
+			std::string read = referencePath.substr(position, 100);
+			gssw_graph_mapping* exactMapping = kmerIndexPtr->findExactMapping(read.c_str(), read.size(), s_match);
+			if (exactMapping == nullptr)
+			{
+				continue;
+			}
+			++exactCount;
+			gssw_graph_mapping* gm = aligner->align(read.c_str(), read.size());
+			ASSERT_STREQ(mappingString(gm).c_str(), mappingString(exactMapping).c_str());
+			GraphSmithWaterman::DestroyMapping(gm);
+			GraphSmithWaterman::DestroyMapping(exactMapping);
+		}
+		ASSERT_GT(exactCount, 0);
+	}
+
+	TEST(GraphKmerIndexTests, InexactAndAmbiguousReadsAreLeftToTheAligner)
+	{
+		std::string prefix = "ACGTTGCAAGGCTTACCGATCGATTACGGCATCAG";
+		std::string suffix = "TTGACCAGTGGCATAGCCTAAGCTTGACGTACCA";
+		TestGraph testGraph({prefix, "C", "C", "G", suffix}, {{0,1},{0,2},{0,3},{1,4},{2,4},{3,4}});
+		GraphKmerIndex kmerIndex(testGraph.graph, testGraph.nt_table);
+
+		std::string uniqueRead = prefix.substr(10) + "G" + suffix.substr(0, 10);
+		gssw_graph_mapping* gm = kmerIndex.findExactMapping(uniqueRead.c_str(), uniqueRead.size(), s_match);
+		ASSERT_TRUE(gm != nullptr);
+		ASSERT_STREQ(mappingString(gm).c_str(), "36@10 0:25M 3:1M 4:10M");
+		GraphSmithWaterman::DestroyMapping(gm);
+
+		std::string ambiguousRead = prefix.substr(10) + "C" + suffix.substr(0, 10); // both C alleles match
+		ASSERT_TRUE(kmerIndex.findExactMapping(ambiguousRead.c_str(), ambiguousRead.size(), s_match) == nullptr);
+		std::string mismatchRead = prefix.substr(10) + "T" + suffix.substr(0, 10);
+		ASSERT_TRUE(kmerIndex.findExactMapping(mismatchRead.c_str(), mismatchRead.size(), s_match) == nullptr);
+		std::string ambiguityCodeRead = prefix.substr(10) + "N" + suffix.substr(0, 10);
+		ASSERT_TRUE(kmerIndex.findExactMapping(ambiguityCodeRead.c_str(), ambiguityCodeRead.size(), s_match) == nullptr);
+		std::string shortRead = prefix.substr(0, GraphKmerIndex::KMER_SIZE - 1);
+		ASSERT_TRUE(kmerIndex.findExactMapping(shortRead.c_str(), shortRead.size(), s_match) == nullptr);
+	}
+
+	TEST(GraphKmerIndexTests, DenseGraphsAreNotIndexed)
+	{
+		std::vector< std::string > nodeSeqs = { "ACGTACGTAC" };
+		std::vector< std::pair< uint32_t, uint32_t > > edges;
+		for (uint32_t i = 0; i < 40; ++i) // a SNP at every base
+		{
+			uint32_t previous = nodeSeqs.size() - 1;
+			nodeSeqs.emplace_back("A");
+			nodeSeqs.emplace_back("C");
+			nodeSeqs.emplace_back("G");
+			edges.emplace_back(previous, previous + 1);
+			edges.emplace_back(previous, previous + 2);
+			edges.emplace_back(previous + 1, previous + 3);
+			edges.emplace_back(previous + 2, previous + 3);
+		}
+		TestGraph testGraph(nodeSeqs, edges);
+		GraphKmerIndex kmerIndex(testGraph.graph, testGraph.nt_table);
+		ASSERT_FALSE(kmerIndex.isIndexed());
+	}
+}
+}
+
+#endif //GRAPHITE_GRAPHKMERINDEXTESTS_HPP
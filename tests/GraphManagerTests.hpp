@@ -0,0 +1,101 @@
+#ifndef GRAPHITE_TESTS_GRAPHMANAGERTESTS_HPP
+#define GRAPHITE_TESTS_GRAPHMANAGERTESTS_HPP
+
+#include "core/graph/GraphManager.h"
+#include "core/variant/Variant.h"
+#include "core/variant/VariantList.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+namespace graph_manager_test
+{
+	using namespace graphite;
+
+	const uint32_t s_read_length = 100;
+
+	// SNPs on 1, each variant's region reaches read length and a little more to either side
+	IVariantList::SharedPtr getVariantList(const std::vector< position >& positions)
+	{
+		std::vector< IVariant::SharedPtr > variantPtrs;
+		for (auto variantPosition : positions)
+		{
+			std::string vcfLine = "1\t" + std::to_string(variantPosition) + "\t.\tA\tC\t.\tPASS\t.";
+			variantPtrs.emplace_back(Variant::BuildVariant(vcfLine, nullptr, s_read_length));
+		}
+		return std::make_shared< VariantList >(variantPtrs, nullptr);
+	}
+
+	std::vector< std::vector< position > > getClusterPositions(IVariantList::SharedPtr variantListPtr, uint32_t maxClusterSpan)
+	{
+		std::vector< std::vector< position > > clusterPositions;
+		std::vector< IVariant::SharedPtr > variantPtrs;
+		std::vector< Region::SharedPtr > clusterRegionPtrs;
+		position startPosition;
+		position endPosition;
+		while (GraphManager::GetNextCluster(variantListPtr, maxClusterSpan, variantPtrs, clusterRegionPtrs, startPosition, endPosition))
+		{
+			clusterPositions.emplace_back();
+			for (auto& variantPtr : variantPtrs)
+			{
+				clusterPositions.back().emplace_back(variantPtr->getPosition());
+			}
+			EXPECT_EQ(startPosition, variantPtrs.front()->getRegions().front()->getStartPosition());
+			EXPECT_EQ(endPosition, variantPtrs.back()->getRegions().back()->getEndPosition());
+			if (maxClusterSpan > 0)
+			{
+				EXPECT_LE(endPosition - startPosition, maxClusterSpan);
+			}
+		}
+		return clusterPositions;
+	}
+
+	TEST(GraphManagerTests, ChainedVariantsLandInOneCluster)
+	{
+		// the first and last regions don't overlap, the middle variant's region reaches both
+		auto variantListPtr = getVariantList({ 1000, 1200, 1400 });
+		auto variantPtrs = variantListPtr->getAllVariantPtrs();
+		ASSERT_LT(variantPtrs[0]->getRegions().back()->getEndPosition(), variantPtrs[2]->getRegions().front()->getStartPosition());
+
+		auto clusterPositions = getClusterPositions(variantListPtr, 0);
+		ASSERT_EQ(clusterPositions.size(), 1);
+		ASSERT_EQ(clusterPositions[0], std::vector< position >({ 1000, 1200, 1400 }));
+	}
+
+	TEST(GraphManagerTests, DisjointVariantsSplit)
+	{
+		auto clusterPositions = getClusterPositions(getVariantList({ 1000, 2000, 2100, 5000 }), 0);
+		ASSERT_EQ(clusterPositions.size(), 3);
+		ASSERT_EQ(clusterPositions[0], std::vector< position >({ 1000 }));
+		ASSERT_EQ(clusterPositions[1], std::vector< position >({ 2000, 2100 }));
+		ASSERT_EQ(clusterPositions[2], std::vector< position >({ 5000 }));
+	}
+
+	TEST(GraphManagerTests, MaxClusterSpanCutsChain)
+	{
+		// two regions fit in the span, the third would push past it and starts the next cluster
+		auto variantListPtr = getVariantList({ 1000, 1200, 1400, 1600 });
+		auto variantPtrs = variantListPtr->getAllVariantPtrs();
+		uint32_t maxClusterSpan = variantPtrs[1]->getRegions().back()->getEndPosition() - variantPtrs[0]->getRegions().front()->getStartPosition();
+
+		auto clusterPositions = getClusterPositions(variantListPtr, maxClusterSpan);
+		ASSERT_EQ(clusterPositions.size(), 2);
+		ASSERT_EQ(clusterPositions[0], std::vector< position >({ 1000, 1200 }));
+		ASSERT_EQ(clusterPositions[1], std::vector< position >({ 1400, 1600 }));
+	}
+
+	TEST(GraphManagerTests, SkippedVariantsArePassedOver)
+	{
+		auto variantListPtr = getVariantList({ 1000, 3000 });
+		variantListPtr->getAllVariantPtrs()[0]->setSkip(true);
+
+		auto clusterPositions = getClusterPositions(variantListPtr, 0);
+		ASSERT_EQ(clusterPositions.size(), 1);
+		ASSERT_EQ(clusterPositions[0], std::vector< position >({ 3000 }));
+	}
+}
+}
+
+#endif //GRAPHITE_TESTS_GRAPHMANAGERTESTS_HPP
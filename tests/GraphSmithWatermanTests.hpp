@@ -0,0 +1,313 @@
+#ifndef GRAPHITE_GRAPHSMITHWATERMANTESTS_HPP
+#define GRAPHITE_GRAPHSMITHWATERMANTESTS_HPP
+
+#include "gssw.h"
+#include "core/graph/GraphSmithWaterman.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+namespace graph_sw_test
+{
+	using namespace graphite;
+
+	static const int32_t s_match = 1;
+	static const int32_t s_mismatch = 4;
+	static const int32_t s_gap_open = 6;
+	static const int32_t s_gap_extension = 1;
+
+	class TestGraph
+	{
+	public:
+		TestGraph(const std::vector< std::string >& nodeSeqs, const std::vector< std::pair< uint32_t, uint32_t > >& edges, int32_t match = s_match, int32_t mismatch = s_mismatch) :
+			m_node_seqs(nodeSeqs)
+		{
+			nt_table = gssw_create_nt_table();
+			mat = gssw_create_score_matrix(match, mismatch);
+			graph = gssw_graph_create(nodeSeqs.size());
+			std::vector< gssw_node* > nodes;
+			for (uint32_t i = 0; i < m_node_seqs.size(); ++i)
+			{
+				nodes.emplace_back(gssw_node_create(nullptr, i, m_node_seqs[i].c_str(), nt_table, mat));
+				gssw_graph_add_node(graph, nodes.back());
+			}
+			for (auto& edge : edges)
+			{
+				gssw_nodes_add_edge(nodes[edge.first], nodes[edge.second]);
+			}
+		}
+
+		~TestGraph()
+		{
+			gssw_graph_destroy(graph);
+			free(nt_table);
+			free(mat);
+		}
+
+		int8_t* nt_table;
+		int8_t* mat;
+		gssw_graph* graph;
+	private:
+		std::vector< std::string > m_node_seqs;
+	};
+
+	std::string mappingString(gssw_graph_mapping* gm)
+	{
+		std::string result = std::to_string(gm->score) + "@" + std::to_string(gm->position);
+		for (uint32_t i = 0; i < gm->cigar.length; ++i)
+		{
+			result += " " + std::to_string(gm->cigar.elements[i].node->id) + ":";
+			for (int32_t j = 0; j < gm->cigar.elements[i].cigar->length; ++j)
+			{
+				result += std::to_string(gm->cigar.elements[i].cigar->elements[j].length) + gm->cigar.elements[i].cigar->elements[j].type;
+			}
+		}
+		return result;
+	}
+
+	// the score of the cigar has to add up to the mapping score and the cigar has to cover the read, gaps may continue into the next node
+	void checkCigar(gssw_graph_mapping* gm, const std::string& read, int32_t match, int32_t mismatch)
+	{
+		if (read.find('N') != std::string::npos)
+		{
+			return; // N scores 0 but is still reported as a mismatch
+		}
+		int32_t score = 0;
+		uint32_t readBases = 0;
+		char previousType = 0;
+		for (uint32_t i = 0; i < gm->cigar.length; ++i)
+		{
+			gssw_cigar* cigar = gm->cigar.elements[i].cigar;
+			for (int32_t j = 0; j < cigar->length; ++j)
+			{
+				char type = cigar->elements[j].type;
+				int32_t length = cigar->elements[j].length;
+				int32_t gapOpen = (type == previousType) ? s_gap_extension : s_gap_open;
+				switch (type)
+				{
+				case 'M': score += match * length; readBases += length; break;
+				case 'X': score -= mismatch * length; readBases += length; break;
+				case 'S': readBases += length; break;
+				case 'I': score -= gapOpen + (length - 1) * s_gap_extension; readBases += length; break;
+				case 'D': score -= gapOpen + (length - 1) * s_gap_extension; break;
+				}
+				previousType = type;
+			}
+		}
+		ASSERT_EQ(score, gm->score);
+		ASSERT_EQ(readBases, read.size());
+	}
+
+	std::string randomSequence(std::mt19937& generator, uint32_t length)
+	{
+		static const char* bases = "ACGT";
+		std::uniform_int_distribution< int > distribution(0, 3);
+		std::string sequence;
+		for (uint32_t i = 0; i < length; ++i)
+		{
+			sequence += bases[distribution(generator)];
+		}
+		return sequence;
+	}
+
+	TEST(GraphSmithWatermanTests, AlignsToAlternatePath)
+	{
+		TestGraph testGraph({"A","G","C","GT"}, {{0,1},{0,2},{1,3},{2,3}});
+		std::string read = "ACGT";
+		auto aligner = std::make_shared< GraphSmithWaterman >(testGraph.graph, testGraph.nt_table, testGraph.mat, s_gap_open, s_gap_extension);
+		gssw_graph_mapping* gm = aligner->align(read.c_str(), read.size());
+		ASSERT_STREQ(mappingString(gm).c_str(), "4@0 0:1M 2:1M 3:2M");
+		GraphSmithWaterman::DestroyMapping(gm);
+	}
+
+	TEST(GraphSmithWatermanTests, DeletionSpansNodes)
+	{
+		TestGraph testGraph({"ACGTACGGTC","TT","AA","CCGATTAGCA"}, {{0,1},{1,2},{2,3}});
+		std::string read = "ACGTACGGTCCCGATTAGCA";
+		auto aligner = std::make_shared< GraphSmithWaterman >(testGraph.graph, testGraph.nt_table, testGraph.mat, s_gap_open, s_gap_extension);
+		gssw_graph_mapping* gm = aligner->align(read.c_str(), read.size());
+		ASSERT_STREQ(mappingString(gm).c_str(), "11@0 0:10M 1:2D 2:2D 3:10M");
+		checkCigar(gm, read, s_match, s_mismatch);
+		GraphSmithWaterman::DestroyMapping(gm);
+	}
+
+	TEST(GraphSmithWatermanTests, ScoresMatchGSSW)
+	{
+		TestGraph testGraph({"TGATGTCAGTCCA","G","T","GATGGAACCTAGT","A","AC","CGGTATCCAGT"}, {{0,1},{0,2},{1,3},{2,3},{3,4},{3,5},{4,6},{5,6}});
+		std::vector< std::string > reads = {"GTCAGTCCAGGATGGAACC", "GTCAGTCCATGATGGAACC", "ATGGAACCTAGTACGGTATC", "TCCAGGATGTGAACCTAGTAC", "CAGTCCATGATCCTAGTACGG", "NNGTCCAGGATGGNACC"};
+		auto aligner = std::make_shared< GraphSmithWaterman >(testGraph.graph, testGraph.nt_table, testGraph.mat, s_gap_open, s_gap_extension);
+		for (auto& read : reads)
+		{
+			gssw_graph_fill(testGraph.graph, read.c_str(), read.size(), testGraph.nt_table, testGraph.mat, s_gap_open, s_gap_extension, 15, 2);
+			gssw_graph_mapping* gsswMapping = gssw_graph_trace_back(testGraph.graph, read.c_str(), read.size(), s_match, s_mismatch, s_gap_open, s_gap_extension);
+			gssw_graph_mapping* gm = aligner->align(read.c_str(), read.size());
+			ASSERT_EQ(gsswMapping->score, gm->score);
+			checkCigar(gm, read, s_match, s_mismatch);
+			GraphSmithWaterman::DestroyMapping(gm);
+			gssw_graph_mapping_destroy(gsswMapping);
+		}
+	}
+
+	// reference nodes each followed by a two allele bubble, the reference path takes the first allele
+	std::shared_ptr< TestGraph > bubbleGraph(std::mt19937& generator, std::string& referencePath)
+	{
+		std::vector< std::string > nodeSeqs;
+		std::vector< std::pair< uint32_t, uint32_t > > edges;
+		for (uint32_t i = 0; i < 12; ++i)
+		{
+			nodeSeqs.emplace_back(randomSequence(generator, 20 + i * 7));
+			nodeSeqs.emplace_back(randomSequence(generator, 1 + i % 4));
+			nodeSeqs.emplace_back(randomSequence(generator, 1 + i % 3));
+			uint32_t reference = i * 3;
+			edges.emplace_back(reference, reference + 1);
+			edges.emplace_back(reference, reference + 2);
+			if (i > 0)
+			{
+				edges.emplace_back(reference - 2, reference);
+				edges.emplace_back(reference - 1, reference);
+			}
+			referencePath += nodeSeqs[reference] + nodeSeqs[reference + 1];
+		}
+		return std::make_shared< TestGraph >(nodeSeqs, edges);
+	}
+
+	// reads taken from the reference path with mismatches, insertions and deletions sprinkled in
+	std::vector< std::string > editedReads(std::mt19937& generator, const std::string& referencePath, uint32_t readCount, uint32_t minLength, uint32_t maxLength)
+	{
+		std::uniform_int_distribution< int > lengthDistribution(minLength, maxLength);
+		std::uniform_int_distribution< int > editDistribution(0, 99);
+		std::vector< std::string > reads;
+		for (uint32_t i = 0; i < readCount; ++i)
+		{
+			uint32_t length = lengthDistribution(generator);
+			std::uniform_int_distribution< int > positionDistribution(0, referencePath.size() - length);
+			std::string read = referencePath.substr(positionDistribution(generator), length);
+			for (uint32_t j = 0; j < read.size(); ++j)
+			{
+				int edit = editDistribution(generator);
+				if (edit == 0) { read[j] = "ACGTN"[editDistribution(generator) % 5]; }
+				else if (edit == 1) { read.insert(j, randomSequence(generator, 1 + editDistribution(generator) % 8)); }
+				else if (edit == 2) { read.erase(j, 1 + editDistribution(generator) % 8); }
+			}
+			reads.emplace_back(read);
+		}
+		return reads;
+	}
+
+	TEST(GraphSmithWatermanTests, KernelsAgree)
+	{
+		std::mt19937 generator(42);
+		std::string referencePath;
+		auto testGraphPtr = bubbleGraph(generator, referencePath);
+		TestGraph& testGraph = *testGraphPtr;
+		std::vector< std::string > reads = editedReads(generator, referencePath, 200, 150, 150);
+
+		auto scalarAligner = std::make_shared< GraphSmithWaterman >(testGraph.graph, testGraph.nt_table, testGraph.mat, s_gap_open, s_gap_extension, GraphSmithWaterman::Kernel::Scalar);
+		for (auto kernel : GraphSmithWaterman::GetSupportedKernels())
+		{
+			auto aligner = std::make_shared< GraphSmithWaterman >(testGraph.graph, testGraph.nt_table, testGraph.mat, s_gap_open, s_gap_extension, kernel);
+			for (auto& read : reads)
+			{
+				gssw_graph_mapping* expected = scalarAligner->align(read.c_str(), read.size());
+				gssw_graph_mapping* gm = aligner->align(read.c_str(), read.size());
+				ASSERT_STREQ(mappingString(expected).c_str(), mappingString(gm).c_str()) << GraphSmithWaterman::GetKernelName(kernel);
+				checkCigar(gm, read, s_match, s_mismatch);
+				GraphSmithWaterman::DestroyMapping(gm);
+				GraphSmithWaterman::DestroyMapping(expected);
+			}
+		}
+	}
+
+	TEST(GraphSmithWatermanTests, WidensLanesWhenScoresSaturate)
+	{
+		std::mt19937 generator(7);
+		int32_t match = 100;
+		std::string reference = randomSequence(generator, 600);
+		TestGraph testGraph({reference.substr(0, 300), reference.substr(300)}, {{0,1}}, match, s_mismatch);
+		std::vector< std::string > reads = { reference.substr(290, 1), reference.substr(280, 40), reference.substr(100, 300), reference.substr(50, 400) }; // scores that fit 8, 16 and 32 bit lanes
+		for (auto kernel : GraphSmithWaterman::GetSupportedKernels())
+		{
+			auto aligner = std::make_shared< GraphSmithWaterman >(testGraph.graph, testGraph.nt_table, testGraph.mat, s_gap_open, s_gap_extension, kernel);
+			for (auto& read : reads)
+			{
+				gssw_graph_mapping* gm = aligner->align(read.c_str(), read.size());
+				ASSERT_EQ(gm->score, match * (int32_t)read.size());
+				checkCigar(gm, read, match, s_mismatch);
+				GraphSmithWaterman::DestroyMapping(gm);
+			}
+		}
+	}
+
+	TEST(GraphSmithWatermanTests, BatchScoresMatchAlign)
+	{
+		std::mt19937 generator(11);
+		std::string referencePath;
+		auto testGraphPtr = bubbleGraph(generator, referencePath);
+		std::vector< std::string > reads = editedReads(generator, referencePath, 150, 1, 200);
+		reads.emplace_back("");
+		for (uint32_t i = 0; i < 40; ++i) // saturates the byte lanes
+		{
+			reads.emplace_back(referencePath.substr(i * 5, 260 + i));
+		}
+		std::vector< std::pair< const char*, uint32_t > > batch;
+		for (auto& read : reads)
+		{
+			batch.emplace_back(read.c_str(), read.size());
+		}
+		for (auto kernel : GraphSmithWaterman::GetSupportedKernels())
+		{
+			auto aligner = std::make_shared< GraphSmithWaterman >(testGraphPtr->graph, testGraphPtr->nt_table, testGraphPtr->mat, s_gap_open, s_gap_extension, kernel);
+			std::vector< GraphSmithWaterman::ReadScore > scores;
+			aligner->scoreReads(batch, scores);
+			ASSERT_EQ(scores.size(), reads.size());
+			for (uint32_t i = 0; i < reads.size(); ++i)
+			{
+				gssw_graph_mapping* gm = aligner->align(reads[i].c_str(), reads[i].size());
+				ASSERT_EQ(scores[i].score, gm->score) << GraphSmithWaterman::GetKernelName(kernel) << " read " << i;
+				GraphSmithWaterman::DestroyMapping(gm);
+				auto readScore = aligner->scoreRead(reads[i].c_str(), reads[i].size());
+				ASSERT_EQ(scores[i].endNode, readScore.endNode) << GraphSmithWaterman::GetKernelName(kernel) << " read " << i;
+				ASSERT_EQ(scores[i].endColumn, readScore.endColumn) << GraphSmithWaterman::GetKernelName(kernel) << " read " << i;
+			}
+		}
+	}
+
+	// every kernel has to reproduce gssw exactly, the score, where the alignment ends and the cigar
+	TEST(GraphSmithWatermanTests, MatchesGSSWOnRandomGraphs)
+	{
+		std::mt19937 generator(2024);
+		for (uint32_t graphIndex = 0; graphIndex < 20; ++graphIndex)
+		{
+			std::string referencePath;
+			auto testGraphPtr = bubbleGraph(generator, referencePath);
+			gssw_graph* graphPtr = testGraphPtr->graph;
+			std::vector< std::string > reads = editedReads(generator, referencePath, 50, 1, 240);
+			for (auto kernel : GraphSmithWaterman::GetSupportedKernels())
+			{
+				auto aligner = std::make_shared< GraphSmithWaterman >(graphPtr, testGraphPtr->nt_table, testGraphPtr->mat, s_gap_open, s_gap_extension, kernel);
+				for (auto& read : reads)
+				{
+					gssw_graph_fill(graphPtr, read.c_str(), read.size(), testGraphPtr->nt_table, testGraphPtr->mat, s_gap_open, s_gap_extension, 15, 2);
+					uint32_t maxNodeIndex = std::find(graphPtr->nodes, graphPtr->nodes + graphPtr->size, graphPtr->max_node) - graphPtr->nodes;
+					auto readScore = aligner->scoreRead(read.c_str(), read.size());
+					ASSERT_EQ(readScore.score, graphPtr->max_node->alignment->score1) << GraphSmithWaterman::GetKernelName(kernel) << " " << read;
+					ASSERT_EQ(readScore.endNode, maxNodeIndex) << GraphSmithWaterman::GetKernelName(kernel) << " " << read;
+					ASSERT_EQ(readScore.endColumn, (uint32_t)graphPtr->max_node->alignment->ref_end1) << GraphSmithWaterman::GetKernelName(kernel) << " " << read;
+
+					gssw_graph_mapping* gsswMapping = gssw_graph_trace_back(graphPtr, read.c_str(), read.size(), s_match, s_mismatch, s_gap_open, s_gap_extension);
+					gssw_graph_mapping* gm = aligner->align(read.c_str(), read.size());
+					ASSERT_STREQ(mappingString(gsswMapping).c_str(), mappingString(gm).c_str()) << GraphSmithWaterman::GetKernelName(kernel) << " " << read;
+					GraphSmithWaterman::DestroyMapping(gm);
+					gssw_graph_mapping_destroy(gsswMapping);
+				}
+			}
+		}
+	}
+}
+}
+
+#endif //GRAPHITE_GRAPHSMITHWATERMANTESTS_HPP
@@ -2,103 +2,149 @@
 #define GRAPHITE_TESTS_HTSLIBALIGNMENTREADER_HPP
 
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "core/alignment/HTSLibAlignmentReader.h"
-#include "core/alignment/SampleManager.hpp"
+#include "core/sample/SampleManager.h"
 #include "config/TestConfig.h"
 
 // #include "core/alignment/BamAlignmentReader.h"
 
-graphite::HTSLibAlignmentReader::SharedPtr getAlignmentReader(const std::string& path)
+graphite::HTSLibAlignmentReader::SharedPtr getAlignmentReader(const std::string& path, graphite::SampleManager::SharedPtr& sampleManagerPtr)
 {
 	auto alignmentReaderPtr = std::make_shared< graphite::HTSLibAlignmentReader >(path);
-	auto samplePtrs = graphite::HTSLibAlignmentReader::GetBamReaderSamples(path);
-	for (auto samplePtr : samplePtrs)
+	sampleManagerPtr = std::make_shared< graphite::SampleManager >(graphite::HTSLibAlignmentReader::GetBamReaderSamples(path));
+	return alignmentReaderPtr;
+}
+
+// the layout tests/data/make_test_bam.py writes into TEST_BAM_FILE, see that script for the rest
+static const uint32_t s_test_bam_read_length = 50;
+struct TestBamReadRun
+{
+	std::string referenceID;
+	uint32_t firstPosition;
+	uint32_t spacing;
+	uint32_t count;
+	uint32_t firstK; // k of the run's first read, duplicates are the reads with k % 10 == 5
+};
+static const std::vector< TestBamReadRun > s_test_bam_read_runs = {
+	{ "1", 5000000, 10000, 2000, 0 },
+	{ "1", 150000000, 100000, 500, 2000 },
+	{ "20", 1000000, 10000, 900, 0 }
+};
+
+// the primary reads sam_itr_queryi returns for the region's start and end, reads overlapping [start, end)
+size_t getExpectedReadCount(const std::string& regionString, bool excludeDuplicateReads = false)
+{
+	auto regionPtr = std::make_shared< graphite::Region >(regionString, graphite::Region::BASED::ONE);
+	size_t count = 0;
+	for (auto& readRun : s_test_bam_read_runs)
 	{
-		graphite::SampleManager::Instance()->addSamplePtr(samplePtr);
+		if (readRun.referenceID != regionPtr->getReferenceID()) { continue; }
+		for (uint32_t i = 0; i < readRun.count; ++i)
+		{
+			graphite::position readPosition = readRun.firstPosition + (i * readRun.spacing);
+			bool isDuplicate = (readRun.firstK + i) % 10 == 5;
+			if (readPosition < regionPtr->getEndPosition() && readPosition + s_test_bam_read_length > regionPtr->getStartPosition() && !(isDuplicate && excludeDuplicateReads))
+			{
+				++count;
+			}
+		}
 	}
-	return alignmentReaderPtr;
+	return count;
+}
+
+graphite::AlignmentStore::SharedPtr loadTestBamRegion(const std::string& regionString, bool excludeDuplicateReads = false)
+{
+	graphite::SampleManager::SharedPtr sampleManagerPtr;
+	auto alignmentReaderPtr = getAlignmentReader(TEST_BAM_FILE, sampleManagerPtr);
+	alignmentReaderPtr->open();
+	auto regionPtr = std::make_shared< graphite::Region >(regionString, graphite::Region::BASED::ONE);
+	auto alignmentStorePtr = alignmentReaderPtr->loadAlignmentsInRegion(regionPtr, sampleManagerPtr, excludeDuplicateReads);
+	alignmentReaderPtr->close();
+	return alignmentStorePtr;
 }
 
-TEST(HTSLibAlignmentReaderTest, GetSamples)
+TEST(HTSLibAlignmentReaderTests, GetSamples)
 {
-	auto samplePtrs = graphite::HTSLibAlignmentReader::GetBamReaderSamples(TEST_BAM_FILE);;
+	auto samplePtrs = graphite::HTSLibAlignmentReader::GetBamReaderSamples(TEST_BAM_FILE);
 	ASSERT_EQ(samplePtrs.size(), 1);
 	ASSERT_STREQ(samplePtrs[0]->getName().c_str(), "NA12878");
 	ASSERT_STREQ(samplePtrs[0]->getReadgroup().c_str(), "SRR622461");
 	ASSERT_STREQ(samplePtrs[0]->getPath().c_str(), TEST_BAM_FILE);
 }
 
+TEST(HTSLibAlignmentReaderTests, GetReadLength)
+{
+	ASSERT_EQ(graphite::HTSLibAlignmentReader::GetReadLength(TEST_BAM_FILE), s_test_bam_read_length);
+}
+
 TEST(HTSLibAlignmentReaderTests, TestLoadAlignmentsRegionWithoutAlignments)
 {
-	auto alignmentReaderPtr = getAlignmentReader(TEST_BAM_FILE);
-	alignmentReaderPtr->open();
-	std::string regionString = "20:1-100";
-	auto regionPtr = std::make_shared< graphite::Region >(regionString);
-	auto alignmentsList = alignmentReaderPtr->loadAlignmentsInRegion(regionPtr);
-	alignmentReaderPtr->close();
-	ASSERT_EQ(alignmentsList.size(), 0);
+	ASSERT_EQ(getExpectedReadCount("20:1-100"), 0);
+	ASSERT_EQ(loadTestBamRegion("20:1-100")->getCount(), 0);
 }
 
 TEST(HTSLibAlignmentReaderTests, TestLoadAlignmentAtStartRegionWithPositions)
 {
-	// std::string path = TEST_BAM_FILE;
-	// auto bamAlignmentReaderPtr = std::make_shared< graphite::BamAlignmentReader >(path);
-	auto alignmentReaderPtr = getAlignmentReader(TEST_BAM_FILE);
-	alignmentReaderPtr->open();
-	std::string regionString = "20:1-10000000";
-	auto regionPtr = std::make_shared< graphite::Region >(regionString);
-	auto alignmentsList = alignmentReaderPtr->loadAlignmentsInRegion(regionPtr);
-	alignmentReaderPtr->close();
-	ASSERT_EQ(alignmentsList.size(), 1988);
+	ASSERT_EQ(getExpectedReadCount("20:1-10000000"), 900);
+	ASSERT_EQ(loadTestBamRegion("20:1-10000000")->getCount(), getExpectedReadCount("20:1-10000000"));
 }
 
 TEST(HTSLibAlignmentReaderTests, TestLoadAlignmentAtStartRegionWithPositionsSmallRegion)
 {
-	// std::string path = TEST_BAM_FILE;
-	// auto bamAlignmentReaderPtr = std::make_shared< graphite::BamAlignmentReader >(path);
-	auto alignmentReaderPtr = getAlignmentReader(TEST_BAM_FILE);
-	alignmentReaderPtr->open();
-	std::string regionString = "1:10316100-10318900";
-	auto regionPtr = std::make_shared< graphite::Region >(regionString);
-	auto alignmentsList = alignmentReaderPtr->loadAlignmentsInRegion(regionPtr);
-	ASSERT_EQ(alignmentsList.size(), 0);
+	ASSERT_EQ(getExpectedReadCount("1:10316100-10318900"), 0); // falls between two reads
+	ASSERT_EQ(loadTestBamRegion("1:10316100-10318900")->getCount(), 0);
 }
 
 TEST(HTSLibAlignmentReaderTests, TestLoadAlignmentAtMiddleRegionWithPositions)
 {
-	// std::string path = TEST_BAM_FILE;
-	// auto bamAlignmentReaderPtr = std::make_shared< graphite::BamAlignmentReader >(path);
-	auto alignmentReaderPtr = getAlignmentReader(TEST_BAM_FILE);
-	alignmentReaderPtr->open();
-	std::string regionString = "1:10000000-20000000";
-	auto regionPtr = std::make_shared< graphite::Region >(regionString);
-	auto alignmentsList = alignmentReaderPtr->loadAlignmentsInRegion(regionPtr);
-	ASSERT_EQ(alignmentsList.size(), 1979);
+	ASSERT_EQ(getExpectedReadCount("1:10000000-20000000"), 1000);
+	ASSERT_EQ(loadTestBamRegion("1:10000000-20000000")->getCount(), getExpectedReadCount("1:10000000-20000000"));
 }
 
 TEST(HTSLibAlignmentReaderTests, TestLoadAlignmentAtEndRegionWithPositions)
 {
-	// std::string path = TEST_BAM_FILE;
-	// auto bamAlignmentReaderPtr = std::make_shared< graphite::BamAlignmentReader >(path);
-	auto alignmentReaderPtr = getAlignmentReader(TEST_BAM_FILE);
-	alignmentReaderPtr->open();
-	std::string regionString = "1:100000000-600000000";
-	auto regionPtr = std::make_shared< graphite::Region >(regionString);
-	auto alignmentsList = alignmentReaderPtr->loadAlignmentsInRegion(regionPtr);
-	ASSERT_EQ(alignmentsList.size(), 7499);
+	// the region runs past the end of the chromosome
+	ASSERT_EQ(getExpectedReadCount("1:100000000-600000000"), 500);
+	ASSERT_EQ(loadTestBamRegion("1:100000000-600000000")->getCount(), getExpectedReadCount("1:100000000-600000000"));
 }
 
 TEST(HTSLibAlignmentReaderTests, TestLoadAlignmentOneHundredThousand)
 {
-	// std::string path = TEST_BAM_FILE;
-	// auto bamAlignmentReaderPtr = std::make_shared< graphite::BamAlignmentReader >(path);
-	auto alignmentReaderPtr = getAlignmentReader(TEST_BAM_FILE);
-	alignmentReaderPtr->open();
-	std::string regionString = "1:12308541-12408541";
-	auto regionPtr = std::make_shared< graphite::Region >(regionString);
-	auto alignmentsList = alignmentReaderPtr->loadAlignmentsInRegion(regionPtr);
-	ASSERT_EQ(alignmentsList.size(), 1977);
+	ASSERT_EQ(getExpectedReadCount("1:12308541-12408541"), 10);
+	ASSERT_EQ(loadTestBamRegion("1:12308541-12408541")->getCount(), getExpectedReadCount("1:12308541-12408541"));
+}
+
+TEST(HTSLibAlignmentReaderTests, TestLoadAlignmentExcludesDuplicates)
+{
+	ASSERT_EQ(getExpectedReadCount("1:10000000-20000000", true), 900);
+	ASSERT_EQ(loadTestBamRegion("1:10000000-20000000", true)->getCount(), getExpectedReadCount("1:10000000-20000000", true));
+}
+
+TEST(HTSLibAlignmentReaderTests, TestLoadAlignmentKeepsPositionsFlagsAndBases)
+{
+	// reads 0, 1 and 2, read 0's secondary line is left out
+	auto alignmentStorePtr = loadTestBamRegion("1:5000000-5030000");
+	ASSERT_EQ(alignmentStorePtr->getCount(), 3);
+	std::string pattern = "ACGTTGCA";
+	std::string repeated;
+	while (repeated.size() < s_test_bam_read_length + pattern.size()) { repeated += pattern; }
+	char sequence[s_test_bam_read_length + 1];
+	for (uint32_t k = 0; k < alignmentStorePtr->getCount(); ++k)
+	{
+		auto& record = alignmentStorePtr->getRecord(k);
+		ASSERT_EQ(record.startPosition, 5000000 + (k * 10000));
+		ASSERT_EQ(record.length, s_test_bam_read_length);
+		ASSERT_EQ(record.mapQuality, 60);
+		ASSERT_EQ((record.flags & graphite::AlignmentStore::FIRST_MATE) != 0, k % 2 == 0);
+		ASSERT_EQ((record.flags & graphite::AlignmentStore::REVERSE_STRAND) != 0, k % 2 == 1);
+		ASSERT_TRUE(record.flags & graphite::AlignmentStore::MAPPED);
+		ASSERT_STREQ(alignmentStorePtr->getSamplePtr(record.sampleSlot)->getName().c_str(), "NA12878");
+		alignmentStorePtr->getSequence(k, sequence);
+		ASSERT_STREQ(sequence, repeated.substr(k % pattern.size(), s_test_bam_read_length).c_str());
+	}
 }
 
 /*
@@ -109,7 +155,7 @@ TEST(BamAlignmentReaderTests, TestLoadAlignmentTMP)
 	std::string regionString = "1:4000000-4100000";
 	auto regionPtr = std::make_shared< graphite::Region >(regionString);
 	auto alignmentsList = bamAlignmentReaderPtr->loadAlignmentsInRegion(regionPtr);
-	ASSERT_EQ(alignmentsList.size(), 49246);
+	ASSERT_EQ(alignmentStorePtr->getCount(), 49246);
 }
 */
 
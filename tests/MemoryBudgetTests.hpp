@@ -0,0 +1,187 @@
+#ifndef GRAPHITE_MEMORYBUDGETTESTS_HPP
+#define GRAPHITE_MEMORYBUDGETTESTS_HPP
+
+#include "core/util/MemoryBudget.hpp"
+#include "core/util/BoundedQueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+namespace
+{
+namespace memory_budget_test
+{
+	using namespace graphite;
+
+	TEST(MemoryBudgetTests, ReleasesWhenReservationIsDestroyed)
+	{
+		auto memoryBudgetPtr = std::make_shared< MemoryBudget >(100);
+		{
+			auto firstPtr = memoryBudgetPtr->reserve(40);
+			auto secondPtr = memoryBudgetPtr->reserve(60);
+			ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 100);
+			ASSERT_EQ(firstPtr->getBytes(), 40);
+			firstPtr = nullptr;
+			ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 60);
+		}
+		ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 0);
+	}
+
+	TEST(MemoryBudgetTests, ReserveBlocksUntilBytesAreReleased)
+	{
+		auto memoryBudgetPtr = std::make_shared< MemoryBudget >(100);
+		auto heldPtr = memoryBudgetPtr->reserve(80);
+		std::atomic< bool > reserved(false);
+		std::thread waitingThread([&]()
+		{
+			auto waitingPtr = memoryBudgetPtr->reserve(50);
+			reserved = true;
+		});
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		ASSERT_FALSE(reserved);
+		heldPtr = nullptr;
+		waitingThread.join();
+		ASSERT_TRUE(reserved);
+		ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 0);
+	}
+
+	TEST(MemoryBudgetTests, HeldBytesAreNotWaitedOn)
+	{
+		auto memoryBudgetPtr = std::make_shared< MemoryBudget >(100);
+		auto heldPtr = memoryBudgetPtr->reserve(80);
+		auto secondPtr = memoryBudgetPtr->reserve(50, heldPtr->getBytes()); // would deadlock if it waited on itself
+		ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 130);
+	}
+
+	TEST(MemoryBudgetTests, OversizedRequestWaitsForAnEmptyBudget)
+	{
+		auto memoryBudgetPtr = std::make_shared< MemoryBudget >(100);
+		{
+			auto oversizedPtr = memoryBudgetPtr->reserve(500); // nothing else is reserved so it goes through
+			ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 500);
+			ASSERT_EQ(memoryBudgetPtr->tryReserve(1), nullptr);
+		}
+		auto heldPtr = memoryBudgetPtr->reserve(10);
+		ASSERT_EQ(memoryBudgetPtr->tryReserve(500), nullptr);
+		std::atomic< bool > reserved(false);
+		std::thread waitingThread([&]()
+		{
+			auto oversizedPtr = memoryBudgetPtr->reserve(500);
+			reserved = true;
+		});
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		ASSERT_FALSE(reserved);
+		heldPtr = nullptr;
+		waitingThread.join();
+		ASSERT_TRUE(reserved);
+	}
+
+	TEST(MemoryBudgetTests, TryReserveDoesNotWait)
+	{
+		auto memoryBudgetPtr = std::make_shared< MemoryBudget >(100);
+		auto heldPtr = memoryBudgetPtr->tryReserve(70);
+		ASSERT_NE(heldPtr, nullptr);
+		ASSERT_EQ(memoryBudgetPtr->tryReserve(40), nullptr);
+		ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 70);
+		auto secondPtr = memoryBudgetPtr->tryReserve(30);
+		ASSERT_NE(secondPtr, nullptr);
+		ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 100);
+	}
+
+	TEST(MemoryBudgetTests, ResizeAndSplitKeepTheTotal)
+	{
+		auto memoryBudgetPtr = std::make_shared< MemoryBudget >(100);
+		auto estimatePtr = memoryBudgetPtr->reserve(60);
+		estimatePtr->resize(20);
+		ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 20);
+		estimatePtr->resize(90);
+		ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 90);
+
+		auto splitPtr = estimatePtr->split(30);
+		ASSERT_EQ(splitPtr->getBytes(), 30);
+		ASSERT_EQ(estimatePtr->getBytes(), 60);
+		ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 90);
+		splitPtr = nullptr;
+		ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 60);
+		estimatePtr = nullptr;
+		ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 0);
+	}
+
+	TEST(MemoryBudgetTests, UnboundedBudgetNeverBlocks)
+	{
+		auto memoryBudgetPtr = std::make_shared< MemoryBudget >(0);
+		ASSERT_FALSE(memoryBudgetPtr->isBounded());
+		auto firstPtr = memoryBudgetPtr->reserve(1000000);
+		auto secondPtr = memoryBudgetPtr->tryReserve(1000000);
+		ASSERT_NE(secondPtr, nullptr);
+		secondPtr->resize(5000000);
+		ASSERT_EQ(memoryBudgetPtr->getReservedBytes(), 6000000);
+	}
+
+	TEST(MemoryBudgetTests, OverBudgetWindowsPassThroughThePipeline)
+	{
+		// graphite's loading, adjudicating and writing stages, every window grows past what is left of the budget once it is loaded
+		struct Pipeline
+		{
+			Pipeline() : memoryBudgetPtr(std::make_shared< MemoryBudget >(100)), loadedQueue(1), adjudicatedQueue(1), windowsWritten(0) {}
+			MemoryBudget::SharedPtr memoryBudgetPtr;
+			BoundedQueue< MemoryBudget::Reservation::SharedPtr > loadedQueue;
+			BoundedQueue< MemoryBudget::Reservation::SharedPtr > adjudicatedQueue;
+			std::atomic< uint32_t > windowsWritten;
+			std::promise< void > writtenPromise;
+		};
+		auto pipelinePtr = std::make_shared< Pipeline >();
+		auto writtenFuture = pipelinePtr->writtenPromise.get_future();
+		const uint32_t windowCount = 5;
+
+		std::thread loadingThread([pipelinePtr]()
+		{
+			auto referenceReservationPtr = pipelinePtr->memoryBudgetPtr->reserve(20);
+			for (uint32_t i = 0; i < windowCount; ++i)
+			{
+				auto windowReservationPtr = pipelinePtr->memoryBudgetPtr->reserve(10, referenceReservationPtr->getBytes());
+				windowReservationPtr->resize(150, referenceReservationPtr->getBytes());
+				pipelinePtr->loadedQueue.push(windowReservationPtr);
+			}
+			pipelinePtr->loadedQueue.close();
+		});
+		std::thread adjudicatingThread([pipelinePtr]()
+		{
+			MemoryBudget::Reservation::SharedPtr windowReservationPtr;
+			while (pipelinePtr->loadedQueue.pop(windowReservationPtr))
+			{
+				pipelinePtr->adjudicatedQueue.push(windowReservationPtr);
+			}
+			pipelinePtr->adjudicatedQueue.close();
+		});
+		std::thread writingThread([pipelinePtr]()
+		{
+			MemoryBudget::Reservation::SharedPtr windowReservationPtr;
+			while (pipelinePtr->adjudicatedQueue.pop(windowReservationPtr))
+			{
+				++pipelinePtr->windowsWritten;
+			}
+			pipelinePtr->writtenPromise.set_value();
+		});
+
+		// a stage holding its last window while it waits would leave the loader blocked for good
+		bool finished = writtenFuture.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+		if (!finished)
+		{
+			loadingThread.detach();
+			adjudicatingThread.detach();
+			writingThread.detach();
+		}
+		ASSERT_TRUE(finished);
+		loadingThread.join();
+		adjudicatingThread.join();
+		writingThread.join();
+		ASSERT_EQ(pipelinePtr->windowsWritten.load(), windowCount);
+		ASSERT_EQ(pipelinePtr->memoryBudgetPtr->getReservedBytes(), 0);
+	}
+}
+}
+
+#endif //GRAPHITE_MEMORYBUDGETTESTS_HPP
\ No newline at end of file
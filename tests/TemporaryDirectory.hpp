@@ -0,0 +1,58 @@
+#ifndef GRAPHITE_TESTS_TEMPORARYDIRECTORY_HPP
+#define GRAPHITE_TESTS_TEMPORARYDIRECTORY_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace test_util
+{
+	/*
+	 * A directory under TMPDIR (or /tmp) for the files a test writes. The
+	 * files handed out by getFilePath and the directory are removed when it
+	 * goes out of scope, failed assertions included.
+	 */
+	class TemporaryDirectory
+	{
+	public:
+		TemporaryDirectory()
+		{
+			const char* temporaryDirectory = getenv("TMPDIR");
+			std::string pathTemplate = std::string((temporaryDirectory != nullptr) ? temporaryDirectory : "/tmp") + "/graphite_test_XXXXXX";
+			if (mkdtemp(&pathTemplate[0]) == nullptr)
+			{
+				throw std::runtime_error("Unable to create a temporary directory from " + pathTemplate);
+			}
+			m_path = pathTemplate;
+		}
+
+		~TemporaryDirectory()
+		{
+			for (auto& filePath : m_file_paths)
+			{
+				std::remove(filePath.c_str());
+			}
+			rmdir(m_path.c_str());
+		}
+
+		std::string getPath() { return m_path; }
+
+		std::string getFilePath(const std::string& fileName)
+		{
+			m_file_paths.emplace_back(m_path + "/" + fileName);
+			return m_file_paths.back();
+		}
+
+	private:
+		TemporaryDirectory(const TemporaryDirectory&) = delete;
+		TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+		std::string m_path;
+		std::vector< std::string > m_file_paths;
+	};
+}
+
+#endif //GRAPHITE_TESTS_TEMPORARYDIRECTORY_HPP
@@ -0,0 +1,65 @@
+#ifndef GRAPHITE_TESTS_THREADPOOL_HPP
+#define GRAPHITE_TESTS_THREADPOOL_HPP
+
+#include <atomic>
+#include <stdexcept>
+
+#include "core/util/ThreadPool.hpp"
+
+TEST(ThreadPoolTests, ParallelForVisitsEveryIndex)
+{
+	std::vector< uint32_t > visited(10000, 0);
+	graphite::ThreadPool::Instance()->parallelFor(0, visited.size(), [&visited](size_t i) { visited[i] += 1; });
+	for (auto visitCount : visited)
+	{
+		ASSERT_EQ(visitCount, 1);
+	}
+}
+
+TEST(ThreadPoolTests, TaskGroupJoinWaitsForNestedTasks)
+{
+	std::atomic< uint32_t > count(0);
+	graphite::TaskGroup taskGroup;
+	for (uint32_t i = 0; i < 20; ++i)
+	{
+		taskGroup.run([&taskGroup, &count]()
+		{
+			for (uint32_t j = 0; j < 50; ++j)
+			{
+				taskGroup.run([&count]() { ++count; });
+			}
+		});
+	}
+	taskGroup.join();
+	ASSERT_EQ(count.load(), 1000);
+	ASSERT_EQ(taskGroup.getTaskCount(), 0);
+}
+
+TEST(ThreadPoolTests, TaskGroupJoinFromWorker)
+{
+	std::atomic< uint32_t > count(0);
+	graphite::TaskGroup outerTaskGroup;
+	for (uint32_t i = 0; i < graphite::ThreadPool::Instance()->getThreadCount() * 2; ++i)
+	{
+		outerTaskGroup.run([&count]()
+		{
+			graphite::TaskGroup innerTaskGroup;
+			for (uint32_t j = 0; j < 10; ++j)
+			{
+				innerTaskGroup.run([&count]() { ++count; });
+			}
+			innerTaskGroup.join();
+		});
+	}
+	outerTaskGroup.join();
+	ASSERT_EQ(count.load(), graphite::ThreadPool::Instance()->getThreadCount() * 20);
+}
+
+TEST(ThreadPoolTests, TaskGroupJoinRethrows)
+{
+	graphite::TaskGroup taskGroup;
+	taskGroup.run([]() { throw std::runtime_error("task failed"); });
+	ASSERT_THROW(taskGroup.join(), std::runtime_error);
+}
+
+#endif //GRAPHITE_TESTS_THREADPOOL_HPP
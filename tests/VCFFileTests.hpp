@@ -1,6 +1,8 @@
 #ifndef GRAPHITE_VCF_FILE_TESTS_HPP
 #define GRAPHITE_VCF_FILE_TESTS_HPP
 
+#include <algorithm>
+#include <fstream>
 #include <stdexcept>
 
 #include "core/variant/IVariant.h"
@@ -9,6 +11,7 @@
 #include "core/sample/Sample.h"
 
 #include "TestConfig.h"
+#include "TemporaryDirectory.hpp"
 
 TEST(VCFFileReaderTests, ReadAllChrom20)
 {
@@ -422,6 +425,247 @@ TEST(VCFFileReaderTests, ReadAllRegionsCheckCount)
 	ASSERT_EQ(count, totalCount);
 }
 
+TEST(VCFFileReaderTests, ReadChromInConsecutiveWindows)
+{
+	std::string chrom = "1";
+	std::string path = TEST_VCF_FILE;
+	auto regionPtr = std::make_shared< graphite::Region >(chrom, graphite::Region::BASED::ONE);
+	auto variantManagerPtr = std::make_shared< graphite::VCFManager >(path, regionPtr, nullptr, 3000);
+	variantManagerPtr->asyncLoadVCFs();
+	variantManagerPtr->waitForVCFsToLoadAndProcess();
+	auto allVariantPtrs = variantManagerPtr->getCompleteVariantList()->getAllVariantPtrs();
+
+	// the windows share one reader, the variant that ends a window has to show up in the next one
+	std::vector< graphite::VCFFileReader::SharedPtr > vcfFileReaderPtrs = { graphite::VCFFileReader::CreateVCFFileReader(path, nullptr, 3000) };
+	std::vector< graphite::position > windowPositions;
+	graphite::position windowStartPosition = 1;
+	graphite::position windowEndPosition = 0;
+	while (windowEndPosition < allVariantPtrs.back()->getPosition())
+	{
+		auto windowRegionPtr = std::make_shared< graphite::Region >(chrom, windowStartPosition, windowStartPosition + 1000000 - 1, graphite::Region::BASED::ONE);
+		auto windowManagerPtr = std::make_shared< graphite::VCFManager >(vcfFileReaderPtrs, windowRegionPtr, nullptr, 3000, graphite::MAX_POSITION);
+		windowManagerPtr->asyncLoadVCFs();
+		windowManagerPtr->waitForVCFsToLoadAndProcess();
+		windowEndPosition = windowManagerPtr->getRegion()->getEndPosition();
+		ASSERT_GE(windowEndPosition, windowRegionPtr->getEndPosition());
+		for (auto& variantPtr : windowManagerPtr->getCompleteVariantList()->getAllVariantPtrs())
+		{
+			ASSERT_GE(variantPtr->getPosition(), windowStartPosition);
+			ASSERT_LE(variantPtr->getPosition(), windowEndPosition);
+			windowPositions.emplace_back(variantPtr->getPosition());
+		}
+		windowStartPosition = windowEndPosition + 1;
+	}
+	ASSERT_EQ(windowPositions.size(), allVariantPtrs.size());
+	for (size_t i = 0; i < allVariantPtrs.size(); ++i)
+	{
+		ASSERT_EQ(windowPositions[i], allVariantPtrs[i]->getPosition());
+	}
+}
+
+TEST(VCFFileReaderTests, ReadAllRegionsThroughOneReader)
+{
+	uint32_t totalCount = 8127;
+	uint32_t count = 0;
+	std::string path = TEST_VCF_FILE;
+	auto regionPtrs = graphite::VCFFileReader::GetAllRegionsInVCF({ path });
+	ASSERT_EQ(regionPtrs.size(), 86); // the ##contig lines, most of them have no variants
+	std::vector< graphite::VCFFileReader::SharedPtr > vcfFileReaderPtrs = { graphite::VCFFileReader::CreateVCFFileReader(path, nullptr, 3000) };
+	std::unordered_set< std::string > loadedReferenceIDs;
+	for (auto& regionPtr : regionPtrs)
+	{
+		for (auto& variantPtr : vcfFileReaderPtrs[0]->getVariantsInRegion(regionPtr))
+		{
+			ASSERT_STREQ(regionPtr->getReferenceID().c_str(), variantPtr->getChrom().c_str());
+			++count;
+		}
+		loadedReferenceIDs.emplace(regionPtr->getReferenceID());
+	}
+	ASSERT_EQ(count, totalCount);
+	ASSERT_TRUE(graphite::VCFFileReader::GetNextRegionInVCFs(vcfFileReaderPtrs, loadedReferenceIDs) == nullptr);
+}
+
+TEST(VCFFileReaderTests, DiscoverRegionsWhileReading)
+{
+	std::string path = TEST_VCF_FILE;
+	std::vector< graphite::VCFFileReader::SharedPtr > vcfFileReaderPtrs = { graphite::VCFFileReader::CreateVCFFileReader(path, nullptr, 3000) };
+	std::unordered_set< std::string > loadedReferenceIDs;
+	std::vector< std::string > referenceIDs;
+	uint32_t count = 0;
+	graphite::Region::SharedPtr regionPtr;
+	while ((regionPtr = graphite::VCFFileReader::GetNextRegionInVCFs(vcfFileReaderPtrs, loadedReferenceIDs)) != nullptr)
+	{
+		count += vcfFileReaderPtrs[0]->getVariantsInRegion(regionPtr).size();
+		loadedReferenceIDs.emplace(regionPtr->getReferenceID());
+		referenceIDs.emplace_back(regionPtr->getReferenceID());
+	}
+	ASSERT_EQ(count, 8127);
+	ASSERT_EQ(referenceIDs.size(), 22);
+	ASSERT_STREQ(referenceIDs.front().c_str(), "1");
+	ASSERT_STREQ(referenceIDs.back().c_str(), "22");
+}
+
+TEST(VCFFileReaderTests, ReadRegionBehindTheReader)
+{
+	std::string path = TEST_VCF_FILE;
+	auto vcfFileReaderPtr = graphite::VCFFileReader::CreateVCFFileReader(path, nullptr, 3000);
+	ASSERT_EQ(vcfFileReaderPtr->getVariantsInRegion(std::make_shared< graphite::Region >("2", graphite::Region::BASED::ONE)).size(), 708);
+	ASSERT_EQ(vcfFileReaderPtr->getVariantsInRegion(std::make_shared< graphite::Region >("1", graphite::Region::BASED::ONE)).size(), 646);
+	ASSERT_EQ(vcfFileReaderPtr->getVariantsInRegion(std::make_shared< graphite::Region >("3", graphite::Region::BASED::ONE)).size(), 584);
+}
+
+// the positions a reader returns for the region, the unindexed reader of the same file is the reference for the indexed one
+std::vector< graphite::position > getVariantPositionsInRegion(graphite::VCFFileReader::SharedPtr vcfFileReaderPtr, graphite::Region::SharedPtr regionPtr)
+{
+	std::vector< graphite::position > positions;
+	for (auto& variantPtr : vcfFileReaderPtr->getVariantsInRegion(regionPtr))
+	{
+		positions.emplace_back(variantPtr->getPosition());
+	}
+	return positions;
+}
+
+std::vector< graphite::position > getUnindexedVariantPositionsInRegion(graphite::Region::SharedPtr regionPtr)
+{
+	return getVariantPositionsInRegion(graphite::VCFFileReader::CreateVCFFileReader(TEST_VCF_FILE, nullptr, 3000), regionPtr);
+}
+
+TEST(VCFFileReaderTests, IndexedReaderSeeksToRegions)
+{
+	ASSERT_FALSE(graphite::VCFFileReader::CreateVCFFileReader(TEST_VCF_FILE, nullptr, 3000)->isIndexed());
+	std::vector< std::string > regionStrings = { "1:1-4000000", "1:909434-3728155", "20", "22:30000000-40000000", "20:15200000-16000000" }; // the last starts inside a deletion's END
+	for (auto& regionString : regionStrings)
+	{
+		auto vcfFileReaderPtr = graphite::VCFFileReader::CreateVCFFileReader(TEST_VCF_GZ_FILE, nullptr, 3000);
+		ASSERT_TRUE(vcfFileReaderPtr->isIndexed());
+		auto regionPtr = std::make_shared< graphite::Region >(regionString, graphite::Region::BASED::ONE);
+		auto expectedPositions = getUnindexedVariantPositionsInRegion(regionPtr);
+		ASSERT_FALSE(expectedPositions.empty());
+		ASSERT_EQ(getVariantPositionsInRegion(vcfFileReaderPtr, regionPtr), expectedPositions);
+	}
+	auto regionPtr = std::make_shared< graphite::Region >("20", graphite::Region::BASED::ONE);
+	ASSERT_EQ(getVariantPositionsInRegion(graphite::VCFFileReader::CreateVCFFileReader(TEST_VCF_GZ_FILE, nullptr, 3000), regionPtr).size(), 181);
+}
+
+TEST(VCFFileReaderTests, IndexedReaderReadsAdjacentWindows)
+{
+	std::vector< std::pair< std::string, graphite::position > > chromWindowSizes = { { "1", 1000000 }, { "20", 100000 } };
+	for (auto& chromWindowSize : chromWindowSizes)
+	{
+		auto chromRegionPtr = std::make_shared< graphite::Region >(chromWindowSize.first, graphite::Region::BASED::ONE);
+		auto expectedPositions = getUnindexedVariantPositionsInRegion(chromRegionPtr);
+		auto vcfFileReaderPtr = graphite::VCFFileReader::CreateVCFFileReader(TEST_VCF_GZ_FILE, nullptr, 3000);
+		std::vector< graphite::position > windowPositions;
+		for (graphite::position windowStartPosition = 1; windowStartPosition <= expectedPositions.back(); windowStartPosition += chromWindowSize.second)
+		{
+			auto windowRegionPtr = std::make_shared< graphite::Region >(chromWindowSize.first, windowStartPosition, windowStartPosition + chromWindowSize.second - 1, graphite::Region::BASED::ONE);
+			for (auto position : getVariantPositionsInRegion(vcfFileReaderPtr, windowRegionPtr))
+			{
+				ASSERT_GE(position, windowRegionPtr->getStartPosition());
+				ASSERT_LE(position, windowRegionPtr->getEndPosition());
+				windowPositions.emplace_back(position);
+			}
+		}
+		ASSERT_EQ(windowPositions, expectedPositions);
+	}
+}
+
+TEST(VCFFileReaderTests, IndexedReaderReadsRegionsOutOfOrder)
+{
+	auto vcfFileReaderPtr = graphite::VCFFileReader::CreateVCFFileReader(TEST_VCF_GZ_FILE, nullptr, 3000);
+	// a later contig first, then back to an earlier one, then behind and overlapping the regions already read
+	std::vector< std::string > regionStrings = { "20", "1:1000000-5000000", "20:1-30000000", "2", "1:4000000-9000000", "1:2000000-3000000", "22" };
+	for (auto& regionString : regionStrings)
+	{
+		auto regionPtr = std::make_shared< graphite::Region >(regionString, graphite::Region::BASED::ONE);
+		auto expectedPositions = getUnindexedVariantPositionsInRegion(regionPtr);
+		ASSERT_FALSE(expectedPositions.empty());
+		ASSERT_EQ(getVariantPositionsInRegion(vcfFileReaderPtr, regionPtr), expectedPositions);
+	}
+}
+
+TEST(VCFFileReaderTests, IndexedReaderReadsEmptyRegions)
+{
+	auto vcfFileReaderPtr = graphite::VCFFileReader::CreateVCFFileReader(TEST_VCF_GZ_FILE, nullptr, 3000);
+	// before the first variant, a contig in the header without variants and one that isn't in the file at all
+	std::vector< std::string > regionStrings = { "20:1-100", "GL000191.1", "Y" };
+	for (auto& regionString : regionStrings)
+	{
+		auto regionPtr = std::make_shared< graphite::Region >(regionString, graphite::Region::BASED::ONE);
+		ASSERT_TRUE(getUnindexedVariantPositionsInRegion(regionPtr).empty());
+		ASSERT_TRUE(vcfFileReaderPtr->getVariantsInRegion(regionPtr).empty());
+	}
+	// the reader isn't left behind by the empty regions
+	ASSERT_EQ(vcfFileReaderPtr->getVariantsInRegion(std::make_shared< graphite::Region >("20", graphite::Region::BASED::ONE)).size(), 181);
+	ASSERT_EQ(vcfFileReaderPtr->getVariantsInRegion(std::make_shared< graphite::Region >("20:1-100", graphite::Region::BASED::ONE)).size(), 0);
+	ASSERT_EQ(vcfFileReaderPtr->getVariantsInRegion(std::make_shared< graphite::Region >("1", graphite::Region::BASED::ONE)).size(), 646);
+}
+
+// ##contig lines in 1, 2, ..., 10 order and the variants sorted lexicographically, 10 comes before 2
+std::string writeLexicographicVCF(test_util::TemporaryDirectory& temporaryDirectory, uint32_t variantsPerContig)
+{
+	std::vector< std::string > headerContigs;
+	for (uint32_t i = 1; i <= 10; ++i)
+	{
+		headerContigs.emplace_back(std::to_string(i));
+	}
+	std::vector< std::string > lineContigs = headerContigs;
+	std::sort(lineContigs.begin(), lineContigs.end());
+
+	std::string path = temporaryDirectory.getFilePath("lexicographic.vcf");
+	std::ofstream vcfStream(path);
+	vcfStream << "##fileformat=VCFv4.1" << std::endl;
+	for (auto& contig : headerContigs)
+	{
+		vcfStream << "##contig=<ID=" << contig << ",length=1000000>" << std::endl;
+	}
+	vcfStream << "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO" << std::endl;
+	for (auto& contig : lineContigs)
+	{
+		for (uint32_t i = 1; i <= variantsPerContig; ++i)
+		{
+			vcfStream << contig << "\t" << (i * 1000) << "\t.\tA\tC\t.\tPASS\t." << std::endl;
+		}
+	}
+	return path;
+}
+
+TEST(VCFFileReaderTests, ReadLexicographicallySortedVCFThroughOneReader)
+{
+	test_util::TemporaryDirectory temporaryDirectory;
+	std::string path = writeLexicographicVCF(temporaryDirectory, 3);
+	auto regionPtrs = graphite::VCFFileReader::GetAllRegionsInVCF({ path });
+	ASSERT_EQ(regionPtrs.size(), 10);
+	auto vcfFileReaderPtr = graphite::VCFFileReader::CreateVCFFileReader(path, nullptr, 3000);
+	for (auto& regionPtr : regionPtrs) // header order, so 2 through 9 are asked for after the reader has seen 10
+	{
+		auto variantPtrs = vcfFileReaderPtr->getVariantsInRegion(regionPtr);
+		ASSERT_EQ(variantPtrs.size(), 3) << regionPtr->getReferenceID();
+		for (auto& variantPtr : variantPtrs)
+		{
+			ASSERT_STREQ(variantPtr->getChrom().c_str(), regionPtr->getReferenceID().c_str());
+		}
+	}
+}
+
+TEST(VCFFileReaderTests, ReadLexicographicallySortedVCFInWindows)
+{
+	test_util::TemporaryDirectory temporaryDirectory;
+	std::string path = writeLexicographicVCF(temporaryDirectory, 3);
+	auto vcfFileReaderPtr = graphite::VCFFileReader::CreateVCFFileReader(path, nullptr, 3000);
+	for (auto& regionPtr : graphite::VCFFileReader::GetAllRegionsInVCF({ path }))
+	{
+		uint32_t count = 0;
+		graphite::position nextPosition;
+		while (vcfFileReaderPtr->getNextVariantPosition(regionPtr->getReferenceID(), nextPosition))
+		{
+			auto windowRegionPtr = std::make_shared< graphite::Region >(regionPtr->getReferenceID(), nextPosition, nextPosition + 999, graphite::Region::BASED::ONE);
+			count += vcfFileReaderPtr->getVariantsInRegion(windowRegionPtr).size();
+		}
+		ASSERT_EQ(count, 3) << regionPtr->getReferenceID();
+	}
+}
+
 // TEST(VCFFileReaderTests, VCFHeaderMultiSampleTest)
 // {
 
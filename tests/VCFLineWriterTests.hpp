@@ -0,0 +1,206 @@
+#ifndef GRAPHITE_TESTS_VCFLINEWRITERTESTS_HPP
+#define GRAPHITE_TESTS_VCFLINEWRITERTESTS_HPP
+
+#include "core/variant/VCFLineWriter.h"
+#include "core/variant/Variant.h"
+#include "core/variant/VCFHeader.h"
+#include "core/sample/SampleManager.h"
+#include "core/file/IFileWriter.h"
+#include "core/util/Utility.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace
+{
+namespace vcf_line_writer_test
+{
+	using namespace graphite;
+
+	const size_t s_flush_size = 1 << 22; // VCFLineWriter's
+
+	// keeps every write so the chunks can be checked
+	class RecordingFileWriter : public IFileWriter
+	{
+	public:
+		typedef std::shared_ptr< RecordingFileWriter > SharedPtr;
+		RecordingFileWriter() : IFileWriter(FileType::ASCII) {}
+
+		bool open() override { return true; }
+		void close() override {}
+		bool write(const char* data, size_t dataLength) override
+		{
+			this->m_written.append(data, dataLength);
+			this->m_write_sizes.emplace_back(dataLength);
+			return true;
+		}
+		std::string getFilePath() override { return ""; }
+
+		std::string m_written;
+		std::vector< size_t > m_write_sizes;
+	};
+
+	std::string getFormatString()
+	{
+		std::string formatString = "";
+		for (auto i = 0; i < AllAlleleCountTypes.size(); ++i)
+		{
+			std::string alleleTypeCountString = AlleleCountTypeToShortString(AllAlleleCountTypes[i]);
+			formatString += ((i > 0) ? ":DP_" : "DP_") + alleleTypeCountString + ":DP4_" + alleleTypeCountString;
+		}
+		return formatString;
+	}
+
+	// the line as the string path built it before VCFLineWriter, counts through std::to_string
+	std::string getStringPathVariantLine(const std::string& vcfLine, Variant::SharedPtr variantPtr, IHeader::SharedPtr headerPtr)
+	{
+		std::vector< std::string > fields;
+		split(vcfLine, '\t', fields);
+		std::vector< IAllele::SharedPtr > allelePtrs = { variantPtr->getRefAllelePtr() };
+		for (auto& altAllelePtr : variantPtr->getAltAllelePtrs())
+		{
+			allelePtrs.emplace_back(altAllelePtr);
+		}
+		std::string samplePadding = ".";
+		for (auto n = std::count(fields[8].begin(), fields[8].end(), ':'); n > 0; --n) { samplePadding += ":."; }
+
+		auto columnNames = headerPtr->getColumnNames();
+		std::string line = "";
+		for (size_t i = 0; i < columnNames.size(); ++i)
+		{
+			line += (i > 0) ? "\t" : "";
+			if (i < 8)
+			{
+				line += fields[i];
+				continue;
+			}
+			if (i == 8)
+			{
+				line += fields[i] + ":" + getFormatString();
+				continue;
+			}
+			line += ((i < fields.size()) ? fields[i] : samplePadding) + ":";
+			if (!headerPtr->isActiveSampleColumnName(columnNames[i]))
+			{
+				for (auto j = 0; j < AllAlleleCountTypes.size(); ++j)
+				{
+					line += ".:.:";
+				}
+				line += ".";
+				continue;
+			}
+			for (auto j = 0; j < AllAlleleCountTypes.size(); ++j)
+			{
+				uint32_t totalCount = 0;
+				std::string sampleString = "";
+				for (size_t k = 0; k < allelePtrs.size(); ++k)
+				{
+					uint32_t forwardCount = allelePtrs[k]->getForwardCount(columnNames[i], AllAlleleCountTypes[j]);
+					uint32_t reverseCount = allelePtrs[k]->getReverseCount(columnNames[i], AllAlleleCountTypes[j]);
+					sampleString += ((k > 0) ? "," : "") + std::to_string(forwardCount) + "," + std::to_string(reverseCount);
+					totalCount += forwardCount + reverseCount;
+				}
+				line += ((j > 0) ? ":" : "") + std::to_string(totalCount) + ":" + sampleString;
+			}
+		}
+		return line + "\n";
+	}
+
+	// vlw_a is in the line, vlw_b is in the line but not active, vlw_c is only registered
+	IHeader::SharedPtr getHeader(std::vector< Sample::SharedPtr >& samplePtrs)
+	{
+		samplePtrs = { std::make_shared< Sample >("vlw_a", "vlw_rg_a", ""), std::make_shared< Sample >("vlw_c", "vlw_rg_c", "") };
+		auto headerPtr = std::make_shared< VCFHeader >(std::vector< std::string >({ "##fileformat=VCFv4.2", "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tvlw_a\tvlw_b" }));
+		headerPtr->registerActiveSample(std::make_shared< SampleManager >(samplePtrs));
+		return headerPtr;
+	}
+
+	TEST(VCFLineWriterTests, AppendCountMatchesToString)
+	{
+		std::vector< uint32_t > counts = { 0, 9, 10, 99, 100, 999, 1000, 65535, 1000000000, std::numeric_limits< uint32_t >::max() };
+		for (uint32_t count = 0; count < 20000; count += 7)
+		{
+			counts.emplace_back(count);
+		}
+		std::vector< Sample::SharedPtr > samplePtrs;
+		VCFLineWriter lineWriter(nullptr, getHeader(samplePtrs));
+		for (auto count : counts)
+		{
+			lineWriter.clear();
+			lineWriter.appendCount(count);
+			ASSERT_EQ(lineWriter.getBuffer(), std::to_string(count));
+		}
+	}
+
+	TEST(VCFLineWriterTests, WriteVariantLineMatchesStringPath)
+	{
+		std::vector< Sample::SharedPtr > samplePtrs;
+		auto headerPtr = getHeader(samplePtrs);
+		std::string vcfLine = "1\t100\t.\tA\tC,G\t.\tPASS\t.\tGT:GQ\t0/1:30\t1/1:20";
+		auto variantPtr = Variant::BuildVariant(vcfLine, nullptr, 100);
+		auto allelePtrs = variantPtr->getAltAllelePtrs();
+		allelePtrs.insert(allelePtrs.begin(), variantPtr->getRefAllelePtr());
+
+		// counts of 0, 9, 10, 99 and 100 across the alleles, strands and count types
+		std::vector< uint32_t > counts = { 0, 9, 10, 99, 100 };
+		for (size_t i = 0; i < allelePtrs.size(); ++i)
+		{
+			for (size_t j = 0; j < AllAlleleCountTypes.size(); ++j)
+			{
+				uint32_t forwardCount = counts[(i + j) % counts.size()];
+				uint32_t reverseCount = counts[(i + (j * 2) + 1) % counts.size()];
+				for (uint32_t k = 0; k < forwardCount; ++k) { allelePtrs[i]->incrementCount(false, samplePtrs[0], AllAlleleCountTypes[j]); }
+				for (uint32_t k = 0; k < reverseCount; ++k) { allelePtrs[i]->incrementCount(true, samplePtrs[(i + j) % samplePtrs.size()], AllAlleleCountTypes[j]); }
+			}
+		}
+
+		VCFLineWriter lineWriter(nullptr, headerPtr);
+		variantPtr->writeVariantLine(lineWriter);
+		ASSERT_EQ(lineWriter.getBuffer(), getStringPathVariantLine(vcfLine, variantPtr, headerPtr));
+	}
+
+	TEST(VCFLineWriterTests, WritesAcrossFlushBoundary)
+	{
+		std::vector< Sample::SharedPtr > samplePtrs;
+		auto headerPtr = getHeader(samplePtrs);
+		std::string vcfLine = "1\t100\t.\tA\tC\t.\tPASS\t.\tGT\t0/1\t1/1";
+		auto variantPtr = Variant::BuildVariant(vcfLine, nullptr, 100);
+		for (uint32_t k = 0; k < 100; ++k) { variantPtr->getRefAllelePtr()->incrementCount((k % 2) == 0, samplePtrs[k % samplePtrs.size()], AllAlleleCountTypes[k % AllAlleleCountTypes.size()]); }
+		std::string expectedLine = getStringPathVariantLine(vcfLine, variantPtr, headerPtr);
+
+		// enough lines for two full chunks and a partial one
+		size_t lineCount = ((s_flush_size * 2) / expectedLine.size()) + 100;
+		auto fileWriterPtr = std::make_shared< RecordingFileWriter >();
+		{
+			VCFLineWriter lineWriter(fileWriterPtr, headerPtr);
+			lineWriter.writeHeader();
+			for (size_t i = 0; i < lineCount; ++i)
+			{
+				variantPtr->writeVariantLine(lineWriter);
+				lineWriter.endLine();
+			}
+			lineWriter.flush();
+		}
+
+		std::string expected = headerPtr->getHeader();
+		expected.reserve(expected.size() + (expectedLine.size() * lineCount));
+		for (size_t i = 0; i < lineCount; ++i)
+		{
+			expected += expectedLine;
+		}
+		ASSERT_EQ(fileWriterPtr->m_written.size(), expected.size());
+		ASSERT_TRUE(fileWriterPtr->m_written == expected);
+		ASSERT_EQ(fileWriterPtr->m_write_sizes.size(), 3);
+		for (size_t i = 0; i < fileWriterPtr->m_write_sizes.size() - 1; ++i)
+		{
+			ASSERT_GE(fileWriterPtr->m_write_sizes[i], s_flush_size);
+			ASSERT_LT(fileWriterPtr->m_write_sizes[i], s_flush_size + expectedLine.size());
+		}
+	}
+}
+}
+
+#endif //GRAPHITE_TESTS_VCFLINEWRITERTESTS_HPP
@@ -364,4 +364,15 @@ namespace
 		ASSERT_EQ(variantPtr->getAltAllelePtrs().size(), 1);
 	}
 
+	TEST(VariantsTest, ParseVariantInfoKeyNotPrefixTest)
+	{
+		std::string vcfLine = "1\t10\t.\tT\t<INS>\t.\t.\tXSEQ=GG;SEQLEN=3;DB;SEQ=TACGT\tGT\t0/1";
+		graphite::Variant::SharedPtr variantPtr;
+		variantPtr = graphite::Variant::BuildVariant(vcfLine.c_str(), nullptr, 300);
+
+		ASSERT_FALSE(variantPtr->shouldSkip());
+		ASSERT_STREQ(variantPtr->getAltAllelePtrs()[0]->getSequence(), "TACGT");
+		ASSERT_EQ(variantPtr->getVariantSize(), 5);
+	}
+
 }
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+# Writes tests/data/test.bam and its .bai without samtools, usage: make_test_bam.py tests/data/test.bam
+#
+# One read group (ID SRR622461, SM NA12878) and 50 base, 50M reads:
+#   chromosome 1:  2000 reads every 10,000 bases from 5,000,000 then 500 reads every 100,000 bases from 150,000,000,
+#                  read k is a first mate when k is even and on the reverse strand when it is odd, reads with k % 10 == 5
+#                  are duplicates and reads with k % 100 == 0 have a second, secondary line
+#   chromosome 20: 900 reads every 10,000 bases from 1,000,000
+# Read k's bases are ACGTTGCA repeated, starting k % 8 bases in. Positions are 0 based.
+# HTSLibAlignmentReaderTests derives its expected counts from this layout.
+import struct, zlib, sys
+
+out_bam = sys.argv[1]
+out_bai = out_bam + ".bai"
+
+READ_LENGTH = 50
+PATTERN = "ACGTTGCA"
+
+def reg2bin(beg, end):
+    end -= 1
+    if beg >> 14 == end >> 14: return ((1 << 15) - 1) // 7 + (beg >> 14)
+    if beg >> 17 == end >> 17: return ((1 << 12) - 1) // 7 + (beg >> 17)
+    if beg >> 20 == end >> 20: return ((1 << 9) - 1) // 7 + (beg >> 20)
+    if beg >> 23 == end >> 23: return ((1 << 6) - 1) // 7 + (beg >> 23)
+    if beg >> 26 == end >> 26: return ((1 << 3) - 1) // 7 + (beg >> 26)
+    return 0
+
+refs = [("1", 250000000), ("20", 63025520)]
+header_text = "@HD\tVN:1.6\tSO:coordinate\n" + "".join("@SQ\tSN:%s\tLN:%d\n" % r for r in refs) + "@RG\tID:SRR622461\tSM:NA12878\n"
+
+def reads():
+    # (refID, pos, name, flag, k)
+    chr1 = [5000000 + k * 10000 for k in range(2000)] + [150000000 + k * 100000 for k in range(500)]
+    for k, pos in enumerate(chr1):
+        flag = 0x1 | (0x40 if k % 2 == 0 else 0x80) | (0x10 if k % 2 == 1 else 0)
+        if k % 10 == 5: flag |= 0x400
+        yield (0, pos, "r1_%d" % k, flag, k)
+        if k % 100 == 0:
+            yield (0, pos, "r1_%d" % k, flag | 0x100, k) # a secondary line of the same read
+    for k in range(900):
+        yield (1, 1000000 + k * 10000, "r20_%d" % k, 0x1 | 0x40, k)
+
+def encode_record(refID, pos, name, flag, k):
+    seq = (PATTERN * ((READ_LENGTH + len(PATTERN)) // len(PATTERN)))[k % len(PATTERN):][:READ_LENGTH]
+    codes = {"=": 0, "A": 1, "C": 2, "G": 4, "T": 8, "N": 15}
+    packed = bytearray((READ_LENGTH + 1) // 2)
+    for i, base in enumerate(seq):
+        packed[i // 2] |= codes[base] << (4 if i % 2 == 0 else 0)
+    qname = name.encode() + b"\0"
+    cigar = struct.pack("<I", (READ_LENGTH << 4) | 0) # 50M
+    qual = bytes([30] * READ_LENGTH)
+    aux = b"RGZSRR622461\0"
+    body = struct.pack("<iiBBHHHiiii", refID, pos, len(qname), 60, reg2bin(pos, pos + READ_LENGTH), 1, flag, READ_LENGTH, -1, -1, 0)
+    body += qname + cigar + bytes(packed) + qual + aux
+    return struct.pack("<i", len(body)) + body
+
+def bgzf_block(data):
+    compressor = zlib.compressobj(6, zlib.DEFLATED, -15)
+    cdata = compressor.compress(data) + compressor.flush()
+    bsize = 18 + len(cdata) + 8
+    header = struct.pack("<BBBBIBBHBBHH", 31, 139, 8, 4, 0, 0, 255, 6, 66, 67, 2, bsize - 1)
+    return header + cdata + struct.pack("<II", zlib.crc32(data) & 0xffffffff, len(data))
+
+EOF_BLOCK = bytes.fromhex("1f8b08040000000000ff0600424302001b0003000000000000000000")
+
+blocks = []       # compressed blocks
+pending = bytearray()
+pending_records = [] # (index into records, uoffset)
+records = []      # dicts with refID, pos, end, vstart and vend
+coffset = 0
+
+def flush():
+    global pending, coffset
+    if not pending: return
+    block = bgzf_block(bytes(pending))
+    for index, uoffset in pending_records:
+        records[index]["vstart"] = (coffset << 16) | uoffset
+    blocks.append(block)
+    coffset += len(block)
+    pending = bytearray()
+    pending_records.clear()
+
+bam_header = b"BAM\1" + struct.pack("<i", len(header_text)) + header_text.encode() + struct.pack("<i", len(refs))
+for name, length in refs:
+    bam_header += struct.pack("<i", len(name) + 1) + name.encode() + b"\0" + struct.pack("<i", length)
+pending += bam_header
+flush()
+
+for refID, pos, name, flag, k in reads():
+    data = encode_record(refID, pos, name, flag, k)
+    if len(pending) + len(data) > 0xff00:
+        flush()
+    records.append({"refID": refID, "pos": pos, "end": pos + READ_LENGTH, "name": name, "flag": flag})
+    pending_records.append((len(records) - 1, len(pending)))
+    pending += data
+flush()
+eof_voffset = coffset << 16
+
+with open(out_bam, "wb") as f:
+    for block in blocks: f.write(block)
+    f.write(EOF_BLOCK)
+
+# the index, each record's chunk ends where the next record starts
+for i, record in enumerate(records):
+    record["vend"] = records[i + 1]["vstart"] if i + 1 < len(records) else eof_voffset
+
+bai = bytearray(b"BAI\1") + struct.pack("<i", len(refs))
+for refID in range(len(refs)):
+    ref_records = [r for r in records if r["refID"] == refID]
+    bins = {}
+    linear = {}
+    for r in ref_records:
+        b = reg2bin(r["pos"], r["end"])
+        chunks = bins.setdefault(b, [])
+        if chunks and chunks[-1][1] == r["vstart"]:
+            chunks[-1][1] = r["vend"]
+        else:
+            chunks.append([r["vstart"], r["vend"]])
+        for window in range(r["pos"] >> 14, ((r["end"] - 1) >> 14) + 1):
+            if window not in linear or r["vstart"] < linear[window]:
+                linear[window] = r["vstart"]
+    bai += struct.pack("<i", len(bins))
+    for b in sorted(bins):
+        bai += struct.pack("<Ii", b, len(bins[b]))
+        for beg, end in bins[b]:
+            bai += struct.pack("<QQ", beg, end)
+    n_intv = (max(linear) + 1) if linear else 0
+    bai += struct.pack("<i", n_intv)
+    last = 0
+    for window in range(n_intv):
+        last = linear.get(window, last)
+        bai += struct.pack("<Q", last)
+bai += struct.pack("<Q", 0)
+with open(out_bai, "wb") as f:
+    f.write(bai)
@@ -2,15 +2,25 @@
 
 #include "VCFFileTests.hpp"
 #include "BamAlignmentReaderTests.hpp"
+#include "HTSLibAlignmentReaderTests.hpp"
 #include "RegionTests.hpp"
 #include "FileTests.hpp"
 #include "VCFFileTests.hpp"
 #include "GSSWTests.hpp"
 #include "GSSWGraphTests.hpp"
+#include "AdjudicationTests.hpp"
 #include "AlleleTests.hpp"
 #include "VariantsTest.hpp"
 #include "CompoundVariantTests.hpp"
 #include "FastaReferenceTests.hpp"
+#include "ThreadPoolTests.hpp"
+#include "BGZFThreadPoolTests.hpp"
+#include "MemoryBudgetTests.hpp"
+#include "GraphSmithWatermanTests.hpp"
+#include "VCFLineWriterTests.hpp"
+#include "GraphManagerTests.hpp"
+#include "GraphKmerIndexTests.hpp"
+#include "AlignmentStoreTests.hpp"
 
 GTEST_API_ int main(int argc, char** argv)
 {
@@ -4,10 +4,12 @@
 #include "core/variant/VCFManager.h"
 #include "core/variant/VCFFileReader.h"
 #include "core/reference/FastaReference.h"
-#include "core/mapping/MappingManager.h"
 #include "core/variant/VCFHeader.h"
 #include "core/util/Params.h"
 #include "core/util/ThreadPool.hpp"
+#include "core/util/BGZFThreadPool.hpp"
+#include "core/util/BoundedQueue.hpp"
+#include "core/util/MemoryBudget.hpp"
 #include "core/graph/GraphManager.h"
 #include "core/adjudicator/GSSWAdjudicator.h"
 #include "core/variant/VCFHeader.h"
@@ -20,14 +22,32 @@
 #include <thread>
 #include <unordered_set>
 #include <fstream>
+#include <iostream>
 #include <stdio.h>
 
 #include <zlib.h>
 
+// the state of a single region as it moves through the load, adjudicate and write stages
+struct RegionWork
+{
+	graphite::IReference::SharedPtr fastaReferencePtr;
+	graphite::VCFManager::SharedPtr variantManagerPtr;
+	graphite::BamAlignmentManager::SharedPtr bamAlignmentManagerPtr;
+	// released along with what they account for, the reference's is shared by all of a contig's windows
+	graphite::MemoryBudget::Reservation::SharedPtr referenceReservationPtr;
+	graphite::MemoryBudget::Reservation::SharedPtr variantReservationPtr;
+	graphite::MemoryBudget::Reservation::SharedPtr alignmentReservationPtr;
+};
+
+// with a memory limit each contig is loaded in windows, the next window's size comes from the bytes per base of the last one.
+// A window's bytes are reserved from that estimate before it is fetched and corrected once it is loaded, the first window is assumed to fill its share.
+static const graphite::position s_initial_window_size = 1000000;
+static const graphite::position s_min_window_size = 10000;
+static const uint64_t s_windows_in_flight = 4; // loading, adjudicating and writing plus the one waiting between them
+
 int main(int argc, char** argv)
 {
 	// graphite::AlignmentManager< HTSLibAlignmentReader > tmp;
-	unsigned long milliseconds_since_epoch = std::chrono::system_clock::now().time_since_epoch() / std::chrono::milliseconds(1);
 	graphite::Params params;
 	params.parseGSSW(argc, argv);
 	if (params.showHelp() || !params.validateRequired())
@@ -42,15 +62,19 @@ int main(int argc, char** argv)
 	auto paramRegionPtr = params.getRegion();
 	auto swPercent = params.getPercent();
 	auto threadCount = params.getThreadCount();
+	auto readBatchSize = params.getReadBatchSize();
+	auto maxClusterSpan = params.getMaxClusterSpan();
 	auto matchValue = params.getMatchValue();
 	auto misMatchValue = params.getMisMatchValue();
 	auto gapOpenValue = params.getGapOpenValue();
 	auto gapExtensionValue = params.getGapExtensionValue();
 	auto excludeDuplicates = params.getExcludeDuplicates();
 	auto graphSize = params.getGraphSize();
+	auto maxMemoryBytes = params.getMaxMemoryBytes();
 	graphite::FileType fileType = graphite::FileType::ASCII;
 
 	graphite::ThreadPool::Instance()->setThreadCount(threadCount);
+	graphite::BGZFThreadPool::Instance()->setThreadCount(graphite::BGZFThreadPool::GetThreadShare(threadCount));
 
 	std::vector< graphite::Region::SharedPtr > regionPtrs;
 	if (paramRegionPtr == nullptr)
@@ -93,84 +117,230 @@ int main(int argc, char** argv)
 	}
 
 	std::unordered_set< std::string > outputPaths;
-	bool firstTime = true;
 
-	for (uint32_t regionCount = 0; regionCount < regionPtrs.size(); ++regionCount)
-	{
-		auto alignmentReaderManagerPtr = std::make_shared< graphite::AlignmentReaderManager< graphite::BamAlignmentReader > >(bamPaths, threadCount); // this used to go above this loop but it caused issues with loading bam regions from out-of-order VCFs
-		auto regionPtr = regionPtrs[regionCount];
-		auto fastaReferencePtr = std::make_shared< graphite::FastaReference >(fastaPath, regionPtr);
+	// a quarter of the limit goes to the graphs being adjudicated, the rest to the references, variants and alignments of the loaded windows
+	auto graphMemoryBudgetPtr = std::make_shared< graphite::MemoryBudget >(maxMemoryBytes / 4);
+	auto regionMemoryBudgetPtr = std::make_shared< graphite::MemoryBudget >(maxMemoryBytes - (maxMemoryBytes / 4));
 
-		// load variants from vcf
-		auto variantManagerPtr = std::make_shared< graphite::VCFManager >(vcfPaths, regionPtr, fastaReferencePtr, readLength);
-		variantManagerPtr->asyncLoadVCFs(); // begin the process of loading the vcfs asynchronously
+	// regions flow through three stages, loading region N+1, adjudicating region N and writing region N-1 overlap.
+	// The queues between the stages are bounded so only a few regions are held in memory at once.
+	graphite::BoundedQueue< std::shared_ptr< RegionWork > > loadedRegionQueue(1);
+	graphite::BoundedQueue< std::shared_ptr< RegionWork > > adjudicatedRegionQueue(1);
 
-		variantManagerPtr->waitForVCFsToLoadAndProcess(); // wait for vcfs to load into memory
+	// mapped once and each region's reference shares its contig, without a memory limit a contig for each stage stays loaded after its regions are done
+	auto fastaFilePtr = std::make_shared< graphite::FastaFile >(fastaPath, (regionMemoryBudgetPtr->isBounded()) ? 1 : 3);
 
-		// load bam alignments
-		auto bamAlignmentManager = std::make_shared< graphite::BamAlignmentManager >(sampleManagerPtr, regionPtr, alignmentReaderManagerPtr, excludeDuplicates);
-		bamAlignmentManager->loadAlignments(variantManagerPtr);
-		// bamAlignmentManager->asyncLoadAlignments(variantManagerPtr, graphSize); // begin the process of loading the alignments asynchronously
-		// bamAlignmentManager->waitForAlignmentsToLoad(); // wait for alignments to load into memory
-
-		variantManagerPtr->releaseResources(); // releases the vcf file memory, we no longer need the file resources
-		bamAlignmentManager->releaseResources(); // release the bam file into memory, we no longer need the file resources
-
-		std::deque< std::shared_ptr< std::future< void > > > variantManagerFutureFunctions;
-		for (auto& iter : variantManagerPtr->getVCFReadersAndVariantListsMap())
+	std::thread loadingThread([&]()
+	{
+		// the readers are shared by all of the windows, each window picks up where the last one stopped reading
+		std::vector< graphite::VCFFileReader::SharedPtr > vcfFileReaderPtrs;
+		for (auto& vcfPath : vcfPaths)
 		{
-			auto futureFunct = graphite::ThreadPool::Instance()->enqueue(std::bind(&graphite::IVariantList::processOverlappingAlleles, iter.second));
-			variantManagerFutureFunctions.push_back(futureFunct);
+			vcfFileReaderPtrs.emplace_back(graphite::VCFFileReader::CreateVCFFileReader(vcfPath, nullptr, readLength));
 		}
-		while (!variantManagerFutureFunctions.empty())
+
+		std::unordered_set< std::string > loadedReferenceIDs;
+		for (uint32_t regionCount = 0; ; ++regionCount)
 		{
-			variantManagerFutureFunctions.front()->wait();
-			variantManagerFutureFunctions.pop_front();
-		}
+			if (regionCount == regionPtrs.size())
+			{
+				// contigs that aren't in the headers or indices are found in the same pass that reads their variants
+				auto nextRegionPtr = (paramRegionPtr == nullptr) ? graphite::VCFFileReader::GetNextRegionInVCFs(vcfFileReaderPtrs, loadedReferenceIDs) : nullptr;
+				if (nextRegionPtr == nullptr)
+				{
+					break;
+				}
+				regionPtrs.emplace_back(nextRegionPtr);
+			}
+			auto regionPtr = regionPtrs[regionCount];
+			loadedReferenceIDs.emplace(regionPtr->getReferenceID());
 
-		milliseconds_since_epoch = std::chrono::system_clock::now().time_since_epoch() / std::chrono::milliseconds(1);
+			// the reference and the alignment readers are only set up for contigs with variants to adjudicate
+			if (!fastaFilePtr->hasContig(regionPtr->getReferenceID()))
+			{
+				std::cerr << "Warning: " << regionPtr->getReferenceID() << " isn't in " << fastaPath << ", its variants are skipped" << std::endl;
+				continue;
+			}
+			bool hasVariants = false;
+			for (auto& vcfFileReaderPtr : vcfFileReaderPtrs)
+			{
+				graphite::position readerNextPosition;
+				if (vcfFileReaderPtr->getNextVariantPosition(regionPtr->getReferenceID(), readerNextPosition) && readerNextPosition <= regionPtr->getEndPosition())
+				{
+					hasVariants = true;
+					break;
+				}
+			}
+			if (!hasVariants)
+			{
+				continue;
+			}
 
-		// create an adjudicator for the graph
-		auto gsswAdjudicator = std::make_shared< graphite::GSSWAdjudicator >(swPercent, matchValue, misMatchValue, gapOpenValue, gapExtensionValue);
+			auto fastaReferencePtr = std::make_shared< graphite::FastaReference >(fastaFilePtr, regionPtr);
+			auto referenceReservationPtr = regionMemoryBudgetPtr->reserve(fastaReferencePtr->getSequenceSize());
 
-		// the gsswGraphManager adjudicates on the variantManager's variants
-		auto gsswGraphManager = std::make_shared< graphite::GraphManager >(fastaReferencePtr, variantManagerPtr, bamAlignmentManager, gsswAdjudicator);
-		// auto gsswGraphManager = std::make_shared< graphite::GraphManager >(fastaReferencePtr, variantManagerPtr, alignmentManager, gsswAdjudicator);
-		gsswGraphManager->buildGraphs(fastaReferencePtr->getRegion(), readLength);
+			auto alignmentReaderManagerPtr = graphite::BamAlignmentManager::CreateAlignmentReaderManager(bamPaths, threadCount, params.getUseBamTools()); // this used to go above this loop but it caused issues with loading bam regions from out-of-order VCFs
 
-		graphite::MappingManager::Instance()->evaluateAlignmentMappings(gsswAdjudicator);
-		graphite::MappingManager::Instance()->clearRegisteredMappings();
+			for (auto& vcfFileReaderPtr : vcfFileReaderPtrs)
+			{
+				vcfFileReaderPtr->setReferencePtr(fastaReferencePtr);
+			}
 
-		std::vector< std::shared_ptr< std::thread > > fileWriters;
-		auto vcfPathsAndVariantListPtrsMap = variantManagerPtr->getVCFReadersAndVariantListsMap();
-		std::deque< std::shared_ptr< std::future< void > > > vcfWriterFutureFunctions;
-		for (auto& iter : vcfPathsAndVariantListPtrsMap)
-		{
-			auto vcfReaderPtr = iter.first;
-			auto vcfPath = vcfReaderPtr->getFilePath();
-			graphite::IFileWriter::SharedPtr fileWriter = vcfoutPaths[vcfPath];
-			std::string currentVCFOutPath = fileWriter->getFilePath();
-			auto variantListPtr = iter.second;
-			auto vcfHeaderPtr = vcfReaderPtr->getVCFHeader();
-
-			vcfHeaderPtr->registerActiveSample(sampleManagerPtr);
-			if (firstTime)
+			uint64_t referenceBytes = referenceReservationPtr->getBytes();
+			uint64_t windowBudget = (regionMemoryBudgetPtr->getMaxBytes() - std::min(regionMemoryBudgetPtr->getMaxBytes(), referenceBytes)) / s_windows_in_flight;
+			uint64_t bytesPerBase = std::max< uint64_t >(windowBudget / s_initial_window_size, 1);
+			graphite::position windowStartPosition = regionPtr->getStartPosition();
+			graphite::position windowSize = s_initial_window_size;
+			while (true)
 			{
-				outputPaths.emplace(currentVCFOutPath);
+				auto windowRegionPtr = regionPtr;
+				graphite::MemoryBudget::Reservation::SharedPtr windowReservationPtr;
+				if (regionMemoryBudgetPtr->isBounded())
+				{
+					// skip ahead to the next variant so windows aren't spent on stretches without any
+					bool hasNextPosition = false;
+					graphite::position nextPosition = 0;
+					for (auto& vcfFileReaderPtr : vcfFileReaderPtrs)
+					{
+						graphite::position readerNextPosition;
+						if (vcfFileReaderPtr->getNextVariantPosition(regionPtr->getReferenceID(), readerNextPosition))
+						{
+							nextPosition = (hasNextPosition) ? std::min(nextPosition, readerNextPosition) : readerNextPosition;
+							hasNextPosition = true;
+						}
+					}
+					if (!hasNextPosition || nextPosition > regionPtr->getEndPosition())
+					{
+						break;
+					}
+					windowStartPosition = std::max(windowStartPosition, nextPosition);
+
+					// a window that doesn't fit beside the ones in flight is halved until it does, at the minimum size it waits for them instead
+					graphite::position windowEndPosition;
+					while (true)
+					{
+						windowEndPosition = (regionPtr->getEndPosition() - windowStartPosition < windowSize) ? regionPtr->getEndPosition() : windowStartPosition + windowSize - 1;
+						uint64_t estimatedBytes = ((windowEndPosition - windowStartPosition) + 1) * bytesPerBase;
+						windowReservationPtr = regionMemoryBudgetPtr->tryReserve(estimatedBytes, referenceBytes);
+						if (windowReservationPtr != nullptr)
+						{
+							break;
+						}
+						if (windowSize <= s_min_window_size)
+						{
+							windowReservationPtr = regionMemoryBudgetPtr->reserve(estimatedBytes, referenceBytes);
+							break;
+						}
+						windowSize = std::max(windowSize / 2, s_min_window_size);
+					}
+					windowRegionPtr = std::make_shared< graphite::Region >(regionPtr->getReferenceID(), windowStartPosition, windowEndPosition, graphite::Region::BASED::ONE);
+				}
+				auto regionWorkPtr = std::make_shared< RegionWork >();
+
+				// load variants from vcf, the window is extended so it ends between clusters of variants
+				auto variantManagerPtr = std::make_shared< graphite::VCFManager >(vcfFileReaderPtrs, windowRegionPtr, fastaReferencePtr, readLength, regionPtr->getEndPosition());
+				variantManagerPtr->asyncLoadVCFs(); // begin the process of loading the vcfs asynchronously
+
+				variantManagerPtr->waitForVCFsToLoadAndProcess(); // wait for vcfs to load into memory
+				windowRegionPtr = variantManagerPtr->getRegion();
+
+				// load bam alignments
+				auto bamAlignmentManager = std::make_shared< graphite::BamAlignmentManager >(sampleManagerPtr, windowRegionPtr, alignmentReaderManagerPtr, excludeDuplicates);
+				bamAlignmentManager->loadAlignments(variantManagerPtr);
+				// bamAlignmentManager->asyncLoadAlignments(variantManagerPtr, graphSize); // begin the process of loading the alignments asynchronously
+				// bamAlignmentManager->waitForAlignmentsToLoad(); // wait for alignments to load into memory
+
+				variantManagerPtr->releaseResources(); // releases the vcf file memory, we no longer need the file resources
+				bamAlignmentManager->releaseResources(); // release the bam file into memory, we no longer need the file resources
+
+				graphite::TaskGroup variantListTaskGroup;
+				for (auto& iter : variantManagerPtr->getVCFReadersAndVariantListsMap())
+				{
+					variantListTaskGroup.run(std::bind(&graphite::IVariantList::processOverlappingAlleles, iter.second));
+				}
+				variantListTaskGroup.join();
+
+				regionWorkPtr->fastaReferencePtr = fastaReferencePtr;
+				regionWorkPtr->variantManagerPtr = variantManagerPtr;
+				regionWorkPtr->bamAlignmentManagerPtr = bamAlignmentManager;
+				regionWorkPtr->referenceReservationPtr = referenceReservationPtr;
+				if (regionMemoryBudgetPtr->isBounded())
+				{
+					// the estimate becomes what was loaded, growing it waits until the windows ahead of this one have freed enough
+					uint64_t variantBytes = variantManagerPtr->getMemoryUsage();
+					uint64_t alignmentBytes = bamAlignmentManager->getMemoryUsage();
+					windowReservationPtr->resize(variantBytes + alignmentBytes, referenceBytes);
+					regionWorkPtr->alignmentReservationPtr = windowReservationPtr->split(alignmentBytes); // the alignments are freed before the variants
+					regionWorkPtr->variantReservationPtr = windowReservationPtr;
+
+					uint64_t windowLength = (windowRegionPtr->getEndPosition() - windowRegionPtr->getStartPosition()) + 1;
+					bytesPerBase = std::max< uint64_t >((variantBytes + alignmentBytes) / windowLength, 1);
+					windowSize = std::max< uint64_t >(std::min< uint64_t >(windowBudget / bytesPerBase, graphite::MAX_POSITION), s_min_window_size);
+				}
+				loadedRegionQueue.push(regionWorkPtr);
+
+				if (!regionMemoryBudgetPtr->isBounded() || windowRegionPtr->getEndPosition() >= regionPtr->getEndPosition())
+				{
+					break;
+				}
+				windowStartPosition = windowRegionPtr->getEndPosition() + 1;
 			}
-			auto funct = std::bind(&graphite::VariantList::writeVariantList, variantListPtr, fileWriter, vcfHeaderPtr, firstTime);
-			auto functFuture = graphite::ThreadPool::Instance()->enqueue(funct);
-			vcfWriterFutureFunctions.push_back(functFuture);
 		}
+		loadedRegionQueue.close();
+	});
 
-		while (!vcfWriterFutureFunctions.empty())
+	std::thread writingThread([&]()
+	{
+		bool firstTime = true;
+		std::shared_ptr< RegionWork > regionWorkPtr;
+		while (adjudicatedRegionQueue.pop(regionWorkPtr))
 		{
-			vcfWriterFutureFunctions.front()->wait();
-			vcfWriterFutureFunctions.pop_front();
+			auto vcfPathsAndVariantListPtrsMap = regionWorkPtr->variantManagerPtr->getVCFReadersAndVariantListsMap();
+			graphite::TaskGroup vcfWriterTaskGroup;
+			for (auto& iter : vcfPathsAndVariantListPtrsMap)
+			{
+				auto vcfReaderPtr = iter.first;
+				auto vcfPath = vcfReaderPtr->getFilePath();
+				graphite::IFileWriter::SharedPtr fileWriter = vcfoutPaths[vcfPath];
+				std::string currentVCFOutPath = fileWriter->getFilePath();
+				auto variantListPtr = iter.second;
+				auto vcfHeaderPtr = vcfReaderPtr->getVCFHeader();
+
+				vcfHeaderPtr->registerActiveSample(sampleManagerPtr);
+				if (firstTime)
+				{
+					outputPaths.emplace(currentVCFOutPath);
+				}
+				vcfWriterTaskGroup.run(std::bind(&graphite::VariantList::writeVariantList, variantListPtr, fileWriter, vcfHeaderPtr, firstTime));
+			}
+			vcfWriterTaskGroup.join();
+
+			firstTime = false;
+			regionWorkPtr = nullptr; // the window's reservations are released before waiting on the next one
 		}
+	});
+
+	// adjudication happens on this thread, one region at a time
+	std::shared_ptr< RegionWork > regionWorkPtr;
+	while (loadedRegionQueue.pop(regionWorkPtr))
+	{
+		// create an adjudicator for the graph
+		auto gsswAdjudicator = std::make_shared< graphite::GSSWAdjudicator >(swPercent, matchValue, misMatchValue, gapOpenValue, gapExtensionValue);
+
+		// the gsswGraphManager adjudicates on the variantManager's variants
+		auto gsswGraphManager = std::make_shared< graphite::GraphManager >(regionWorkPtr->fastaReferencePtr, regionWorkPtr->variantManagerPtr, regionWorkPtr->bamAlignmentManagerPtr, gsswAdjudicator, readBatchSize, maxClusterSpan, graphMemoryBudgetPtr, params.getUseSWKernels());
+		// auto gsswGraphManager = std::make_shared< graphite::GraphManager >(fastaReferencePtr, variantManagerPtr, alignmentManager, gsswAdjudicator);
+		gsswGraphManager->buildGraphs(regionWorkPtr->fastaReferencePtr->getRegion(), readLength);
 
-		firstTime = false;
+		regionWorkPtr->bamAlignmentManagerPtr = nullptr; // the alignments are not needed for writing, free them as early as possible
+		regionWorkPtr->alignmentReservationPtr = nullptr;
+		adjudicatedRegionQueue.push(regionWorkPtr);
+		regionWorkPtr = nullptr; // the writer owns it now, the loader may be waiting on its bytes
 	}
+	adjudicatedRegionQueue.close();
+
+	loadingThread.join();
+	writingThread.join();
 
 	for (auto& iter : vcfoutPaths)
 	{
@@ -178,6 +348,11 @@ int main(int argc, char** argv)
 		fileWriter->close();
 	}
 
+	if (params.getPrintThreadPoolStatistics())
+	{
+		graphite::ThreadPool::Instance()->printStatistics(std::cerr);
+	}
+
 	// graphite::GSSWAdjudicator* adj_p;
 	// std::cout << "adj counts: " << (uint32_t)adj_p->s_adj_count << " [total]" << std::endl;
 